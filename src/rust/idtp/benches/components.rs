@@ -0,0 +1,865 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! IDTP component benchmarks: trailer primitives, key lookup, payload &
+//! link-layer codecs, resynchronisation, FEC recovery and receive path
+//! stages. Each stage is fed the same stream of `IDTP-S` frames with `Imu6`
+//! payload, throughput is set to processed bytes. Compression ratios,
+//! recovered frames & FEC recovery rates are printed to stderr.
+//!
+//! Baselines are handled the same way as in `frame` benchmarks:
+//!
+//! ```sh
+//! cargo bench --all-features --bench components -- --save-baseline main
+//! cargo bench --all-features --bench components -- --baseline main
+//! ```
+
+use criterion::{
+    BatchSize, BenchmarkId, Criterion, Throughput, black_box, criterion_group,
+    criterion_main,
+};
+use idtp::{
+    FrameDecoder, IDTP_FRAME_MAX_SIZE, IdtpFrame, IdtpHeader, IdtpMode,
+    coalesce::{COALESCE_DEFAULT_MTU, Coalescer},
+    cobs::{self, CobsDecoder},
+    compress::{
+        compress_delta, compress_xor, decompress_delta, decompress_xor,
+    },
+    crypto::{self, Blake2s, HmacMidstate},
+    dedup::Deduplicator,
+    fec::{FecDecoder, FecEncoder, FecScheme},
+    filter::FrameFilter,
+    hcomp::HeaderCompressor,
+    keystore::KeyStore,
+    latest::LatestTable,
+    merge::MergeStream,
+    payload::{Imu3Acc, Imu3Gyr, Imu6},
+    pool::FramePool,
+    quantized::QImu6,
+    reorder::ReorderBuffer,
+    validator::{ParallelValidator, Schedule},
+};
+use std::{
+    collections::HashMap,
+    sync::atomic::{AtomicBool, Ordering},
+    thread,
+};
+
+/// Trailer key.
+const KEY: &[u8] = &[0x42; 32];
+
+/// Number of frames in stream.
+const STREAM_SIZE: usize = 256;
+
+/// Trailer input sizes in bytes.
+const TRAILER_SIZES: [usize; 2] = [64, 1024];
+
+/// Number of devices in key store.
+const DEVICES: u16 = 64;
+
+/// Every n-th frame of corrupted stream is truncated.
+const CORRUPTED_EVERY: usize = 16;
+
+/// Number of data frames per FEC group.
+const FEC_GROUP_SIZE: usize = 8;
+
+/// Number of parity frames per FEC group.
+const FEC_PARITY: usize = 2;
+
+/// Simulated FEC link loss rates in percent.
+const FEC_LOSS_PERCENT: [u32; 4] = [0, 5, 10, 20];
+
+/// Build packed frame.
+///
+/// # Parameters
+/// - `mode` - given IDTP mode.
+/// - `device_id` - given device identifier.
+/// - `sequence` - given frame sequence number.
+///
+/// # Returns
+/// - Packed frame.
+fn packed(mode: IdtpMode, device_id: u16, sequence: u32) -> Vec<u8> {
+    let mut frame = IdtpFrame::new();
+    frame
+        .set_payload(&sample(sequence))
+        .expect("standard payload");
+    frame.set_header(&IdtpHeader {
+        mode: mode.into(),
+        payload_size: frame.header().payload_size,
+        payload_type: frame.header().payload_type,
+        device_id,
+        sequence,
+        timestamp: sequence * 1_000,
+        ..IdtpHeader::new()
+    });
+
+    let mut buffer = [0u8; IDTP_FRAME_MAX_SIZE];
+    let size = frame.pack(&mut buffer, Some(KEY)).expect("packed frame");
+    buffer[..size].to_vec()
+}
+
+/// Build slowly changing `Imu6` sample.
+///
+/// # Parameters
+/// - `index` - given sample index.
+///
+/// # Returns
+/// - `Imu6` sample.
+#[allow(clippy::cast_precision_loss)]
+fn sample(index: u32) -> Imu6 {
+    let t = index as f32 * 0.01;
+
+    Imu6 {
+        acc: Imu3Acc {
+            acc_x: t.sin(),
+            acc_y: t.cos(),
+            acc_z: 9.81,
+        },
+        gyr: Imu3Gyr {
+            gyr_x: 0.1 * t,
+            gyr_y: -0.1 * t,
+            gyr_z: 0.0,
+        },
+    }
+}
+
+/// Build stream of `IDTP-S` frames of single device.
+///
+/// # Returns
+/// - Packed frames.
+#[allow(clippy::cast_possible_truncation)]
+fn stream() -> Vec<Vec<u8>> {
+    (0..STREAM_SIZE as u32)
+        .map(|sequence| packed(IdtpMode::Safety, 7, sequence))
+        .collect()
+}
+
+/// Build batch with skewed per-device load: every 4th frame is `IDTP-L`
+/// frame of its own device, the rest are `IDTP-SEC` frames of device 1.
+///
+/// # Returns
+/// - Packed frames.
+#[allow(clippy::cast_possible_truncation)]
+fn skewed() -> Vec<Vec<u8>> {
+    (0..STREAM_SIZE as u32)
+        .map(|sequence| {
+            if sequence % 4 == 0 {
+                packed(IdtpMode::Lite, sequence as u16 + 2, sequence)
+            } else {
+                packed(IdtpMode::Secure, 1, sequence)
+            }
+        })
+        .collect()
+}
+
+/// Build deterministic pseudo-random loss pattern.
+///
+/// # Parameters
+/// - `count` - given number of packets.
+/// - `percent` - given loss rate in percent.
+///
+/// # Returns
+/// - `true` for each lost packet.
+fn loss_pattern(count: usize, percent: u32) -> Vec<bool> {
+    let mut state = 0x2545_F491u32;
+
+    (0..count)
+        .map(|_| {
+            state = state.wrapping_mul(1_664_525).wrapping_add(1_013_904_223);
+            (state >> 8) % 100 < percent
+        })
+        .collect()
+}
+
+/// Build parity frames of each FEC group of stream.
+///
+/// # Parameters
+/// - `frames` - given data frames.
+///
+/// # Returns
+/// - Parity frames of each group.
+fn parity_frames(frames: &[Vec<u8>]) -> Vec<Vec<Vec<u8>>> {
+    let mut encoder =
+        FecEncoder::<FEC_PARITY>::new(FecScheme::ReedSolomon, FEC_GROUP_SIZE)
+            .expect("FEC encoder");
+    let mut groups = Vec::new();
+
+    for frame in frames {
+        if !encoder.push(frame).expect("FEC group") {
+            continue;
+        }
+
+        let sequence = IdtpFrame::try_from(&frame[..])
+            .expect("data frame")
+            .header()
+            .sequence;
+        let group = (0..FEC_PARITY)
+            .map(|index| {
+                let mut parity = IdtpFrame::new();
+                parity.set_header(&IdtpHeader {
+                    device_id: 7,
+                    sequence,
+                    ..IdtpHeader::new()
+                });
+                encoder
+                    .parity_frame(index, &mut parity)
+                    .expect("parity frame");
+
+                let mut buffer = [0u8; IDTP_FRAME_MAX_SIZE];
+                let size =
+                    parity.pack(&mut buffer, None).expect("packed frame");
+                buffer[..size].to_vec()
+            })
+            .collect();
+
+        groups.push(group);
+    }
+
+    groups
+}
+
+/// Feed stream through FEC decoder. Data & parity frames are sent group by
+/// group, parity frames follow data frames of their group.
+///
+/// # Parameters
+/// - `decoder` - given FEC decoder.
+/// - `frames` - given data frames.
+/// - `parity` - given parity frames of each group.
+/// - `lost` - given loss pattern in sending order.
+///
+/// # Returns
+/// - Number of rebuilt frames.
+fn fec_decode(
+    decoder: &mut FecDecoder<16, FEC_PARITY>,
+    frames: &[Vec<u8>],
+    parity: &[Vec<Vec<u8>>],
+    lost: &[bool],
+) -> usize {
+    let packets = frames.chunks(FEC_GROUP_SIZE).zip(parity).flat_map(
+        |(group, parity)| {
+            let data = group.iter().map(|frame| (false, frame));
+            data.chain(parity.iter().map(|frame| (true, frame)))
+        },
+    );
+    let mut recovered = 0;
+
+    for ((is_parity, packet), lost) in packets.zip(lost) {
+        if *lost {
+            continue;
+        }
+
+        if is_parity {
+            recovered += decoder
+                .push_parity(packet, |frame| {
+                    black_box(frame);
+                })
+                .unwrap_or_default();
+        } else {
+            decoder.push_data(packet).ok();
+        }
+    }
+
+    recovered
+}
+
+/// Get total size of frames.
+///
+/// # Parameters
+/// - `frames` - given frames.
+///
+/// # Returns
+/// - Throughput of single pass over frames.
+fn bytes(frames: &[Vec<u8>]) -> Throughput {
+    Throughput::Bytes(frames.iter().map(Vec::len).sum::<usize>() as u64)
+}
+
+/// Benchmark trailer primitives.
+///
+/// # Parameters
+/// - `c` - given benchmark manager.
+fn bench_trailers(c: &mut Criterion) {
+    let mut group = c.benchmark_group("trailer");
+    let midstate = HmacMidstate::new(KEY).expect("HMAC midstate");
+
+    for size in TRAILER_SIZES {
+        let data = vec![0xA5u8; size];
+
+        group.throughput(Throughput::Bytes(size as u64));
+        group.bench_with_input(
+            BenchmarkId::new("crc32", size),
+            &data,
+            |b, d| {
+                b.iter(|| crypto::sw_crc32(black_box(d)));
+            },
+        );
+        group.bench_with_input(
+            BenchmarkId::new("hmac", size),
+            &data,
+            |b, d| {
+                b.iter(|| crypto::sw_hmac_closure(Some(KEY))(black_box(d)));
+            },
+        );
+        group.bench_with_input(
+            BenchmarkId::new("hmac_midstate", size),
+            &data,
+            |b, d| b.iter(|| midstate.mac(black_box(d))),
+        );
+        group.bench_with_input(
+            BenchmarkId::new("blake2s", size),
+            &data,
+            |b, d| {
+                b.iter(|| {
+                    let mut mac = Blake2s::new_keyed(Some(KEY))?;
+                    mac.update(black_box(d))?;
+                    mac.finalize()
+                });
+            },
+        );
+        group.bench_with_input(
+            BenchmarkId::new("chacha20_poly1305", size),
+            &data,
+            |b, d| {
+                let header = [0u8; idtp::IDTP_HEADER_SIZE];
+                b.iter_batched(
+                    || d.clone(),
+                    |mut payload| {
+                        crypto::sw_seal_closure(Some(KEY))(
+                            &header,
+                            black_box(&mut payload),
+                        )
+                    },
+                    BatchSize::SmallInput,
+                );
+            },
+        );
+    }
+
+    group.finish();
+}
+
+/// Benchmark per-device key lookup & validation against map of keys.
+///
+/// # Parameters
+/// - `c` - given benchmark manager.
+fn bench_key_store(c: &mut Criterion) {
+    let mut group = c.benchmark_group("key_store");
+    let store = KeyStore::<128>::new();
+    let mut keys = HashMap::new();
+    let mut frames = Vec::new();
+
+    for device_id in 0..DEVICES {
+        let key = [device_id as u8; 32];
+        store.insert(device_id, &key).expect("key store capacity");
+        keys.insert(device_id, key);
+
+        let mut frame = IdtpFrame::new();
+        frame.set_payload(&sample(0)).expect("standard payload");
+        frame.set_header(&IdtpHeader {
+            mode: IdtpMode::Secure.into(),
+            payload_size: frame.header().payload_size,
+            payload_type: frame.header().payload_type,
+            device_id,
+            ..IdtpHeader::new()
+        });
+
+        let mut buffer = [0u8; IDTP_FRAME_MAX_SIZE];
+        let size = frame.pack(&mut buffer, Some(&key)).expect("packed frame");
+        frames.push(buffer[..size].to_vec());
+    }
+
+    group.throughput(bytes(&frames));
+    group.bench_function("key_store", |b| {
+        b.iter(|| {
+            for frame in &frames {
+                black_box(store.validate(frame, 0)).ok();
+            }
+        });
+    });
+    group.bench_function("hash_map", |b| {
+        b.iter(|| {
+            for frame in &frames {
+                let device_id = IdtpFrame::try_from(&frame[..])
+                    .map(|f| f.header().device_id)
+                    .unwrap_or_default();
+                let key = keys.get(&device_id).map(<[u8; 32]>::as_slice);
+                black_box(IdtpFrame::validate(frame, key)).ok();
+            }
+        });
+    });
+
+    group.finish();
+}
+
+/// Benchmark payload & link-layer codecs.
+///
+/// # Parameters
+/// - `c` - given benchmark manager.
+#[allow(clippy::cast_possible_truncation)]
+fn bench_codecs(c: &mut Criterion) {
+    let mut group = c.benchmark_group("codec");
+    let frames = stream();
+    let samples: Vec<(u16, Imu6)> =
+        (0..64).map(|i| (1_000, sample(i))).collect();
+    let quantized: Vec<(u16, QImu6)> = samples
+        .iter()
+        .map(|(dt, s)| (*dt, QImu6::from_payload(s)))
+        .collect();
+    let mut output = vec![0u8; 4 * IDTP_FRAME_MAX_SIZE];
+
+    group.throughput(Throughput::Bytes(
+        (samples.len() * size_of::<Imu6>()) as u64,
+    ));
+    group.bench_function("quantize", |b| {
+        b.iter(|| {
+            for (_, s) in &samples {
+                black_box(QImu6::from_payload(black_box(s)));
+            }
+        });
+    });
+    group.bench_function("compress_xor", |b| {
+        b.iter(|| compress_xor::<Imu6, 6>(black_box(&samples), &mut output));
+    });
+    group.bench_function("compress_delta", |b| {
+        b.iter(|| {
+            compress_delta::<Imu6, 6, 2>(black_box(&quantized), &mut output)
+        });
+    });
+
+    let raw_size = samples.len() * size_of::<Imu6>();
+    let xor_size =
+        compress_xor::<Imu6, 6>(&samples, &mut output).expect("XOR payload");
+    let xor_payload = output[..xor_size].to_vec();
+    let delta_size = compress_delta::<Imu6, 6, 2>(&quantized, &mut output)
+        .expect("delta payload");
+    let delta_payload = output[..delta_size].to_vec();
+    let mut timestamps = vec![0u32; samples.len()];
+    let mut columns = vec![0f32; 6 * samples.len()];
+
+    for (name, size) in [("xor", xor_size), ("delta", delta_size)] {
+        eprintln!(
+            "codec/compress_{name}: {raw_size} -> {size} bytes, ratio {:.2}",
+            raw_size as f64 / size as f64
+        );
+    }
+
+    group.bench_function("decompress_xor", |b| {
+        b.iter(|| {
+            decompress_xor::<6>(
+                black_box(&xor_payload),
+                0,
+                &mut timestamps,
+                &mut columns,
+            )
+            .expect("XOR samples")
+        });
+    });
+    group.bench_function("decompress_delta", |b| {
+        b.iter(|| {
+            decompress_delta::<6, 2>(
+                black_box(&delta_payload),
+                0,
+                &mut timestamps,
+                &mut columns,
+            )
+            .expect("delta samples")
+        });
+    });
+
+    group.throughput(bytes(&frames));
+    group.bench_function("cobs_encode", |b| {
+        b.iter(|| {
+            for frame in &frames {
+                black_box(cobs::encode(frame, &mut output)).ok();
+            }
+        });
+    });
+
+    // Encoded frames without delimiter.
+    let encoded: Vec<Vec<u8>> = frames
+        .iter()
+        .map(|frame| {
+            let size = cobs::encode(frame, &mut output).expect("COBS frame");
+            output[..size - 1].to_vec()
+        })
+        .collect();
+
+    group.bench_function("cobs_decode", |b| {
+        b.iter(|| {
+            for frame in &encoded {
+                black_box(cobs::decode(frame, &mut output)).ok();
+            }
+        });
+    });
+    group.bench_function("header_compression", |b| {
+        let mut compressor =
+            HeaderCompressor::new(1, 64).expect("header compressor");
+        b.iter(|| {
+            for frame in &frames {
+                black_box(compressor.compress(frame, &mut output)).ok();
+            }
+        });
+    });
+
+    group.bench_function("fec_xor", |b| {
+        let mut encoder =
+            FecEncoder::<1>::new(FecScheme::Xor, 8).expect("FEC encoder");
+        b.iter(|| {
+            for frame in &frames {
+                black_box(encoder.push(frame)).ok();
+            }
+        });
+    });
+    group.bench_function("fec_rs", |b| {
+        let mut encoder = FecEncoder::<2>::new(FecScheme::ReedSolomon, 8)
+            .expect("FEC encoder");
+        b.iter(|| {
+            for frame in &frames {
+                black_box(encoder.push(frame)).ok();
+            }
+        });
+    });
+
+    group.finish();
+}
+
+/// Benchmark resynchronisation on corrupted byte stream: preamble scan of
+/// `FrameDecoder` against delimiter search of `CobsDecoder`. Every
+/// `CORRUPTED_EVERY`-th frame loses its second half.
+///
+/// # Parameters
+/// - `c` - given benchmark manager.
+fn bench_resync(c: &mut Criterion) {
+    let mut group = c.benchmark_group("resync");
+    let frames = stream();
+    let mut raw = Vec::new();
+    let mut encoded = Vec::new();
+    let mut buffer = [0u8; cobs::COBS_FRAME_MAX_SIZE];
+
+    for (index, frame) in frames.iter().enumerate() {
+        let size = cobs::encode(frame, &mut buffer).expect("COBS frame");
+
+        if index % CORRUPTED_EVERY == 0 {
+            raw.extend_from_slice(&frame[..frame.len() / 2]);
+            encoded.extend_from_slice(&buffer[..size / 2]);
+        } else {
+            raw.extend_from_slice(frame);
+            encoded.extend_from_slice(&buffer[..size]);
+        }
+    }
+
+    let preamble_scan =
+        |decoder: &mut FrameDecoder, on_frame: &mut dyn FnMut(&[u8])| {
+            let mut input = &raw[..];
+            while let Ok((consumed, frame)) = decoder.feed(input) {
+                if let Some(frame) = frame {
+                    on_frame(frame);
+                }
+                input = &input[consumed..];
+                if consumed == 0 || input.is_empty() {
+                    break;
+                }
+            }
+        };
+    let delimiter_scan =
+        |decoder: &mut CobsDecoder, on_frame: &mut dyn FnMut(&[u8])| {
+            let mut input = &encoded[..];
+            while !input.is_empty() {
+                let (consumed, frame) = decoder.feed(input);
+                if let Some(frame) = frame {
+                    on_frame(frame);
+                }
+                input = &input[consumed..];
+            }
+        };
+
+    let is_valid = |frame: &[u8]| IdtpFrame::validate(frame, None).is_ok();
+
+    let mut valid = 0;
+    let mut decoder = FrameDecoder::new();
+    preamble_scan(&mut decoder, &mut |frame| {
+        valid += usize::from(is_valid(frame));
+    });
+    eprintln!(
+        "resync/preamble_scan: {valid} of {STREAM_SIZE} frames, {} bytes \
+         discarded",
+        decoder.discarded()
+    );
+
+    let mut valid = 0;
+    let mut decoder = CobsDecoder::new();
+    delimiter_scan(&mut decoder, &mut |frame| {
+        valid += usize::from(is_valid(frame));
+    });
+    eprintln!(
+        "resync/cobs: {valid} of {STREAM_SIZE} frames, {} bytes discarded",
+        decoder.discarded()
+    );
+
+    group.throughput(Throughput::Bytes(raw.len() as u64));
+    group.bench_function("preamble_scan", |b| {
+        let mut decoder = FrameDecoder::new();
+        b.iter(|| {
+            preamble_scan(&mut decoder, &mut |frame| {
+                black_box(frame);
+            });
+        });
+    });
+
+    group.throughput(Throughput::Bytes(encoded.len() as u64));
+    group.bench_function("cobs", |b| {
+        let mut decoder = CobsDecoder::new();
+        b.iter(|| {
+            delimiter_scan(&mut decoder, &mut |frame| {
+                black_box(frame);
+            });
+        });
+    });
+
+    group.finish();
+}
+
+/// Benchmark FEC recovery under simulated independent loss of data &
+/// parity frames. One iteration decodes the whole stream.
+///
+/// # Parameters
+/// - `c` - given benchmark manager.
+#[allow(clippy::cast_precision_loss)]
+fn bench_fec(c: &mut Criterion) {
+    let mut group = c.benchmark_group("fec_decode");
+    let frames = stream();
+    let parity = parity_frames(&frames);
+    let packets = frames.len() + parity.len() * FEC_PARITY;
+
+    group.throughput(bytes(&frames));
+
+    for percent in FEC_LOSS_PERCENT {
+        let lost = loss_pattern(packets, percent);
+        let lost_data = lost
+            .chunks(FEC_GROUP_SIZE + FEC_PARITY)
+            .flat_map(|group| &group[..FEC_GROUP_SIZE])
+            .filter(|lost| **lost)
+            .count();
+        let mut decoder = Box::new(FecDecoder::new());
+        let recovered = fec_decode(&mut decoder, &frames, &parity, &lost);
+
+        eprintln!(
+            "fec_decode/{percent}: {recovered} of {lost_data} lost frames \
+             rebuilt ({:.1}%)",
+            100.0 * recovered as f64 / lost_data.max(1) as f64
+        );
+
+        group.bench_with_input(
+            BenchmarkId::from_parameter(percent),
+            &lost,
+            |b, lost| {
+                b.iter_batched(
+                    || Box::new(FecDecoder::new()),
+                    |mut decoder| {
+                        fec_decode(&mut decoder, &frames, &parity, lost)
+                    },
+                    BatchSize::SmallInput,
+                );
+            },
+        );
+    }
+
+    group.finish();
+}
+
+/// Benchmark receive path stages.
+///
+/// # Parameters
+/// - `c` - given benchmark manager.
+#[allow(clippy::cast_possible_truncation)]
+fn bench_receive(c: &mut Criterion) {
+    let mut group = c.benchmark_group("receive");
+    let frames = stream();
+    let bytestream: Vec<u8> = frames.concat();
+
+    group.throughput(bytes(&frames));
+    group.bench_function("decoder", |b| {
+        let mut decoder = FrameDecoder::new();
+        b.iter(|| {
+            let mut input = &bytestream[..];
+            while let Ok((consumed, frame)) = decoder.feed(input) {
+                black_box(frame);
+                input = &input[consumed..];
+                if consumed == 0 || input.is_empty() {
+                    break;
+                }
+            }
+        });
+    });
+    group.bench_function("filter", |b| {
+        let mut filter = FrameFilter::new();
+        b.iter(|| {
+            for frame in &frames {
+                black_box(filter.check(frame)).ok();
+            }
+        });
+    });
+    group.bench_function("dedup", |b| {
+        let mut dedup = Deduplicator::<16, 2>::new();
+        let mut now = 0;
+        b.iter(|| {
+            for frame in &frames {
+                now += 1;
+                black_box(dedup.accept_frame(0, frame, now));
+                black_box(dedup.accept_frame(1, frame, now));
+            }
+        });
+    });
+    group.bench_function("reorder", |b| {
+        b.iter_batched(
+            || ReorderBuffer::<usize, 64>::new(100),
+            |mut reorder| {
+                // Swap every pair of frames.
+                for index in 0..STREAM_SIZE {
+                    let sequence = (index ^ 1) as u32;
+                    reorder.push(sequence, index as u64, index).ok();
+                    while let Some(item) = reorder.pop(index as u64) {
+                        black_box(item);
+                    }
+                }
+            },
+            BatchSize::SmallInput,
+        );
+    });
+    group.bench_function("latest", |b| {
+        let table = LatestTable::<16>::new();
+        b.iter(|| {
+            for frame in &frames {
+                table.update(frame).ok();
+                black_box(table.read(7));
+            }
+        });
+    });
+    group.bench_function("pool", |b| {
+        let pool = FramePool::<8>::boxed();
+        b.iter(|| {
+            for frame in &frames {
+                if let Some(mut buffer) = pool.acquire() {
+                    buffer.buffer_mut()[..frame.len()].copy_from_slice(frame);
+                    buffer.set_len(frame.len()).ok();
+                    black_box(&buffer);
+                }
+            }
+        });
+    });
+    group.bench_function("coalesce", |b| {
+        let mut coalescer =
+            Coalescer::<COALESCE_DEFAULT_MTU>::new(COALESCE_DEFAULT_MTU, 1_000)
+                .expect("coalescer");
+        let mut now = 0;
+        b.iter(|| {
+            for frame in &frames {
+                now += 10;
+                coalescer
+                    .push(frame, now, |datagram| {
+                        black_box(datagram);
+                    })
+                    .ok();
+            }
+        });
+    });
+
+    for workers in [1, 2, 4, 8] {
+        group.bench_with_input(
+            BenchmarkId::new("parallel_validator", workers),
+            &workers,
+            |b, &workers| {
+                let validator =
+                    ParallelValidator::new(workers, Schedule::WorkStealing)
+                        .expect("validator workers");
+                b.iter(|| validator.validate(&frames, Some(KEY)));
+            },
+        );
+    }
+
+    let skewed = skewed();
+
+    for (name, schedule) in [
+        ("skewed_work_stealing", Schedule::WorkStealing),
+        ("skewed_round_robin", Schedule::RoundRobin),
+    ] {
+        group.throughput(bytes(&skewed));
+
+        for workers in [2, 4] {
+            group.bench_with_input(
+                BenchmarkId::new(name, workers),
+                &workers,
+                |b, &workers| {
+                    let validator = ParallelValidator::new(workers, schedule)
+                        .expect("validator workers");
+                    b.iter(|| validator.validate(&skewed, Some(KEY)));
+                },
+            );
+        }
+    }
+
+    // Reader latency while other threads keep updating the same device.
+    group.throughput(Throughput::Elements(1));
+
+    for writers in [0, 1, 3] {
+        group.bench_with_input(
+            BenchmarkId::new("latest_contended", writers),
+            &writers,
+            |b, &writers| {
+                let table = LatestTable::<16>::new();
+                let stop = AtomicBool::new(false);
+                table.update(&frames[0]).expect("latest sample");
+
+                thread::scope(|scope| {
+                    for _ in 0..writers {
+                        scope.spawn(|| {
+                            while !stop.load(Ordering::Relaxed) {
+                                for frame in &frames {
+                                    table.update(frame).ok();
+                                }
+                            }
+                        });
+                    }
+
+                    b.iter(|| black_box(table.read(7)));
+                    stop.store(true, Ordering::Relaxed);
+                });
+            },
+        );
+    }
+
+    for sources in [8, 64, 1024] {
+        group.throughput(Throughput::Elements(STREAM_SIZE as u64 * 4));
+        group.bench_with_input(
+            BenchmarkId::new("merge", sources),
+            &sources,
+            |b, &sources| {
+                b.iter_batched(
+                    || MergeStream::new(sources, 1_000),
+                    |mut merge| {
+                        for index in 0..STREAM_SIZE * 4 {
+                            let timestamp = index as u64 * 10;
+                            merge.push(index % sources, timestamp, index).ok();
+                            while let Some(item) = merge.pop() {
+                                black_box(item);
+                            }
+                        }
+                    },
+                    BatchSize::SmallInput,
+                );
+            },
+        );
+    }
+
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    bench_trailers,
+    bench_key_store,
+    bench_codecs,
+    bench_resync,
+    bench_fec,
+    bench_receive
+);
+criterion_main!(benches);
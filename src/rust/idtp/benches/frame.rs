@@ -0,0 +1,327 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! IDTP frame hot path benchmarks.
+//!
+//! `pack`, `pack_with`, `validate` & `try_from` are measured for every
+//! operating mode with every standard payload & vendor payloads up to
+//! `IDTP_PAYLOAD_MAX_SIZE`, `payload::<T>()` - for every payload. One
+//! iteration handles one frame & throughput is set to frame size, so
+//! Criterion reports both time per frame & bytes per second.
+//!
+//! Save baseline before change & compare against it after:
+//!
+//! ```sh
+//! cargo bench --features software_impl --bench frame -- --save-baseline main
+//! cargo bench --features software_impl --bench frame -- --baseline main
+//! ```
+
+use criterion::{
+    BenchmarkId, Criterion, Throughput, black_box, criterion_group,
+    criterion_main,
+};
+use idtp::{
+    IDTP_FRAME_MAX_SIZE, IDTP_PAYLOAD_MAX_SIZE, IdtpFrame, IdtpHeader,
+    IdtpMode, crypto,
+    payload::{
+        IdtpPayload, Imu3Acc, Imu3Gyr, Imu3Mag, Imu6, Imu9, Imu10, ImuQuat,
+    },
+};
+
+/// Key of keyed modes.
+const KEY: &[u8] = &[0x42; 32];
+
+/// Operating modes to benchmark.
+const MODES: [IdtpMode; 5] = [
+    IdtpMode::Lite,
+    IdtpMode::Safety,
+    IdtpMode::Secure,
+    IdtpMode::SecureFast,
+    IdtpMode::Encrypted,
+];
+
+/// Vendor payload sizes in bytes.
+const VENDOR_SIZES: [usize; 4] = [16, 64, 256, IDTP_PAYLOAD_MAX_SIZE];
+
+/// Vendor payload type.
+const VENDOR_PAYLOAD_TYPE: u8 = 0x80;
+
+/// Benchmark case.
+struct Case {
+    /// Payload label.
+    label: String,
+    /// Frame operating mode.
+    mode: IdtpMode,
+    /// Frame to pack.
+    frame: IdtpFrame,
+    /// Packed frame.
+    packed: Vec<u8>,
+    /// Payload decoding routine.
+    decode: fn(&IdtpFrame),
+}
+
+impl Case {
+    /// Get benchmark identifier.
+    ///
+    /// # Returns
+    /// - Benchmark identifier.
+    fn id(&self) -> BenchmarkId {
+        BenchmarkId::new(mode_name(self.mode), &self.label)
+    }
+
+    /// Get throughput of single iteration.
+    ///
+    /// # Returns
+    /// - Frame size in bytes.
+    fn throughput(&self) -> Throughput {
+        Throughput::Bytes(self.packed.len() as u64)
+    }
+}
+
+/// Get short name of mode.
+///
+/// # Parameters
+/// - `mode` - given IDTP mode.
+///
+/// # Returns
+/// - Mode name.
+const fn mode_name(mode: IdtpMode) -> &'static str {
+    match mode {
+        IdtpMode::Lite => "lite",
+        IdtpMode::Safety => "safety",
+        IdtpMode::Secure => "secure",
+        IdtpMode::SecureFast => "secure_fast",
+        IdtpMode::Encrypted => "encrypted",
+        _ => "unknown",
+    }
+}
+
+/// Decode standard payload.
+///
+/// # Parameters
+/// - `frame` - given IDTP frame.
+fn decode<T: IdtpPayload>(frame: &IdtpFrame) {
+    black_box(frame.payload::<T>().ok());
+}
+
+/// Decode vendor payload.
+///
+/// # Parameters
+/// - `frame` - given IDTP frame.
+fn decode_raw(frame: &IdtpFrame) {
+    black_box(frame.payload_raw().ok());
+}
+
+/// Build benchmark cases for all modes.
+///
+/// # Parameters
+/// - `cases` - given cases to extend.
+/// - `label` - given payload label.
+/// - `frame` - given frame with payload.
+/// - `decode` - given payload decoding routine.
+fn push_cases(
+    cases: &mut Vec<Case>,
+    label: &str,
+    frame: &IdtpFrame,
+    decode: fn(&IdtpFrame),
+) {
+    for mode in MODES {
+        let mut frame = *frame;
+        frame.set_header(&IdtpHeader {
+            mode: mode.into(),
+            payload_size: frame.header().payload_size,
+            payload_type: frame.header().payload_type,
+            device_id: 7,
+            sequence: 1,
+            timestamp: 1_000,
+            ..IdtpHeader::new()
+        });
+
+        let mut buffer = [0u8; IDTP_FRAME_MAX_SIZE];
+        let size = frame.pack(&mut buffer, Some(KEY)).expect("packed frame");
+
+        cases.push(Case {
+            label: label.into(),
+            mode,
+            frame,
+            packed: buffer[..size].to_vec(),
+            decode,
+        });
+    }
+}
+
+/// Build frame with standard payload.
+///
+/// # Returns
+/// - IDTP frame.
+fn standard<T: IdtpPayload + Default>() -> IdtpFrame {
+    let mut frame = IdtpFrame::new();
+    frame.set_payload(&T::default()).expect("standard payload");
+    frame
+}
+
+/// Build benchmark cases.
+///
+/// # Returns
+/// - Benchmark cases.
+fn cases() -> Vec<Case> {
+    let mut cases = Vec::new();
+
+    push_cases(
+        &mut cases,
+        "imu3acc",
+        &standard::<Imu3Acc>(),
+        decode::<Imu3Acc>,
+    );
+    push_cases(
+        &mut cases,
+        "imu3gyr",
+        &standard::<Imu3Gyr>(),
+        decode::<Imu3Gyr>,
+    );
+    push_cases(
+        &mut cases,
+        "imu3mag",
+        &standard::<Imu3Mag>(),
+        decode::<Imu3Mag>,
+    );
+    push_cases(&mut cases, "imu6", &standard::<Imu6>(), decode::<Imu6>);
+    push_cases(&mut cases, "imu9", &standard::<Imu9>(), decode::<Imu9>);
+    push_cases(&mut cases, "imu10", &standard::<Imu10>(), decode::<Imu10>);
+    push_cases(
+        &mut cases,
+        "imuquat",
+        &standard::<ImuQuat>(),
+        decode::<ImuQuat>,
+    );
+
+    for size in VENDOR_SIZES {
+        let payload: Vec<u8> = (0..size).map(|i| i as u8).collect();
+        let mut frame = IdtpFrame::new();
+        frame
+            .set_payload_raw(&payload, VENDOR_PAYLOAD_TYPE)
+            .expect("vendor payload");
+        push_cases(&mut cases, &format!("vendor{size}"), &frame, decode_raw);
+    }
+
+    cases
+}
+
+/// Benchmark packing with software-based `CRC` & `MAC`.
+///
+/// # Parameters
+/// - `c` - given benchmark manager.
+fn bench_pack(c: &mut Criterion) {
+    let mut group = c.benchmark_group("pack");
+    let mut buffer = [0u8; IDTP_FRAME_MAX_SIZE];
+
+    for case in cases() {
+        group.throughput(case.throughput());
+        group.bench_with_input(case.id(), &case.frame, |b, frame| {
+            b.iter(|| frame.pack(black_box(&mut buffer), Some(KEY)));
+        });
+    }
+
+    group.finish();
+}
+
+/// Benchmark packing with custom `CRC` & `MAC` closures. `IDTP-E` frames
+/// are packed with `seal_with`.
+///
+/// # Parameters
+/// - `c` - given benchmark manager.
+fn bench_pack_with(c: &mut Criterion) {
+    let mut group = c.benchmark_group("pack_with");
+    let mut buffer = [0u8; IDTP_FRAME_MAX_SIZE];
+
+    for case in cases() {
+        let mode = case.mode;
+
+        group.throughput(case.throughput());
+        group.bench_with_input(case.id(), &case.frame, |b, frame| {
+            b.iter(|| match mode {
+                IdtpMode::Encrypted => frame.seal_with(
+                    black_box(&mut buffer),
+                    crypto::sw_crc8,
+                    crypto::sw_seal_closure(Some(KEY)),
+                ),
+                _ => frame.pack_with(
+                    black_box(&mut buffer),
+                    crypto::sw_crc8,
+                    crypto::sw_crc32,
+                    crypto::sw_mac_closure(Some(mode), Some(KEY)),
+                ),
+            });
+        });
+    }
+
+    group.finish();
+}
+
+/// Benchmark validation with software-based `CRC` & `MAC`.
+///
+/// # Parameters
+/// - `c` - given benchmark manager.
+fn bench_validate(c: &mut Criterion) {
+    let mut group = c.benchmark_group("validate");
+
+    for case in cases() {
+        group.throughput(case.throughput());
+        group.bench_with_input(case.id(), &case.packed, |b, packed| {
+            b.iter(|| IdtpFrame::validate(black_box(packed), Some(KEY)));
+        });
+    }
+
+    group.finish();
+}
+
+/// Benchmark conversion of raw frame into `IdtpFrame`.
+///
+/// # Parameters
+/// - `c` - given benchmark manager.
+fn bench_try_from(c: &mut Criterion) {
+    let mut group = c.benchmark_group("try_from");
+
+    for case in cases() {
+        group.throughput(case.throughput());
+        group.bench_with_input(case.id(), &case.packed, |b, packed| {
+            b.iter(|| IdtpFrame::try_from(black_box(&packed[..])));
+        });
+    }
+
+    group.finish();
+}
+
+/// Benchmark payload decoding. Payload decoding does not depend on mode,
+/// so only `IDTP-L` frames are used.
+///
+/// # Parameters
+/// - `c` - given benchmark manager.
+fn bench_payload(c: &mut Criterion) {
+    let mut group = c.benchmark_group("payload");
+
+    for case in cases().iter().filter(|case| case.mode == IdtpMode::Lite) {
+        let decode = case.decode;
+
+        group.throughput(Throughput::Bytes(u64::from(
+            case.frame.header().payload_size,
+        )));
+        group.bench_with_input(
+            BenchmarkId::from_parameter(&case.label),
+            &case.frame,
+            |b, frame| b.iter(|| decode(black_box(frame))),
+        );
+    }
+
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    bench_pack,
+    bench_pack_with,
+    bench_validate,
+    bench_try_from,
+    bench_payload
+);
+criterion_main!(benches);
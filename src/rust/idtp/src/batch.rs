@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Multi-sample batch payloads.
+//!
+//! `ImuBatch<T, N>` carries `N` consecutive samples of standard payload `T`
+//! in one frame, so header & trailer overhead is paid once per batch. Each
+//! sample is preceded by `u16` timestamp delta in microseconds from the
+//! previous sample (the first one - from header `timestamp`). Batch payload
+//! type is `BATCH_PAYLOAD_TYPE_BASE + T::TYPE_ID`. Receiver iterates samples
+//! directly over frame payload with `BatchView`, which also accepts batches
+//! shorter than `N` (e.g. flushed on stream end).
+
+use crate::{
+    IdtpError, IdtpFrame, IdtpResult, idtp_data, payload::IdtpPayload,
+};
+use core::{marker::PhantomData, ops::Range};
+use zerocopy::{FromBytes, Immutable, IntoBytes, KnownLayout};
+
+/// Payload type of batch of `Imu3Acc` samples. Batch payload type of other
+/// standard payloads is offset by their payload type.
+pub const BATCH_PAYLOAD_TYPE_BASE: u8 = 0x10;
+
+/// Payload type values range for batch payloads.
+pub const BATCH_PAYLOAD_TYPE_RANGE: Range<u8> = 0x10..0x20;
+
+idtp_data! {
+    /// Single sample of batch.
+    pub struct BatchSample<T: IdtpPayload> {
+        /// Time since previous sample in microseconds.
+        pub dt: u16,
+        /// Sample data.
+        pub sample: T,
+    }
+
+    /// Batch of consecutive samples of a standard payload.
+    pub struct ImuBatch<T: IdtpPayload, const N: usize> {
+        /// Batch samples.
+        pub samples: [BatchSample<T>; N],
+    }
+}
+
+impl<T: IdtpPayload, const N: usize> ImuBatch<T, N> {
+    /// Construct new `ImuBatch` object.
+    ///
+    /// # Parameters
+    /// - `samples` - given samples with time since previous sample in
+    ///   microseconds.
+    ///
+    /// # Returns
+    /// - New `ImuBatch` object.
+    #[must_use]
+    pub fn new(samples: [(u16, T); N]) -> Self {
+        Self {
+            samples: samples.map(|(dt, sample)| BatchSample { dt, sample }),
+        }
+    }
+}
+
+impl<T: IdtpPayload, const N: usize> IdtpPayload for ImuBatch<T, N> {
+    const TYPE_ID: u8 = {
+        assert!(
+            T::TYPE_ID < BATCH_PAYLOAD_TYPE_RANGE.end - BATCH_PAYLOAD_TYPE_BASE,
+            "only standard payloads can be batched"
+        );
+        BATCH_PAYLOAD_TYPE_BASE + T::TYPE_ID
+    };
+}
+
+/// Zero-copy view of batch payload.
+#[derive(Debug, Clone, Copy)]
+pub struct BatchView<'a, T> {
+    /// Raw batch payload.
+    bytes: &'a [u8],
+    /// Timestamp of the batch.
+    timestamp: u32,
+    /// Sample type marker.
+    marker: PhantomData<T>,
+}
+
+impl<'a, T: IdtpPayload> BatchView<'a, T> {
+    /// Size of single sample record in bytes.
+    const RECORD_SIZE: usize = size_of::<BatchSample<T>>();
+
+    /// Construct new `BatchView` object.
+    ///
+    /// # Parameters
+    /// - `bytes` - given raw batch payload.
+    /// - `timestamp` - given frame header timestamp.
+    ///
+    /// # Returns
+    /// - New `BatchView` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Parse error - if payload is not a whole number of samples.
+    pub const fn new(bytes: &'a [u8], timestamp: u32) -> IdtpResult<Self> {
+        if !bytes.len().is_multiple_of(Self::RECORD_SIZE) {
+            return Err(IdtpError::ParseError);
+        }
+
+        Ok(Self {
+            bytes,
+            timestamp,
+            marker: PhantomData,
+        })
+    }
+
+    /// Construct new `BatchView` object from frame.
+    ///
+    /// # Parameters
+    /// - `frame` - given IDTP frame.
+    ///
+    /// # Returns
+    /// - New `BatchView` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Parse error - if frame does not hold batch of `T`.
+    pub fn from_frame(frame: &'a IdtpFrame) -> IdtpResult<Self> {
+        let header = frame.header();
+
+        if header.payload_type != ImuBatch::<T, 1>::TYPE_ID {
+            return Err(IdtpError::ParseError);
+        }
+
+        Self::new(frame.payload_raw()?, header.timestamp)
+    }
+
+    /// Get number of samples.
+    ///
+    /// # Returns
+    /// - Number of samples in batch.
+    #[inline]
+    #[must_use]
+    pub const fn len(&self) -> usize {
+        self.bytes.len() / Self::RECORD_SIZE
+    }
+
+    /// Check whether batch is empty.
+    ///
+    /// # Returns
+    /// - `true` - if batch has no samples.
+    /// - `false` - otherwise.
+    #[inline]
+    #[must_use]
+    pub const fn is_empty(&self) -> bool {
+        self.bytes.is_empty()
+    }
+
+    /// Get iterator over samples.
+    ///
+    /// # Returns
+    /// - Iterator over samples with their timestamps.
+    #[must_use]
+    pub const fn iter(&self) -> BatchIter<'a, T> {
+        BatchIter {
+            bytes: self.bytes,
+            timestamp: self.timestamp,
+            marker: PhantomData,
+        }
+    }
+}
+
+impl<'a, T: IdtpPayload> IntoIterator for BatchView<'a, T> {
+    /// The type of the elements being iterated over.
+    type Item = (u32, T);
+    /// Which kind of iterator are we turning this into.
+    type IntoIter = BatchIter<'a, T>;
+
+    /// Create an iterator from a value.
+    ///
+    /// # Returns
+    /// - Iterator over samples with their timestamps.
+    fn into_iter(self) -> Self::IntoIter {
+        self.iter()
+    }
+}
+
+impl<'a, T: IdtpPayload> IntoIterator for &BatchView<'a, T> {
+    /// The type of the elements being iterated over.
+    type Item = (u32, T);
+    /// Which kind of iterator are we turning this into.
+    type IntoIter = BatchIter<'a, T>;
+
+    /// Create an iterator from a value.
+    ///
+    /// # Returns
+    /// - Iterator over samples with their timestamps.
+    fn into_iter(self) -> Self::IntoIter {
+        self.iter()
+    }
+}
+
+/// Iterator over batch samples.
+#[derive(Debug, Clone)]
+pub struct BatchIter<'a, T> {
+    /// Remaining raw samples.
+    bytes: &'a [u8],
+    /// Timestamp of the previous sample.
+    timestamp: u32,
+    /// Sample type marker.
+    marker: PhantomData<T>,
+}
+
+impl<T: IdtpPayload> Iterator for BatchIter<'_, T> {
+    /// The type of the elements being iterated over.
+    type Item = (u32, T);
+
+    /// Advance the iterator and return the next sample.
+    ///
+    /// # Returns
+    /// - Sample timestamp & data - if any.
+    /// - `None` - otherwise.
+    fn next(&mut self) -> Option<Self::Item> {
+        let (record, rest) =
+            BatchSample::<T>::read_from_prefix(self.bytes).ok()?;
+
+        self.bytes = rest;
+        self.timestamp = self.timestamp.wrapping_add(u32::from(record.dt));
+
+        Some((self.timestamp, record.sample))
+    }
+
+    /// Get bounds on the remaining length of the iterator.
+    ///
+    /// # Returns
+    /// - Exact number of remaining samples.
+    fn size_hint(&self) -> (usize, Option<usize>) {
+        let remaining = self.bytes.len() / size_of::<BatchSample<T>>();
+        (remaining, Some(remaining))
+    }
+}
+
+impl<T: IdtpPayload> ExactSizeIterator for BatchIter<'_, T> {}
@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Sensor timestamp unwrapping & sensor-to-host clock mapping.
+//!
+//! Header `timestamp` is a 32-bit sensor-local time in microseconds, which
+//! wraps every ~71.6 minutes. `TimestampTracker` extends it to 64 bits &
+//! maintains online estimate of sensor clock offset & drift against host
+//! receive time with recursive least squares (`O(1)` per frame), so frames
+//! of different devices can be placed on a common host time axis.
+
+use crate::IdtpHeader;
+
+/// Number of nanoseconds in sensor timestamp unit (microsecond).
+const NS_PER_TICK: u64 = 1000;
+
+/// Number of nanoseconds in second.
+const NS_PER_SEC: f64 = 1e9;
+
+/// Initial estimate covariance.
+const INITIAL_COVARIANCE: f64 = 1e12;
+
+/// Per-device timestamp tracker.
+#[derive(Debug, Clone, Copy)]
+pub struct TimestampTracker {
+    /// The latest raw timestamp.
+    last_raw: u32,
+    /// The latest unwrapped timestamp.
+    last: u64,
+    /// The first frame was observed.
+    started: bool,
+    /// Unwrapped sensor time of the first observed frame in nanoseconds.
+    origin_sensor: u64,
+    /// Host time of the first observed frame in nanoseconds.
+    origin_host: u64,
+    /// Estimated offset in nanoseconds & drift in nanoseconds per second.
+    theta: [f64; 2],
+    /// Estimate covariance.
+    covariance: [[f64; 2]; 2],
+    /// RLS forgetting factor.
+    forgetting: f64,
+    /// Number of observed frames.
+    samples: u64,
+}
+
+impl TimestampTracker {
+    /// Construct new `TimestampTracker` object.
+    ///
+    /// # Parameters
+    /// - `forgetting` - given RLS forgetting factor in range `(0, 1]`.
+    ///   Values close to 1 (e.g. `0.999`) track slow drift changes.
+    ///
+    /// # Returns
+    /// - New `TimestampTracker` object.
+    #[must_use]
+    pub const fn new(forgetting: f64) -> Self {
+        Self {
+            last_raw: 0,
+            last: 0,
+            started: false,
+            origin_sensor: 0,
+            origin_host: 0,
+            theta: [0.0; 2],
+            covariance: [[INITIAL_COVARIANCE, 0.0], [0.0, INITIAL_COVARIANCE]],
+            forgetting,
+            samples: 0,
+        }
+    }
+
+    /// Get number of observed frames.
+    ///
+    /// # Returns
+    /// - Number of observed frames.
+    #[inline]
+    #[must_use]
+    pub const fn samples(&self) -> u64 {
+        self.samples
+    }
+
+    /// Get estimated sensor clock drift relative to host clock.
+    ///
+    /// # Returns
+    /// - Drift in parts per million.
+    #[inline]
+    #[must_use]
+    pub const fn drift_ppm(&self) -> f64 {
+        self.theta[1] / 1e3
+    }
+
+    /// Extend raw timestamp to 64 bits relative to the latest one without
+    /// updating tracker. Timestamps up to ~35.8 minutes before or after the
+    /// latest one are handled.
+    ///
+    /// # Parameters
+    /// - `timestamp` - given raw header timestamp.
+    ///
+    /// # Returns
+    /// - Unwrapped timestamp in microseconds.
+    #[inline]
+    #[must_use]
+    #[allow(clippy::cast_possible_wrap)]
+    pub const fn extend(&self, timestamp: u32) -> u64 {
+        let delta = timestamp.wrapping_sub(self.last_raw) as i32;
+        self.last.saturating_add_signed(delta as i64)
+    }
+
+    /// Unwrap raw timestamp to 64 bits.
+    ///
+    /// # Parameters
+    /// - `timestamp` - given raw header timestamp.
+    ///
+    /// # Returns
+    /// - Unwrapped timestamp in microseconds.
+    pub const fn unwrap(&mut self, timestamp: u32) -> u64 {
+        if !self.started {
+            self.started = true;
+            self.last_raw = timestamp;
+            self.last = timestamp as u64;
+            return self.last;
+        }
+
+        let extended = self.extend(timestamp);
+
+        if extended > self.last {
+            self.last = extended;
+            self.last_raw = timestamp;
+        }
+
+        extended
+    }
+
+    /// Unwrap timestamp of received frame & update clock estimate.
+    ///
+    /// # Parameters
+    /// - `timestamp` - given raw header timestamp.
+    /// - `host_ns` - given host receive time in nanoseconds.
+    ///
+    /// # Returns
+    /// - Unwrapped timestamp in microseconds.
+    pub fn observe(&mut self, timestamp: u32, host_ns: u64) -> u64 {
+        let unwrapped = self.unwrap(timestamp);
+        let sensor_ns = unwrapped.saturating_mul(NS_PER_TICK);
+
+        if self.samples == 0 {
+            self.origin_sensor = sensor_ns;
+            self.origin_host = host_ns;
+        }
+
+        // Model: host - sensor = offset + drift * sensor time in seconds.
+        let x = relative(sensor_ns, self.origin_sensor) / NS_PER_SEC;
+        let y = relative(host_ns, self.origin_host)
+            - relative(sensor_ns, self.origin_sensor);
+
+        let [[p00, p01], [p10, p11]] = self.covariance;
+        let column0 = p00 + p01 * x;
+        let column1 = p10 + p11 * x;
+        let gain_denominator = self.forgetting + column0 + column1 * x;
+        let k0 = column0 / gain_denominator;
+        let k1 = column1 / gain_denominator;
+
+        let error = y - (self.theta[0] + self.theta[1] * x);
+        self.theta[0] += k0 * error;
+        self.theta[1] += k1 * error;
+
+        let row0 = p00 + p10 * x;
+        let row1 = p01 + p11 * x;
+        self.covariance = [
+            [
+                (p00 - k0 * row0) / self.forgetting,
+                (p01 - k0 * row1) / self.forgetting,
+            ],
+            [
+                (p10 - k1 * row0) / self.forgetting,
+                (p11 - k1 * row1) / self.forgetting,
+            ],
+        ];
+
+        self.samples += 1;
+        unwrapped
+    }
+
+    /// Map unwrapped sensor time to host time.
+    ///
+    /// # Parameters
+    /// - `unwrapped` - given unwrapped timestamp in microseconds.
+    ///
+    /// # Returns
+    /// - Estimated host time in nanoseconds.
+    #[must_use]
+    #[allow(clippy::cast_possible_truncation)]
+    pub fn host_time_from_unwrapped(&self, unwrapped: u64) -> u64 {
+        let sensor_ns = unwrapped.saturating_mul(NS_PER_TICK);
+        let x = relative(sensor_ns, self.origin_sensor);
+        let correction = self.theta[0] + self.theta[1] * x / NS_PER_SEC;
+
+        // Only delta from origin is floating-point: epoch nanoseconds do not
+        // fit into `f64` mantissa.
+        let delta = x + correction;
+        let rounding = if delta < 0.0 { -0.5 } else { 0.5 };
+        let delta = (delta + rounding) as i64;
+
+        self.origin_host
+            .checked_add_signed(delta)
+            .unwrap_or(if delta < 0 { 0 } else { u64::MAX })
+    }
+
+    /// Map raw timestamp to host time.
+    ///
+    /// # Parameters
+    /// - `timestamp` - given raw header timestamp.
+    ///
+    /// # Returns
+    /// - Estimated host time in nanoseconds.
+    #[inline]
+    #[must_use]
+    pub fn host_time_ns(&self, timestamp: u32) -> u64 {
+        self.host_time_from_unwrapped(self.extend(timestamp))
+    }
+}
+
+impl Default for TimestampTracker {
+    /// Construct default timestamp tracker with forgetting factor `0.999`.
+    ///
+    /// # Returns
+    /// - New default timestamp tracker.
+    fn default() -> Self {
+        Self::new(0.999)
+    }
+}
+
+impl IdtpHeader {
+    /// Get estimated host time of frame.
+    ///
+    /// # Parameters
+    /// - `tracker` - given timestamp tracker of frame device.
+    ///
+    /// # Returns
+    /// - Estimated host time in nanoseconds.
+    #[inline]
+    #[must_use]
+    pub fn host_time_ns(&self, tracker: &TimestampTracker) -> u64 {
+        tracker.host_time_ns(self.timestamp)
+    }
+}
+
+/// Get signed difference of two times.
+///
+/// # Parameters
+/// - `time` - given time in nanoseconds.
+/// - `origin` - given origin time in nanoseconds.
+///
+/// # Returns
+/// - `time - origin` in nanoseconds.
+#[inline]
+#[allow(clippy::cast_precision_loss)]
+fn relative(time: u64, origin: u64) -> f64 {
+    let difference = time.abs_diff(origin) as f64;
+    if time < origin {
+        -difference
+    } else {
+        difference
+    }
+}
@@ -0,0 +1,346 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Coalescing of multiple IDTP frames into a single datagram.
+//!
+//! Typical frame is much smaller than link MTU, so sending one datagram per
+//! frame multiplies per-packet costs. `Coalescer` packs whole frames
+//! back-to-back into a datagram until the next frame does not fit into MTU
+//! or the oldest frame has waited for the configured delay. Time is supplied
+//! by caller in microseconds. Receiver splits datagram by walking headers
+//! (`preamble` & `payload_size`) with `DatagramFrames` & validates frames as
+//! a batch.
+
+use crate::{
+    IDTP_HEADER_SIZE, IDTP_PREAMBLE, IdtpError, IdtpFrame, IdtpHeader,
+    IdtpMode, IdtpResult,
+};
+use zerocopy::FromBytes;
+
+/// Default MTU: Ethernet MTU without IPv4 & UDP headers.
+pub const COALESCE_DEFAULT_MTU: usize = 1500 - 20 - 8;
+
+/// Coalescing statistics.
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct CoalesceStats {
+    /// Number of coalesced frames.
+    pub frames: u64,
+    /// Number of emitted datagrams.
+    pub datagrams: u64,
+    /// Sum of delays of all frames in microseconds.
+    pub total_delay: u64,
+    /// Max delay of a frame in microseconds.
+    pub max_delay: u64,
+}
+
+impl CoalesceStats {
+    /// Get mean delay of a frame.
+    ///
+    /// # Returns
+    /// - Mean delay in microseconds - if any frame was emitted.
+    /// - `None` - otherwise.
+    #[must_use]
+    #[allow(clippy::cast_precision_loss)]
+    pub fn mean_delay(&self) -> Option<f64> {
+        (self.frames > 0).then(|| self.total_delay as f64 / self.frames as f64)
+    }
+}
+
+/// Sender-side frame coalescer.
+///
+/// # Parameters
+/// - `N` - datagram buffer capacity in bytes.
+#[derive(Debug, Clone)]
+pub struct Coalescer<const N: usize> {
+    /// Pending datagram.
+    buffer: [u8; N],
+    /// Size of pending datagram in bytes.
+    len: usize,
+    /// Max datagram size in bytes.
+    mtu: usize,
+    /// Max delay of a frame in microseconds.
+    max_delay: u64,
+    /// Time of the oldest pending frame.
+    opened_at: u64,
+    /// Number of pending frames.
+    pending: u64,
+    /// Sum of push times of pending frames.
+    pending_time: u64,
+    /// Coalescing statistics.
+    stats: CoalesceStats,
+}
+
+impl<const N: usize> Coalescer<N> {
+    /// Construct new `Coalescer` object.
+    ///
+    /// # Parameters
+    /// - `mtu` - given max datagram size in bytes, at most `N`.
+    /// - `max_delay` - given max delay of a frame in microseconds.
+    ///
+    /// # Returns
+    /// - New `Coalescer` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if `mtu` exceeds buffer capacity.
+    /// - Buffer underflow - if `mtu` is less than header size.
+    pub const fn new(mtu: usize, max_delay: u64) -> IdtpResult<Self> {
+        if mtu > N {
+            return Err(IdtpError::BufferOverflow);
+        }
+
+        if mtu < IDTP_HEADER_SIZE {
+            return Err(IdtpError::BufferUnderflow);
+        }
+
+        Ok(Self {
+            buffer: [0; N],
+            len: 0,
+            mtu,
+            max_delay,
+            opened_at: 0,
+            pending: 0,
+            pending_time: 0,
+            stats: CoalesceStats {
+                frames: 0,
+                datagrams: 0,
+                total_delay: 0,
+                max_delay: 0,
+            },
+        })
+    }
+
+    /// Get coalescing statistics.
+    ///
+    /// # Returns
+    /// - Coalescing statistics.
+    #[inline]
+    #[must_use]
+    pub const fn stats(&self) -> &CoalesceStats {
+        &self.stats
+    }
+
+    /// Get time when pending datagram must be emitted.
+    ///
+    /// # Returns
+    /// - Deadline in microseconds - if any frame is pending.
+    /// - `None` - otherwise.
+    #[inline]
+    #[must_use]
+    pub const fn deadline(&self) -> Option<u64> {
+        if self.len == 0 {
+            return None;
+        }
+
+        Some(self.opened_at.saturating_add(self.max_delay))
+    }
+
+    /// Append frame to pending datagram.
+    ///
+    /// # Parameters
+    /// - `frame` - given raw IDTP frame.
+    /// - `now` - given current time in microseconds.
+    /// - `emit` - given closure that sends datagram.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if frame is larger than MTU.
+    pub fn push<E>(
+        &mut self,
+        frame: &[u8],
+        now: u64,
+        mut emit: E,
+    ) -> IdtpResult<()>
+    where
+        E: FnMut(&[u8]),
+    {
+        if frame.len() > self.mtu {
+            return Err(IdtpError::BufferOverflow);
+        }
+
+        if self.len + frame.len() > self.mtu {
+            self.flush(now, &mut emit);
+        }
+
+        let end = self.len + frame.len();
+
+        self.buffer
+            .get_mut(self.len..end)
+            .ok_or(IdtpError::BufferOverflow)?
+            .copy_from_slice(frame);
+
+        if self.len == 0 {
+            self.opened_at = now;
+        }
+
+        self.len = end;
+        self.pending += 1;
+        self.pending_time += now;
+
+        // No frame fits into the rest of datagram.
+        if self.mtu - self.len < IDTP_HEADER_SIZE {
+            self.flush(now, &mut emit);
+        } else {
+            self.poll(now, &mut emit);
+        }
+
+        Ok(())
+    }
+
+    /// Emit pending datagram if its deadline has passed.
+    ///
+    /// # Parameters
+    /// - `now` - given current time in microseconds.
+    /// - `emit` - given closure that sends datagram.
+    ///
+    /// # Returns
+    /// - `true` - if datagram was emitted.
+    /// - `false` - otherwise.
+    pub fn poll<E>(&mut self, now: u64, emit: E) -> bool
+    where
+        E: FnMut(&[u8]),
+    {
+        match self.deadline() {
+            Some(deadline) if now >= deadline => self.flush(now, emit),
+            _ => false,
+        }
+    }
+
+    /// Emit pending datagram.
+    ///
+    /// # Parameters
+    /// - `now` - given current time in microseconds.
+    /// - `emit` - given closure that sends datagram.
+    ///
+    /// # Returns
+    /// - `true` - if datagram was emitted.
+    /// - `false` - if nothing is pending.
+    pub fn flush<E>(&mut self, now: u64, mut emit: E) -> bool
+    where
+        E: FnMut(&[u8]),
+    {
+        if self.len == 0 {
+            return false;
+        }
+
+        emit(self.buffer.get(..self.len).unwrap_or_default());
+
+        let delay = now.saturating_sub(self.opened_at);
+        self.stats.frames += self.pending;
+        self.stats.datagrams += 1;
+        self.stats.total_delay += self
+            .pending
+            .saturating_mul(now)
+            .saturating_sub(self.pending_time);
+        self.stats.max_delay = self.stats.max_delay.max(delay);
+
+        self.len = 0;
+        self.pending = 0;
+        self.pending_time = 0;
+        true
+    }
+}
+
+/// Iterator over frames of coalesced datagram.
+///
+/// Frame boundaries are found from header `payload_size` & `mode`, frames are
+/// not validated. Iteration stops after the first malformed frame.
+#[derive(Debug, Clone)]
+pub struct DatagramFrames<'a> {
+    /// Remaining datagram bytes.
+    bytes: &'a [u8],
+}
+
+impl<'a> DatagramFrames<'a> {
+    /// Construct new `DatagramFrames` object.
+    ///
+    /// # Parameters
+    /// - `datagram` - given received datagram.
+    ///
+    /// # Returns
+    /// - New `DatagramFrames` object.
+    #[must_use]
+    pub const fn new(datagram: &'a [u8]) -> Self {
+        Self { bytes: datagram }
+    }
+
+    /// Collect frames into slice, e.g. for `ParallelValidator`.
+    ///
+    /// # Parameters
+    /// - `frames` - given buffer to store frames.
+    ///
+    /// # Returns
+    /// - Number of frames - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if datagram holds more frames than `frames`.
+    /// - Buffer underflow - if datagram ends with truncated frame.
+    /// - Parse error - if frame header is malformed.
+    pub fn collect_into(self, frames: &mut [&'a [u8]]) -> IdtpResult<usize> {
+        let mut count = 0;
+
+        for frame in self {
+            *frames.get_mut(count).ok_or(IdtpError::BufferOverflow)? = frame?;
+            count += 1;
+        }
+
+        Ok(count)
+    }
+
+    /// Get size of the next frame.
+    ///
+    /// # Returns
+    /// - Frame size in bytes - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow - if frame is truncated.
+    /// - Parse error - if frame header is malformed.
+    fn next_size(&self) -> IdtpResult<usize> {
+        let (header, _) = IdtpHeader::read_from_prefix(self.bytes)
+            .map_err(|_| IdtpError::BufferUnderflow)?;
+
+        if header.preamble != IDTP_PREAMBLE {
+            return Err(IdtpError::ParseError);
+        }
+
+        let mode = IdtpMode::try_from(header.mode)?;
+        let size = IDTP_HEADER_SIZE
+            + usize::from(header.payload_size)
+            + IdtpFrame::trailer_size_from(mode);
+
+        if size > self.bytes.len() {
+            return Err(IdtpError::BufferUnderflow);
+        }
+
+        Ok(size)
+    }
+}
+
+impl<'a> Iterator for DatagramFrames<'a> {
+    /// The type of the elements being iterated over.
+    type Item = IdtpResult<&'a [u8]>;
+
+    /// Advance the iterator and return the next frame.
+    ///
+    /// # Returns
+    /// - Raw frame or error - if any bytes remain.
+    /// - `None` - otherwise.
+    fn next(&mut self) -> Option<Self::Item> {
+        if self.bytes.is_empty() {
+            return None;
+        }
+
+        match self.next_size() {
+            Ok(size) => {
+                let (frame, rest) = self.bytes.split_at_checked(size)?;
+                self.bytes = rest;
+                Some(Ok(frame))
+            }
+            Err(error) => {
+                self.bytes = &[];
+                Some(Err(error))
+            }
+        }
+    }
+}
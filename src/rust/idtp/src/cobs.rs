@@ -0,0 +1,309 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Consistent Overhead Byte Stuffing (COBS) link-layer framing.
+//!
+//! Packed IDTP frames are encoded so that they contain no zero bytes and are
+//! terminated with a zero delimiter. After corruption the receiver
+//! resynchronises on the next delimiter, so the payload content
+//! (e.g. preamble-like float values) cannot produce false frame candidates.
+//! Zero search & copying are performed word-at-a-time.
+
+use crate::{IDTP_FRAME_MAX_SIZE, IdtpError, IdtpResult};
+
+/// Frame delimiter value.
+pub const COBS_DELIMITER: u8 = 0x00;
+
+/// Max size of COBS-encoded IDTP frame in bytes, including delimiter.
+pub const COBS_FRAME_MAX_SIZE: usize = max_encoded_size(IDTP_FRAME_MAX_SIZE);
+
+/// Max number of non-zero bytes in a single COBS block.
+const BLOCK_MAX_SIZE: usize = 254;
+
+/// Word with all bytes set to `0x01`.
+const LO_BITS: u64 = 0x0101_0101_0101_0101;
+
+/// Word with all bytes set to `0x80`.
+const HI_BITS: u64 = 0x8080_8080_8080_8080;
+
+/// Get max size of encoded data.
+///
+/// # Parameters
+/// - `size` - given size of raw data in bytes.
+///
+/// # Returns
+/// - Max size of encoded data in bytes, including delimiter.
+#[inline]
+#[must_use]
+pub const fn max_encoded_size(size: usize) -> usize {
+    size + size / BLOCK_MAX_SIZE + 2
+}
+
+/// Find position of the first zero byte.
+///
+/// # Parameters
+/// - `data` - given data to handle.
+///
+/// # Returns
+/// - Position of the first zero byte - if found.
+/// - `None` - otherwise.
+#[inline]
+#[must_use]
+pub fn find_delimiter(data: &[u8]) -> Option<usize> {
+    let mut chunks = data.chunks_exact(size_of::<u64>());
+    let mut offset = 0;
+
+    for chunk in &mut chunks {
+        let word = u64::from_le_bytes(chunk.try_into().unwrap_or_default());
+        let zeros = word.wrapping_sub(LO_BITS) & !word & HI_BITS;
+
+        if zeros != 0 {
+            return Some(offset + (zeros.trailing_zeros() / 8) as usize);
+        }
+        offset += size_of::<u64>();
+    }
+
+    chunks
+        .remainder()
+        .iter()
+        .position(|byte| *byte == COBS_DELIMITER)
+        .map(|position| offset + position)
+}
+
+/// Encode data & append delimiter.
+///
+/// # Parameters
+/// - `input` - given raw data to encode.
+/// - `output` - given buffer to store encoded data.
+///
+/// # Returns
+/// - Size of encoded data in bytes, including delimiter - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer underflow.
+pub fn encode(input: &[u8], output: &mut [u8]) -> IdtpResult<usize> {
+    let mut rest = input;
+    let mut position = 0;
+
+    loop {
+        let window = rest.get(..rest.len().min(BLOCK_MAX_SIZE));
+        let window = window.unwrap_or_default();
+
+        let (run, zero) = find_delimiter(window)
+            .map_or((window.len(), false), |position| (position, true));
+
+        let block = output
+            .get_mut(position..=position + run)
+            .ok_or(IdtpError::BufferUnderflow)?;
+
+        let (code, data) =
+            block.split_first_mut().ok_or(IdtpError::BufferUnderflow)?;
+
+        #[allow(clippy::cast_possible_truncation)]
+        {
+            *code = (run + 1) as u8;
+        }
+        data.copy_from_slice(window.get(..run).unwrap_or_default());
+
+        position += run + 1;
+        rest = rest.get(run + usize::from(zero)..).unwrap_or_default();
+
+        if !zero && (run < BLOCK_MAX_SIZE || rest.is_empty()) {
+            break;
+        }
+    }
+
+    *output.get_mut(position).ok_or(IdtpError::BufferUnderflow)? =
+        COBS_DELIMITER;
+
+    Ok(position + 1)
+}
+
+/// Decode data in place.
+///
+/// # Parameters
+/// - `buffer` - given encoded data without delimiter.
+///
+/// # Returns
+/// - Size of decoded data in bytes - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Parse error.
+pub fn decode_in_place(buffer: &mut [u8]) -> IdtpResult<usize> {
+    let size = buffer.len();
+    let mut read = 0;
+    let mut write = 0;
+
+    while read < size {
+        let code = usize::from(*buffer.get(read).unwrap_or(&0));
+        let end = read + code;
+
+        if code == 0 || end > size {
+            return Err(IdtpError::ParseError);
+        }
+
+        let block = buffer.get(read + 1..end).unwrap_or_default();
+
+        if find_delimiter(block).is_some() {
+            return Err(IdtpError::ParseError);
+        }
+
+        buffer.copy_within(read + 1..end, write);
+        write += code - 1;
+        read = end;
+
+        if code <= BLOCK_MAX_SIZE && read < size {
+            *buffer.get_mut(write).ok_or(IdtpError::ParseError)? = 0;
+            write += 1;
+        }
+    }
+
+    Ok(write)
+}
+
+/// Decode data.
+///
+/// # Parameters
+/// - `input` - given encoded data without delimiter.
+/// - `output` - given buffer to store decoded data. Its size **MUST NOT** be
+///   less than size of encoded data.
+///
+/// # Returns
+/// - Size of decoded data in bytes - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer underflow.
+/// - Parse error.
+pub fn decode(input: &[u8], output: &mut [u8]) -> IdtpResult<usize> {
+    let buffer = output
+        .get_mut(..input.len())
+        .ok_or(IdtpError::BufferUnderflow)?;
+
+    buffer.copy_from_slice(input);
+    decode_in_place(buffer)
+}
+
+/// Decoder for COBS-framed IDTP frames received over a byte stream.
+#[derive(Debug, Clone)]
+pub struct CobsDecoder {
+    /// Buffer for encoded frame being received.
+    buffer: [u8; COBS_FRAME_MAX_SIZE],
+    /// Number of bytes stored in buffer.
+    len: usize,
+    /// Size of decoded frame or 0 if there is no complete frame.
+    frame_size: usize,
+    /// Bytes are dropped until the next delimiter.
+    skipping: bool,
+    /// Number of bytes dropped during resynchronisation.
+    discarded: usize,
+}
+
+impl CobsDecoder {
+    /// Construct new `CobsDecoder` object.
+    ///
+    /// # Returns
+    /// - New `CobsDecoder` object.
+    #[must_use]
+    pub const fn new() -> Self {
+        Self {
+            buffer: [0u8; COBS_FRAME_MAX_SIZE],
+            len: 0,
+            frame_size: 0,
+            skipping: false,
+            discarded: 0,
+        }
+    }
+
+    /// Get number of bytes dropped during resynchronisation.
+    ///
+    /// # Returns
+    /// - Number of dropped bytes since decoder construction.
+    #[inline]
+    #[must_use]
+    pub const fn discarded(&self) -> usize {
+        self.discarded
+    }
+
+    /// Feed incoming bytes to decoder. Frame trailer is not checked.
+    ///
+    /// # Parameters
+    /// - `input` - given incoming bytes.
+    ///
+    /// # Returns
+    /// - Number of consumed bytes & decoded frame if any.
+    pub fn feed(&mut self, input: &[u8]) -> (usize, Option<&[u8]>) {
+        if self.frame_size != 0 {
+            self.frame_size = 0;
+            self.len = 0;
+        }
+
+        let mut consumed = 0;
+
+        while consumed < input.len() {
+            let rest = input.get(consumed..).unwrap_or_default();
+            let delimiter = find_delimiter(rest);
+            let chunk = rest.get(..delimiter.unwrap_or(rest.len()));
+            let chunk = chunk.unwrap_or_default();
+
+            consumed += chunk.len() + usize::from(delimiter.is_some());
+
+            if !self.skipping {
+                let end = self.len + chunk.len();
+
+                if let Some(buffer) = self.buffer.get_mut(self.len..end) {
+                    buffer.copy_from_slice(chunk);
+                    self.len = end;
+                } else {
+                    self.skipping = true;
+                }
+            }
+
+            if self.skipping {
+                self.discarded += self.len + chunk.len();
+                self.len = 0;
+            }
+
+            if delimiter.is_none() {
+                break;
+            }
+
+            if self.skipping {
+                self.skipping = false;
+                self.discarded += 1;
+                continue;
+            }
+
+            if self.len == 0 {
+                continue;
+            }
+
+            let encoded = self.buffer.get_mut(..self.len).unwrap_or_default();
+
+            match decode_in_place(encoded) {
+                Ok(size) if size > 0 => {
+                    self.frame_size = size;
+                    return (consumed, self.buffer.get(..size));
+                }
+                _ => {
+                    self.discarded += self.len + 1;
+                    self.len = 0;
+                }
+            }
+        }
+
+        (consumed, None)
+    }
+}
+
+impl Default for CobsDecoder {
+    /// Construct default COBS decoder.
+    ///
+    /// # Returns
+    /// - New default COBS decoder.
+    fn default() -> Self {
+        Self::new()
+    }
+}
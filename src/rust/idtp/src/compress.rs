@@ -0,0 +1,625 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Compressed multi-sample payloads.
+//!
+//! IMU signals are highly autocorrelated, so consecutive samples of the same
+//! field differ little. Two codecs are provided for sequences of samples of a
+//! standard payload within one frame:
+//!
+//! - XOR codec for `f32` payloads (Gorilla-style): each field is XOR-ed with
+//!   the previous value of the same field & only meaningful bits between
+//!   leading & trailing zeros are stored. Payload type is
+//!   `XOR_PAYLOAD_TYPE_BASE + T::TYPE_ID`.
+//! - Delta codec for quantised payloads: each exponent & field is stored as
+//!   zig-zag varint of difference with the previous one. Payload type is
+//!   `DELTA_PAYLOAD_TYPE_BASE + T::TYPE_ID`.
+//!
+//! Each sample carries time since previous sample in microseconds like in
+//! batch payloads. Payload starts with `u16` number of samples. Decoders
+//! write samples straight into structure-of-arrays (column-major) buffers.
+
+use crate::{
+    IdtpError, IdtpResult,
+    payload::{AsMetricsArray, IdtpPayload},
+    quantized::{self, Quantized},
+    varint::{read_varint, unzigzag, write_varint, zigzag},
+};
+use core::ops::Range;
+
+/// Payload type of XOR-compressed `Imu3Acc` samples. Payload type of other
+/// standard payloads is offset by their payload type.
+pub const XOR_PAYLOAD_TYPE_BASE: u8 = 0x30;
+
+/// Payload type values range for XOR-compressed payloads.
+pub const XOR_PAYLOAD_TYPE_RANGE: Range<u8> = 0x30..0x40;
+
+/// Payload type of delta-compressed quantised `Imu3Acc` samples. Payload type
+/// of other standard payloads is offset by their payload type.
+pub const DELTA_PAYLOAD_TYPE_BASE: u8 = 0x40;
+
+/// Payload type values range for delta-compressed payloads.
+pub const DELTA_PAYLOAD_TYPE_RANGE: Range<u8> = 0x40..0x50;
+
+/// Size of number of samples field in bytes.
+const COUNT_SIZE: usize = size_of::<u16>();
+
+/// Number of bits of zig-zag encoded time delta change.
+const DT_BITS: u32 = 17;
+
+/// MSB-first bit packer.
+#[derive(Debug)]
+pub struct BitWriter<'a> {
+    /// Output buffer.
+    buffer: &'a mut [u8],
+    /// Number of written bytes.
+    position: usize,
+    /// Pending bits in the lowest bits.
+    accumulator: u64,
+    /// Number of pending bits.
+    pending: u32,
+}
+
+impl<'a> BitWriter<'a> {
+    /// Construct new `BitWriter` object.
+    ///
+    /// # Parameters
+    /// - `buffer` - given output buffer.
+    ///
+    /// # Returns
+    /// - New `BitWriter` object.
+    #[must_use]
+    pub const fn new(buffer: &'a mut [u8]) -> Self {
+        Self {
+            buffer,
+            position: 0,
+            accumulator: 0,
+            pending: 0,
+        }
+    }
+
+    /// Write bits.
+    ///
+    /// # Parameters
+    /// - `value` - given value, only the lowest `count` bits are written.
+    /// - `count` - given number of bits, at most 32.
+    ///
+    /// # Errors
+    /// - Buffer overflow.
+    #[allow(clippy::cast_possible_truncation)]
+    pub fn write(&mut self, value: u32, count: u32) -> IdtpResult<()> {
+        self.accumulator =
+            (self.accumulator << count) | (u64::from(value) & mask(count));
+        self.pending += count;
+
+        while self.pending >= 8 {
+            self.pending -= 8;
+            *self
+                .buffer
+                .get_mut(self.position)
+                .ok_or(IdtpError::BufferOverflow)? =
+                (self.accumulator >> self.pending) as u8;
+            self.position += 1;
+        }
+
+        Ok(())
+    }
+
+    /// Flush pending bits padded with zeros.
+    ///
+    /// # Returns
+    /// - Number of written bytes - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow.
+    pub fn finish(mut self) -> IdtpResult<usize> {
+        if self.pending > 0 {
+            self.write(0, 8 - self.pending)?;
+        }
+
+        Ok(self.position)
+    }
+}
+
+/// MSB-first bit unpacker.
+#[derive(Debug)]
+pub struct BitReader<'a> {
+    /// Input buffer.
+    buffer: &'a [u8],
+    /// Number of read bytes.
+    position: usize,
+    /// Buffered bits in the lowest bits.
+    accumulator: u64,
+    /// Number of buffered bits.
+    available: u32,
+}
+
+impl<'a> BitReader<'a> {
+    /// Construct new `BitReader` object.
+    ///
+    /// # Parameters
+    /// - `buffer` - given input buffer.
+    ///
+    /// # Returns
+    /// - New `BitReader` object.
+    #[must_use]
+    pub const fn new(buffer: &'a [u8]) -> Self {
+        Self {
+            buffer,
+            position: 0,
+            accumulator: 0,
+            available: 0,
+        }
+    }
+
+    /// Read bits.
+    ///
+    /// # Parameters
+    /// - `count` - given number of bits, at most 32.
+    ///
+    /// # Returns
+    /// - Read bits - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    #[allow(clippy::cast_possible_truncation)]
+    pub fn read(&mut self, count: u32) -> IdtpResult<u32> {
+        while self.available < count {
+            let byte = self
+                .buffer
+                .get(self.position)
+                .ok_or(IdtpError::BufferUnderflow)?;
+
+            self.accumulator = (self.accumulator << 8) | u64::from(*byte);
+            self.available += 8;
+            self.position += 1;
+        }
+
+        self.available -= count;
+        Ok(((self.accumulator >> self.available) & mask(count)) as u32)
+    }
+}
+
+/// XOR codec state of a single field.
+#[derive(Debug, Default, Clone, Copy)]
+struct XorState {
+    /// Previous value bits.
+    previous: u32,
+    /// Number of leading zeros of the current window.
+    leading: u32,
+    /// Number of trailing zeros of the current window.
+    trailing: u32,
+    /// Window is set.
+    has_window: bool,
+}
+
+impl XorState {
+    /// Encode value.
+    ///
+    /// # Parameters
+    /// - `writer` - given bit writer.
+    /// - `value` - given value bits.
+    ///
+    /// # Errors
+    /// - Buffer overflow.
+    fn encode(&mut self, writer: &mut BitWriter, value: u32) -> IdtpResult<()> {
+        let xor = value ^ self.previous;
+        self.previous = value;
+
+        if xor == 0 {
+            return writer.write(0, 1);
+        }
+
+        let leading = xor.leading_zeros();
+        let trailing = xor.trailing_zeros();
+
+        if self.has_window
+            && leading >= self.leading
+            && trailing >= self.trailing
+        {
+            writer.write(0b10, 2)?;
+            return writer.write(
+                xor >> self.trailing,
+                32 - self.leading - self.trailing,
+            );
+        }
+
+        let meaningful = 32 - leading - trailing;
+
+        writer.write(0b11, 2)?;
+        writer.write(leading, 5)?;
+        writer.write(meaningful - 1, 5)?;
+        writer.write(xor >> trailing, meaningful)?;
+
+        self.leading = leading;
+        self.trailing = trailing;
+        self.has_window = true;
+
+        Ok(())
+    }
+
+    /// Decode value.
+    ///
+    /// # Parameters
+    /// - `reader` - given bit reader.
+    ///
+    /// # Returns
+    /// - Value bits - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Parse error.
+    fn decode(&mut self, reader: &mut BitReader) -> IdtpResult<u32> {
+        if reader.read(1)? == 0 {
+            return Ok(self.previous);
+        }
+
+        if reader.read(1)? == 1 {
+            let leading = reader.read(5)?;
+            let meaningful = reader.read(5)? + 1;
+
+            self.trailing = 32u32
+                .checked_sub(leading + meaningful)
+                .ok_or(IdtpError::ParseError)?;
+            self.leading = leading;
+            self.has_window = true;
+        } else if !self.has_window {
+            return Err(IdtpError::ParseError);
+        }
+
+        let meaningful = 32 - self.leading - self.trailing;
+        let xor = reader.read(meaningful)? << self.trailing;
+
+        self.previous ^= xor;
+        Ok(self.previous)
+    }
+}
+
+/// Compress `f32` standard payload samples with XOR codec.
+///
+/// # Parameters
+/// - `samples` - given samples with time since previous sample in
+///   microseconds.
+/// - `output` - given buffer to store payload.
+///
+/// # Returns
+/// - Payload size in bytes - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer overflow.
+pub fn compress_xor<T, const N: usize>(
+    samples: &[(u16, T)],
+    output: &mut [u8],
+) -> IdtpResult<usize>
+where
+    T: IdtpPayload + AsMetricsArray<N>,
+{
+    let (count, stream) = split_count(output, samples.len())?;
+    let mut writer = BitWriter::new(stream);
+    let mut states = [XorState::default(); N];
+    let mut previous_dt = 0;
+
+    for (dt, sample) in samples {
+        encode_dt(&mut writer, *dt, &mut previous_dt)?;
+
+        for (state, value) in states.iter_mut().zip(sample.to_array()) {
+            state.encode(&mut writer, value.to_bits())?;
+        }
+    }
+
+    Ok(count + writer.finish()?)
+}
+
+/// Decompress XOR-compressed payload into column-major buffers.
+///
+/// # Parameters
+/// - `payload` - given compressed payload.
+/// - `timestamp` - given frame header timestamp.
+/// - `timestamps` - given buffer to store sample timestamps. Its length is
+///   the capacity of each column.
+/// - `columns` - given column-major buffer of `N` columns to store fields:
+///   field `f` of sample `i` is stored at `f * timestamps.len() + i`.
+///
+/// # Returns
+/// - Number of samples - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer underflow - if payload is truncated or `columns` is too short.
+/// - Buffer overflow - if buffers are too short for all samples.
+/// - Parse error.
+pub fn decompress_xor<const N: usize>(
+    payload: &[u8],
+    timestamp: u32,
+    timestamps: &mut [u32],
+    columns: &mut [f32],
+) -> IdtpResult<usize> {
+    let (count, stream) = read_count(payload, timestamps, columns, N)?;
+    let capacity = timestamps.len();
+    let mut reader = BitReader::new(stream);
+    let mut states = [XorState::default(); N];
+    let mut time = Timeline::new(timestamp);
+
+    for (index, slot) in timestamps.iter_mut().enumerate().take(count) {
+        *slot = time.decode(&mut reader)?;
+
+        for (field, state) in states.iter_mut().enumerate() {
+            let value = f32::from_bits(state.decode(&mut reader)?);
+            *columns
+                .get_mut(field * capacity + index)
+                .ok_or(IdtpError::BufferOverflow)? = value;
+        }
+    }
+
+    Ok(count)
+}
+
+/// Compress quantised payload samples with delta codec.
+///
+/// # Parameters
+/// - `samples` - given samples with time since previous sample in
+///   microseconds.
+/// - `output` - given buffer to store payload.
+///
+/// # Returns
+/// - Payload size in bytes - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer overflow.
+pub fn compress_delta<T, const N: usize, const G: usize>(
+    samples: &[(u16, Quantized<T, N, G>)],
+    output: &mut [u8],
+) -> IdtpResult<usize>
+where
+    T: IdtpPayload + AsMetricsArray<N>,
+{
+    let (count, stream) = split_count(output, samples.len())?;
+    let mut position = 0;
+    let mut previous_dt = 0;
+    let mut previous_exponents = [0i8; G];
+    let mut previous_values = [0i16; N];
+
+    for (dt, sample) in samples {
+        let delta = i32::from(*dt) - i32::from(previous_dt);
+        previous_dt = *dt;
+        write_varint(stream, &mut position, zigzag(delta))?;
+
+        let exponents = sample.exponents;
+        let values = sample.values;
+
+        for (previous, exponent) in previous_exponents.iter_mut().zip(exponents)
+        {
+            let delta = i32::from(exponent) - i32::from(*previous);
+            *previous = exponent;
+            write_varint(stream, &mut position, zigzag(delta))?;
+        }
+
+        for (previous, value) in previous_values.iter_mut().zip(values) {
+            let delta = i32::from(value) - i32::from(*previous);
+            *previous = value;
+            write_varint(stream, &mut position, zigzag(delta))?;
+        }
+    }
+
+    Ok(count + position)
+}
+
+/// Decompress delta-compressed quantised payload into column-major buffers
+/// of dequantised values.
+///
+/// # Parameters
+/// - `payload` - given compressed payload.
+/// - `timestamp` - given frame header timestamp.
+/// - `timestamps` - given buffer to store sample timestamps. Its length is
+///   the capacity of each column.
+/// - `columns` - given column-major buffer of `N` columns to store fields:
+///   field `f` of sample `i` is stored at `f * timestamps.len() + i`.
+///
+/// # Returns
+/// - Number of samples - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer underflow - if payload is truncated or `columns` is too short.
+/// - Buffer overflow - if buffers are too short for all samples.
+/// - Parse error - if payload is malformed, e.g. accumulated delta
+///   overflows.
+pub fn decompress_delta<const N: usize, const G: usize>(
+    payload: &[u8],
+    timestamp: u32,
+    timestamps: &mut [u32],
+    columns: &mut [f32],
+) -> IdtpResult<usize> {
+    let (count, stream) = read_count(payload, timestamps, columns, N)?;
+    let capacity = timestamps.len();
+    let mut position = 0;
+    let mut time = timestamp;
+    let mut dt = 0i32;
+    let mut exponents = [0i32; G];
+    let mut values = [0i32; N];
+
+    for (index, slot) in timestamps.iter_mut().enumerate().take(count) {
+        dt = dt
+            .checked_add(unzigzag(read_varint(stream, &mut position)?))
+            .ok_or(IdtpError::ParseError)?;
+        time = time.wrapping_add(
+            u32::try_from(dt).map_err(|_| IdtpError::ParseError)?,
+        );
+        *slot = time;
+
+        for exponent in &mut exponents {
+            *exponent = exponent
+                .checked_add(unzigzag(read_varint(stream, &mut position)?))
+                .ok_or(IdtpError::ParseError)?;
+        }
+
+        for (field, value) in values.iter_mut().enumerate() {
+            *value = value
+                .checked_add(unzigzag(read_varint(stream, &mut position)?))
+                .ok_or(IdtpError::ParseError)?;
+
+            let exponent = exponents
+                .get(field / quantized::QUANTIZED_GROUP_SIZE)
+                .copied()
+                .unwrap_or_default();
+            let exponent =
+                i8::try_from(exponent).map_err(|_| IdtpError::ParseError)?;
+
+            *columns
+                .get_mut(field * capacity + index)
+                .ok_or(IdtpError::BufferOverflow)? = f32::from(
+                i16::try_from(*value).map_err(|_| IdtpError::ParseError)?,
+            )
+                * quantized::power_of_two(exponent);
+        }
+    }
+
+    Ok(count)
+}
+
+/// Decoder of sample timestamps.
+struct Timeline {
+    /// Timestamp of the previous sample.
+    timestamp: u32,
+    /// Time delta of the previous sample.
+    dt: u16,
+}
+
+impl Timeline {
+    /// Construct new `Timeline` object.
+    ///
+    /// # Parameters
+    /// - `timestamp` - given frame header timestamp.
+    ///
+    /// # Returns
+    /// - New `Timeline` object.
+    const fn new(timestamp: u32) -> Self {
+        Self { timestamp, dt: 0 }
+    }
+
+    /// Decode timestamp of the next sample.
+    ///
+    /// # Parameters
+    /// - `reader` - given bit reader.
+    ///
+    /// # Returns
+    /// - Sample timestamp - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Parse error.
+    fn decode(&mut self, reader: &mut BitReader) -> IdtpResult<u32> {
+        if reader.read(1)? == 1 {
+            let delta = unzigzag(reader.read(DT_BITS)?);
+            self.dt = u16::try_from(i32::from(self.dt) + delta)
+                .map_err(|_| IdtpError::ParseError)?;
+        }
+
+        self.timestamp = self.timestamp.wrapping_add(u32::from(self.dt));
+        Ok(self.timestamp)
+    }
+}
+
+/// Encode sample time delta as change of the previous one.
+///
+/// # Parameters
+/// - `writer` - given bit writer.
+/// - `dt` - given time since previous sample.
+/// - `previous` - given time delta of the previous sample.
+///
+/// # Errors
+/// - Buffer overflow.
+fn encode_dt(
+    writer: &mut BitWriter,
+    dt: u16,
+    previous: &mut u16,
+) -> IdtpResult<()> {
+    let delta = i32::from(dt) - i32::from(*previous);
+    *previous = dt;
+
+    if delta == 0 {
+        writer.write(0, 1)
+    } else {
+        writer.write(1, 1)?;
+        writer.write(zigzag(delta), DT_BITS)
+    }
+}
+
+/// Write number of samples & split payload buffer.
+///
+/// # Parameters
+/// - `output` - given payload buffer.
+/// - `count` - given number of samples.
+///
+/// # Returns
+/// - Size of number of samples & the rest of buffer - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer overflow.
+fn split_count(
+    output: &mut [u8],
+    count: usize,
+) -> IdtpResult<(usize, &mut [u8])> {
+    let count = u16::try_from(count).map_err(|_| IdtpError::BufferOverflow)?;
+    let (head, stream) = output
+        .split_at_mut_checked(COUNT_SIZE)
+        .ok_or(IdtpError::BufferOverflow)?;
+
+    head.copy_from_slice(&count.to_le_bytes());
+    Ok((COUNT_SIZE, stream))
+}
+
+/// Read number of samples & check output buffers.
+///
+/// # Parameters
+/// - `payload` - given compressed payload.
+/// - `timestamps` - given buffer to store sample timestamps.
+/// - `columns` - given column-major buffer to store fields.
+/// - `fields` - given number of fields.
+///
+/// # Returns
+/// - Number of samples & compressed stream - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer underflow - if payload is truncated or `columns` is too short.
+/// - Buffer overflow - if `timestamps` is too short for all samples.
+fn read_count<'a>(
+    payload: &'a [u8],
+    timestamps: &[u32],
+    columns: &[f32],
+    fields: usize,
+) -> IdtpResult<(usize, &'a [u8])> {
+    let (head, stream) = payload
+        .split_first_chunk::<COUNT_SIZE>()
+        .ok_or(IdtpError::BufferUnderflow)?;
+    let count = usize::from(u16::from_le_bytes(*head));
+
+    if count > timestamps.len() {
+        return Err(IdtpError::BufferOverflow);
+    }
+
+    if columns.len() < fields * timestamps.len() {
+        return Err(IdtpError::BufferUnderflow);
+    }
+
+    Ok((count, stream))
+}
+
+/// Get mask of the lowest bits.
+///
+/// # Parameters
+/// - `count` - given number of bits, at most 32.
+///
+/// # Returns
+/// - Mask.
+const fn mask(count: u32) -> u64 {
+    (1 << count) - 1
+}
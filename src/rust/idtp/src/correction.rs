@@ -0,0 +1,372 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Single-bit error correction of `IDTP-S` (Safety mode) frames.
+//!
+//! `CRC-32-AUTOSAR` is linear, so XOR of computed & received checksums
+//! (syndrome) depends only on error pattern & its distance from the end of
+//! checked data. Syndromes of all single-bit errors within max frame size are
+//! distinct, so a syndrome-to-position table, built at compile time, locates
+//! a flipped bit with a single hash table lookup. Header `CRC-8` is checked
+//! again after correction to reject misdetected multi-bit errors.
+
+#[cfg(feature = "software_impl")]
+use crate::crypto;
+use crate::{
+    IDTP_HEADER_SIZE, IDTP_PAYLOAD_MAX_SIZE, IdtpError, IdtpFrame, IdtpHeader,
+    IdtpMode, IdtpResult,
+};
+use zerocopy::FromBytes;
+
+/// `CRC-32-AUTOSAR` polynomial in reflected form.
+const CRC32_POLYNOMIAL: u32 = 0xF4AC_FB13_u32.reverse_bits();
+
+/// Max number of bits covered by `CRC-32`.
+const MAX_DATA_BITS: usize = (IDTP_HEADER_SIZE + IDTP_PAYLOAD_MAX_SIZE) * 8;
+
+/// Number of syndrome table slots.
+const TABLE_SIZE: usize = 1 << 14;
+
+/// Size of `CRC-32` trailer in bytes.
+const TRAILER_SIZE: usize = IdtpFrame::trailer_size_from(IdtpMode::Safety);
+
+/// Syndrome-to-position table.
+static SYNDROMES: SyndromeTable = SyndromeTable::build();
+
+/// Result of successful correction.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Correction {
+    /// Frame is valid, nothing was corrected.
+    None,
+    /// Bit of header or payload was corrected.
+    Data {
+        /// Index of corrected bit, `byte * 8 + bit`.
+        bit: usize,
+    },
+    /// Bit of `CRC-32` trailer was corrected.
+    Trailer {
+        /// Index of corrected bit within trailer.
+        bit: usize,
+    },
+}
+
+/// Correction statistics.
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct CorrectionStats {
+    /// Number of valid frames.
+    pub valid: u64,
+    /// Number of corrected frames.
+    pub corrected: u64,
+    /// Number of frames with errors that could not be corrected.
+    pub uncorrectable: u64,
+}
+
+/// Validator of `IDTP-S` frames with single-bit error correction.
+#[derive(Debug, Default, Clone)]
+pub struct CrcCorrector {
+    /// Correction statistics.
+    stats: CorrectionStats,
+}
+
+impl CrcCorrector {
+    /// Construct new `CrcCorrector` object.
+    ///
+    /// # Returns
+    /// - New `CrcCorrector` object.
+    #[must_use]
+    pub const fn new() -> Self {
+        Self {
+            stats: CorrectionStats {
+                valid: 0,
+                corrected: 0,
+                uncorrectable: 0,
+            },
+        }
+    }
+
+    /// Get correction statistics.
+    ///
+    /// # Returns
+    /// - Correction statistics.
+    #[inline]
+    #[must_use]
+    pub const fn stats(&self) -> &CorrectionStats {
+        &self.stats
+    }
+
+    /// Validate `IDTP-S` frame & correct single-bit error in place.
+    /// `CRC` calculation is software-based.
+    ///
+    /// # Parameters
+    /// - `buffer` - given IDTP frame bytes.
+    ///
+    /// # Returns
+    /// - Applied correction - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Parse error - if frame is not `IDTP-S` frame.
+    /// - Invalid CRC - if error can not be corrected.
+    #[cfg(feature = "software_impl")]
+    pub fn check(&mut self, buffer: &mut [u8]) -> IdtpResult<Correction> {
+        self.check_with(buffer, crypto::sw_crc8, crypto::sw_crc32)
+    }
+
+    /// Validate `IDTP-S` frame & correct single-bit error in place with
+    /// custom `CRC` calculation.
+    ///
+    /// # Parameters
+    /// - `buffer` - given IDTP frame bytes.
+    /// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+    /// - `calc_crc32` - given closure with custom `CRC-32` calculation logic.
+    ///
+    /// # Returns
+    /// - Applied correction - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Parse error - if frame is not `IDTP-S` frame.
+    /// - Invalid CRC - if error can not be corrected.
+    pub fn check_with<C8, C32>(
+        &mut self,
+        buffer: &mut [u8],
+        calc_crc8: C8,
+        calc_crc32: C32,
+    ) -> IdtpResult<Correction>
+    where
+        C8: Fn(&[u8]) -> IdtpResult<u8>,
+        C32: FnOnce(&[u8]) -> IdtpResult<u32>,
+    {
+        let result = correct_with(buffer, calc_crc8, calc_crc32);
+
+        match result {
+            Ok(Correction::None) => self.stats.valid += 1,
+            Ok(_) => self.stats.corrected += 1,
+            Err(IdtpError::InvalidCrc) => self.stats.uncorrectable += 1,
+            Err(_) => {}
+        }
+
+        result
+    }
+}
+
+/// Validate `IDTP-S` frame & correct single-bit error in place.
+/// `CRC` calculation is software-based.
+///
+/// # Parameters
+/// - `buffer` - given IDTP frame bytes.
+///
+/// # Returns
+/// - Applied correction - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer underflow.
+/// - Parse error - if frame is not `IDTP-S` frame.
+/// - Invalid CRC - if error can not be corrected.
+#[cfg(feature = "software_impl")]
+pub fn correct(buffer: &mut [u8]) -> IdtpResult<Correction> {
+    correct_with(buffer, crypto::sw_crc8, crypto::sw_crc32)
+}
+
+/// Validate `IDTP-S` frame & correct single-bit error in place with custom
+/// `CRC` calculation. Frame size is taken from header, so errors in
+/// `payload_size` & `mode` fields can not be corrected.
+///
+/// # Parameters
+/// - `buffer` - given IDTP frame bytes.
+/// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+/// - `calc_crc32` - given closure with custom `CRC-32` calculation logic.
+///
+/// # Returns
+/// - Applied correction - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer underflow.
+/// - Parse error - if frame is not `IDTP-S` frame.
+/// - Invalid CRC - if error can not be corrected.
+pub fn correct_with<C8, C32>(
+    buffer: &mut [u8],
+    calc_crc8: C8,
+    calc_crc32: C32,
+) -> IdtpResult<Correction>
+where
+    C8: Fn(&[u8]) -> IdtpResult<u8>,
+    C32: FnOnce(&[u8]) -> IdtpResult<u32>,
+{
+    let (header, _) = IdtpHeader::read_from_prefix(buffer)
+        .map_err(|_| IdtpError::BufferUnderflow)?;
+
+    if !matches!(IdtpMode::try_from(header.mode), Ok(IdtpMode::Safety)) {
+        return Err(IdtpError::ParseError);
+    }
+
+    let data_size = IDTP_HEADER_SIZE + usize::from(header.payload_size);
+    let frame_size = data_size + TRAILER_SIZE;
+    let received = u32::from_le_bytes(
+        buffer
+            .get(data_size..frame_size)
+            .ok_or(IdtpError::BufferUnderflow)?
+            .try_into()
+            .map_err(|_| IdtpError::ParseError)?,
+    );
+    let computed =
+        calc_crc32(buffer.get(..data_size).ok_or(IdtpError::BufferUnderflow)?)?;
+    let syndrome = computed ^ received;
+
+    let (correction, flipped) = if syndrome == 0 {
+        (Correction::None, None)
+    } else if syndrome.is_power_of_two() {
+        let bit = syndrome.trailing_zeros() as usize;
+        (Correction::Trailer { bit }, Some(data_size * 8 + bit))
+    } else {
+        let distance =
+            SYNDROMES.lookup(syndrome).ok_or(IdtpError::InvalidCrc)?;
+        let bit = (data_size * 8)
+            .checked_sub(distance + 1)
+            .ok_or(IdtpError::InvalidCrc)?;
+        (Correction::Data { bit }, Some(bit))
+    };
+
+    if let Some(bit) = flipped {
+        flip(buffer, bit)?;
+    }
+
+    // Multi-bit error may look like single-bit error in other position.
+    if !is_header_valid(buffer, &calc_crc8)? {
+        if let Some(bit) = flipped {
+            flip(buffer, bit)?;
+        }
+
+        return Err(IdtpError::InvalidCrc);
+    }
+
+    Ok(correction)
+}
+
+/// Check header `CRC-8`.
+///
+/// # Parameters
+/// - `buffer` - given IDTP frame bytes.
+/// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+///
+/// # Returns
+/// - `true` - if header `CRC-8` is valid.
+/// - `false` - otherwise.
+///
+/// # Errors
+/// - Buffer underflow.
+fn is_header_valid<C8>(buffer: &[u8], calc_crc8: &C8) -> IdtpResult<bool>
+where
+    C8: Fn(&[u8]) -> IdtpResult<u8>,
+{
+    let data = buffer
+        .get(..IDTP_HEADER_SIZE - 1)
+        .ok_or(IdtpError::BufferUnderflow)?;
+    let received = buffer
+        .get(IDTP_HEADER_SIZE - 1)
+        .ok_or(IdtpError::BufferUnderflow)?;
+
+    Ok(calc_crc8(data)? == *received)
+}
+
+/// Flip bit of buffer. Bits are numbered in `CRC` processing order: least
+/// significant bit of each byte first.
+///
+/// # Parameters
+/// - `buffer` - given buffer to handle.
+/// - `bit` - given bit index.
+///
+/// # Errors
+/// - Buffer underflow.
+fn flip(buffer: &mut [u8], bit: usize) -> IdtpResult<()> {
+    *buffer.get_mut(bit / 8).ok_or(IdtpError::BufferUnderflow)? ^=
+        1 << (bit % 8);
+    Ok(())
+}
+
+/// Open addressing hash table from single-bit error syndrome to distance of
+/// flipped bit from the end of checked data.
+struct SyndromeTable {
+    /// Syndromes.
+    keys: [u32; TABLE_SIZE],
+    /// Distance + 1 or 0 if slot is free.
+    distances: [u16; TABLE_SIZE],
+}
+
+impl SyndromeTable {
+    /// Build syndrome table.
+    ///
+    /// # Returns
+    /// - Syndrome table.
+    #[allow(
+        clippy::indexing_slicing,
+        clippy::cast_possible_truncation,
+        clippy::large_stack_arrays
+    )]
+    const fn build() -> Self {
+        let mut table = Self {
+            keys: [0; TABLE_SIZE],
+            distances: [0; TABLE_SIZE],
+        };
+        // Syndrome of error followed by `distance` zero bits.
+        let mut syndrome = CRC32_POLYNOMIAL;
+        let mut distance = 0;
+
+        while distance < MAX_DATA_BITS {
+            assert!(
+                !syndrome.is_power_of_two(),
+                "syndrome collides with trailer error"
+            );
+
+            let mut slot = syndrome as usize % TABLE_SIZE;
+
+            while table.distances[slot] != 0 {
+                assert!(table.keys[slot] != syndrome, "syndrome collision");
+                slot = (slot + 1) % TABLE_SIZE;
+            }
+
+            table.keys[slot] = syndrome;
+            table.distances[slot] = distance as u16 + 1;
+
+            syndrome = if syndrome & 1 == 0 {
+                syndrome >> 1
+            } else {
+                (syndrome >> 1) ^ CRC32_POLYNOMIAL
+            };
+            distance += 1;
+        }
+
+        table
+    }
+
+    /// Find distance of flipped bit by syndrome.
+    ///
+    /// # Parameters
+    /// - `syndrome` - given syndrome.
+    ///
+    /// # Returns
+    /// - Distance of flipped bit from the end of checked data - if syndrome
+    ///   belongs to single-bit error.
+    /// - `None` - otherwise.
+    fn lookup(&self, syndrome: u32) -> Option<usize> {
+        let mut slot = syndrome as usize % TABLE_SIZE;
+
+        loop {
+            let distance = *self.distances.get(slot)?;
+
+            if distance == 0 {
+                return None;
+            }
+
+            if *self.keys.get(slot)? == syndrome {
+                return Some(usize::from(distance - 1));
+            }
+
+            slot = (slot + 1) % TABLE_SIZE;
+        }
+    }
+}
@@ -3,7 +3,11 @@
 
 //! Cryptographic and checksum calculating algorithms wrappers.
 
-use crate::{IdtpError, IdtpResult};
+#[cfg(feature = "software_impl")]
+use crate::{IDTP_HEADER_SIZE, IdtpHeader};
+use crate::{IdtpError, IdtpMode, IdtpResult, TrailerDigest, trailer_eq};
+#[cfg(feature = "software_impl")]
+use zerocopy::FromBytes;
 
 #[cfg(feature = "software_impl")]
 use crc::{CRC_8_AUTOSAR, CRC_32_AUTOSAR, Crc};
@@ -12,6 +16,74 @@ use hmac::{Hmac, Mac};
 #[cfg(feature = "software_impl")]
 use sha2::Sha256;
 
+/// `BLAKE2s` initialisation vector.
+#[cfg(feature = "software_impl")]
+const BLAKE2S_IV: [u32; 8] = [
+    0x6A09_E667,
+    0xBB67_AE85,
+    0x3C6E_F372,
+    0xA54F_F53A,
+    0x510E_527F,
+    0x9B05_688C,
+    0x1F83_D9AB,
+    0x5BE0_CD19,
+];
+
+/// `BLAKE2s` message word permutations of each round.
+#[cfg(feature = "software_impl")]
+const BLAKE2S_SIGMA: [[usize; 16]; 10] = [
+    [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15],
+    [14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3],
+    [11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4],
+    [7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8],
+    [9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13],
+    [2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9],
+    [12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11],
+    [13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10],
+    [6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5],
+    [10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0],
+];
+
+/// `BLAKE2s` block size in bytes.
+#[cfg(feature = "software_impl")]
+const BLAKE2S_BLOCK_SIZE: usize = 64;
+
+/// Max size of `BLAKE2s` key in bytes.
+#[cfg(feature = "software_impl")]
+pub const BLAKE2S_KEY_MAX_SIZE: usize = 32;
+
+/// `SHA-256` initial hash value, the same as `BLAKE2s` initialisation vector.
+#[cfg(feature = "software_impl")]
+const SHA256_IV: [u32; 8] = BLAKE2S_IV;
+
+/// `SHA-256` block size in bytes.
+#[cfg(feature = "software_impl")]
+const SHA256_BLOCK_SIZE: usize = 64;
+
+/// Size of `IDTP-E` authentication tag in bytes.
+pub const AEAD_TAG_SIZE: usize = 16;
+
+/// `ChaCha20` constants: "expand 32-byte k".
+#[cfg(feature = "software_impl")]
+const CHACHA20_CONSTANTS: [u32; 4] =
+    [0x6170_7865, 0x3320_646E, 0x7962_2D32, 0x6B20_6574];
+
+/// `ChaCha20` block size in bytes.
+#[cfg(feature = "software_impl")]
+const CHACHA20_BLOCK_SIZE: usize = 64;
+
+/// Number of `ChaCha20` blocks generated at once.
+#[cfg(feature = "software_impl")]
+const CHACHA20_LANES: usize = 4;
+
+/// `Poly1305` block size in bytes.
+#[cfg(feature = "software_impl")]
+const POLY1305_BLOCK_SIZE: usize = 16;
+
+/// Software-based `CRC-32` calculator.
+#[cfg(feature = "software_impl")]
+static CRC32: Crc<u32> = Crc::<u32>::new(&CRC_32_AUTOSAR);
+
 /// Closure for calculating software-based `CRC-8`.
 ///
 /// # Parameters
@@ -75,3 +147,1173 @@ pub fn sw_hmac_closure(
         Ok(out)
     }
 }
+
+/// Get closure for calculating software-based keyed `BLAKE2s-256`.
+///
+/// # Parameters
+/// - `key` - given `BLAKE2s` key.
+///
+/// # Returns
+/// - Closure for calculating software-based keyed `BLAKE2s-256`.
+///
+/// # Errors
+/// - Invalid HMAC key - if key is missing, empty or longer than 32 bytes.
+#[cfg(feature = "software_impl")]
+pub fn sw_blake2s_closure(
+    key: Option<&[u8]>,
+) -> impl FnOnce(&[u8]) -> IdtpResult<[u8; 32]> + '_ {
+    move |data: &[u8]| {
+        let mut mac = Blake2s::new_keyed(key)?;
+        mac.update(data)?;
+        mac.finalize()
+    }
+}
+
+/// Get closure for calculating software-based `MAC` of keyed mode:
+/// `HMAC-SHA256` for `IDTP-SEC`, keyed `BLAKE2s-256` for `IDTP-SF` &
+/// `Poly1305` tag for `IDTP-E`.
+///
+/// # Parameters
+/// - `mode` - given IDTP mode to handle.
+/// - `key` - given `MAC` key.
+///
+/// # Returns
+/// - Closure for calculating software-based `MAC`.
+///
+/// # Errors
+/// - Invalid HMAC key.
+#[cfg(feature = "software_impl")]
+pub fn sw_mac_closure(
+    mode: Option<IdtpMode>,
+    key: Option<&[u8]>,
+) -> impl FnOnce(&[u8]) -> IdtpResult<[u8; 32]> + '_ {
+    move |data: &[u8]| match mode {
+        Some(IdtpMode::SecureFast) => sw_blake2s_closure(key)(data),
+        Some(IdtpMode::Encrypted) => sw_aead_tag_closure(key)(data),
+        _ => sw_hmac_closure(key)(data),
+    }
+}
+
+/// Precomputed `HMAC-SHA256` state of key: `SHA-256` chained states after
+/// the inner & outer padded key blocks. Saves two block compressions & key
+/// padding per `MAC`.
+#[cfg(feature = "software_impl")]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct HmacMidstate {
+    /// Chained state after the inner padded key block.
+    pub inner: [u32; 8],
+    /// Chained state after the outer padded key block.
+    pub outer: [u32; 8],
+}
+
+#[cfg(feature = "software_impl")]
+impl HmacMidstate {
+    /// Construct new `HmacMidstate` object.
+    ///
+    /// # Parameters
+    /// - `key` - given `HMAC` key.
+    ///
+    /// # Returns
+    /// - New `HmacMidstate` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Invalid HMAC key - if padded key does not fit into block.
+    pub fn new(key: &[u8]) -> IdtpResult<Self> {
+        let mut block = [0u8; SHA256_BLOCK_SIZE];
+
+        if key.len() > SHA256_BLOCK_SIZE {
+            let digest = <Sha256 as sha2::Digest>::digest(key);
+            block
+                .get_mut(..digest.len())
+                .ok_or(IdtpError::InvalidHMacKey)?
+                .copy_from_slice(&digest);
+        } else {
+            block
+                .get_mut(..key.len())
+                .ok_or(IdtpError::InvalidHMacKey)?
+                .copy_from_slice(key);
+        }
+
+        let padded = |pad: u8| {
+            let mut state = SHA256_IV;
+            sha256_compress(&mut state, &block.map(|byte| byte ^ pad));
+            state
+        };
+
+        Ok(Self {
+            inner: padded(0x36),
+            outer: padded(0x5C),
+        })
+    }
+
+    /// Calculate `HMAC-SHA256`.
+    ///
+    /// # Parameters
+    /// - `data` - given data to handle.
+    ///
+    /// # Returns
+    /// - `HMAC-SHA256` value.
+    #[must_use]
+    pub fn mac(&self, data: &[u8]) -> [u8; 32] {
+        let inner = sha256_finish(self.inner, SHA256_BLOCK_SIZE as u64, data);
+        sha256_finish(self.outer, SHA256_BLOCK_SIZE as u64, &inner)
+    }
+}
+
+/// Incremental `HMAC-SHA256` starting from precomputed key midstates.
+#[cfg(feature = "software_impl")]
+#[derive(Debug, Clone)]
+pub struct HmacMidstateDigest {
+    /// Chained state after the outer padded key block.
+    outer: [u32; 8],
+    /// Inner chained state.
+    inner: [u32; 8],
+    /// Number of compressed bytes, including the inner padded key block.
+    counter: u64,
+    /// Pending block.
+    block: [u8; SHA256_BLOCK_SIZE],
+    /// Number of bytes in pending block.
+    len: usize,
+}
+
+#[cfg(feature = "software_impl")]
+impl HmacMidstateDigest {
+    /// Construct new `HmacMidstateDigest` object.
+    ///
+    /// # Parameters
+    /// - `midstate` - given precomputed key midstates.
+    ///
+    /// # Returns
+    /// - New `HmacMidstateDigest` object.
+    #[must_use]
+    pub const fn new(midstate: &HmacMidstate) -> Self {
+        Self {
+            outer: midstate.outer,
+            inner: midstate.inner,
+            counter: SHA256_BLOCK_SIZE as u64,
+            block: [0; SHA256_BLOCK_SIZE],
+            len: 0,
+        }
+    }
+
+    /// Update `MAC` with data.
+    ///
+    /// # Parameters
+    /// - `data` - given data to handle.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if pending block is out of bounds.
+    pub fn update(&mut self, mut data: &[u8]) -> IdtpResult<()> {
+        if self.len > 0 {
+            let count = (SHA256_BLOCK_SIZE - self.len).min(data.len());
+            let (head, rest) = data.split_at(count);
+
+            self.block
+                .get_mut(self.len..self.len + count)
+                .ok_or(IdtpError::BufferOverflow)?
+                .copy_from_slice(head);
+            self.len += count;
+            data = rest;
+
+            if self.len < SHA256_BLOCK_SIZE {
+                return Ok(());
+            }
+
+            sha256_compress(&mut self.inner, &self.block);
+            self.counter += SHA256_BLOCK_SIZE as u64;
+            self.len = 0;
+        }
+
+        let (blocks, rest) = data.as_chunks::<SHA256_BLOCK_SIZE>();
+
+        for block in blocks {
+            sha256_compress(&mut self.inner, block);
+            self.counter += SHA256_BLOCK_SIZE as u64;
+        }
+
+        self.block
+            .get_mut(..rest.len())
+            .ok_or(IdtpError::BufferOverflow)?
+            .copy_from_slice(rest);
+        self.len = rest.len();
+
+        Ok(())
+    }
+
+    /// Finalize `MAC`.
+    ///
+    /// # Returns
+    /// - `HMAC-SHA256` value - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if pending block is out of bounds.
+    pub fn finalize(self) -> IdtpResult<[u8; 32]> {
+        let pending = self
+            .block
+            .get(..self.len)
+            .ok_or(IdtpError::BufferOverflow)?;
+        let inner = sha256_finish(self.inner, self.counter, pending);
+
+        Ok(sha256_finish(self.outer, SHA256_BLOCK_SIZE as u64, &inner))
+    }
+}
+
+/// Compress single `SHA-256` block.
+///
+/// # Parameters
+/// - `state` - given chained state.
+/// - `block` - given block to handle.
+#[cfg(feature = "software_impl")]
+fn sha256_compress(state: &mut [u32; 8], block: &[u8; SHA256_BLOCK_SIZE]) {
+    sha2::compress256(
+        state,
+        &[sha2::digest::generic_array::GenericArray::clone_from_slice(
+            block,
+        )],
+    );
+}
+
+/// Finish `SHA-256` of data that follows already compressed blocks.
+///
+/// # Parameters
+/// - `state` - given chained state after compressed blocks.
+/// - `compressed` - given number of compressed bytes.
+/// - `data` - given rest of data.
+///
+/// # Returns
+/// - `SHA-256` value.
+#[cfg(feature = "software_impl")]
+#[allow(clippy::indexing_slicing)]
+fn sha256_finish(
+    mut state: [u32; 8],
+    compressed: u64,
+    data: &[u8],
+) -> [u8; 32] {
+    let (blocks, rest) = data.as_chunks::<SHA256_BLOCK_SIZE>();
+
+    for block in blocks {
+        sha256_compress(&mut state, block);
+    }
+
+    // Padding: 0x80, zeros & message length in bits, 1 or 2 blocks.
+    let mut tail = [0u8; SHA256_BLOCK_SIZE * 2];
+    tail[..rest.len()].copy_from_slice(rest);
+    tail[rest.len()] = 0x80;
+
+    let tail_size = if rest.len() < SHA256_BLOCK_SIZE - 8 {
+        SHA256_BLOCK_SIZE
+    } else {
+        SHA256_BLOCK_SIZE * 2
+    };
+    let bits = (compressed + data.len() as u64) * 8;
+    tail[tail_size - 8..tail_size].copy_from_slice(&bits.to_be_bytes());
+
+    for block in tail[..tail_size].as_chunks::<SHA256_BLOCK_SIZE>().0 {
+        sha256_compress(&mut state, block);
+    }
+
+    let mut digest = [0u8; 32];
+    for (bytes, word) in digest.chunks_exact_mut(4).zip(state) {
+        bytes.copy_from_slice(&word.to_be_bytes());
+    }
+
+    digest
+}
+
+/// Software-based keyed `BLAKE2s-256` (RFC 7693).
+#[cfg(feature = "software_impl")]
+#[derive(Clone)]
+pub struct Blake2s {
+    /// Chained state.
+    state: [u32; 8],
+    /// Number of compressed bytes.
+    counter: u64,
+    /// Pending block.
+    block: [u8; BLAKE2S_BLOCK_SIZE],
+    /// Number of bytes in pending block.
+    len: usize,
+}
+
+#[cfg(feature = "software_impl")]
+impl Blake2s {
+    /// Construct new keyed `Blake2s` object with 32-byte digest.
+    ///
+    /// # Parameters
+    /// - `key` - given `BLAKE2s` key.
+    ///
+    /// # Returns
+    /// - New `Blake2s` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Invalid HMAC key - if key is missing, empty or longer than 32 bytes.
+    #[allow(clippy::cast_possible_truncation)]
+    pub fn new_keyed(key: Option<&[u8]>) -> IdtpResult<Self> {
+        let key = key
+            .filter(|key| (1..=BLAKE2S_KEY_MAX_SIZE).contains(&key.len()))
+            .ok_or(IdtpError::InvalidHMacKey)?;
+
+        let mut state = BLAKE2S_IV;
+        // Parameter block: digest size, key size, fanout & depth of 1.
+        state[0] ^= 0x0101_0000 ^ ((key.len() as u32) << 8) ^ 32;
+
+        // Key is processed as the first (padded) block.
+        let mut block = [0; BLAKE2S_BLOCK_SIZE];
+        block
+            .get_mut(..key.len())
+            .ok_or(IdtpError::InvalidHMacKey)?
+            .copy_from_slice(key);
+
+        Ok(Self {
+            state,
+            counter: 0,
+            block,
+            len: BLAKE2S_BLOCK_SIZE,
+        })
+    }
+
+    /// Get chained state after the key block. Valid as a starting point only
+    /// for non-empty data, which is always the case for IDTP frames.
+    ///
+    /// # Parameters
+    /// - `key` - given `BLAKE2s` key.
+    ///
+    /// # Returns
+    /// - Chained state - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Invalid HMAC key - if key is missing, empty or longer than 32 bytes.
+    pub(crate) fn keyed_midstate(key: Option<&[u8]>) -> IdtpResult<[u32; 8]> {
+        let mut digest = Self::new_keyed(key)?;
+        digest.counter = BLAKE2S_BLOCK_SIZE as u64;
+        digest.compress(false);
+        Ok(digest.state)
+    }
+
+    /// Construct `Blake2s` object from chained state after the key block.
+    ///
+    /// # Parameters
+    /// - `state` - given state from `keyed_midstate`.
+    ///
+    /// # Returns
+    /// - New `Blake2s` object.
+    pub(crate) const fn from_midstate(state: [u32; 8]) -> Self {
+        Self {
+            state,
+            counter: BLAKE2S_BLOCK_SIZE as u64,
+            block: [0; BLAKE2S_BLOCK_SIZE],
+            len: 0,
+        }
+    }
+
+    /// Update digest with data.
+    ///
+    /// # Parameters
+    /// - `data` - given data to handle.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if pending block is out of bounds.
+    pub fn update(&mut self, mut data: &[u8]) -> IdtpResult<()> {
+        while !data.is_empty() {
+            // The last block is compressed on finalization.
+            if self.len == BLAKE2S_BLOCK_SIZE {
+                self.counter += BLAKE2S_BLOCK_SIZE as u64;
+                self.compress(false);
+                self.len = 0;
+            }
+
+            let count = (BLAKE2S_BLOCK_SIZE - self.len).min(data.len());
+            let (head, rest) = data.split_at(count);
+
+            self.block
+                .get_mut(self.len..self.len + count)
+                .ok_or(IdtpError::BufferOverflow)?
+                .copy_from_slice(head);
+            self.len += count;
+            data = rest;
+        }
+
+        Ok(())
+    }
+
+    /// Finalize digest.
+    ///
+    /// # Returns
+    /// - 32-byte digest - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if pending block is out of bounds.
+    pub fn finalize(mut self) -> IdtpResult<[u8; 32]> {
+        self.counter += self.len as u64;
+        self.block
+            .get_mut(self.len..)
+            .ok_or(IdtpError::BufferOverflow)?
+            .fill(0);
+        self.compress(true);
+
+        let mut digest = [0; 32];
+        for (bytes, word) in digest.chunks_exact_mut(4).zip(self.state) {
+            bytes.copy_from_slice(&word.to_le_bytes());
+        }
+
+        Ok(digest)
+    }
+
+    /// Compress pending block.
+    ///
+    /// # Parameters
+    /// - `last` - given flag of the last block.
+    #[allow(clippy::indexing_slicing, clippy::cast_possible_truncation)]
+    fn compress(&mut self, last: bool) {
+        let mut message = [0u32; 16];
+        for (word, bytes) in message.iter_mut().zip(self.block.chunks_exact(4))
+        {
+            *word =
+                u32::from_le_bytes([bytes[0], bytes[1], bytes[2], bytes[3]]);
+        }
+
+        let mut v = [0u32; 16];
+        v[..8].copy_from_slice(&self.state);
+        v[8..].copy_from_slice(&BLAKE2S_IV);
+        v[12] ^= self.counter as u32;
+        v[13] ^= (self.counter >> 32) as u32;
+        if last {
+            v[14] = !v[14];
+        }
+
+        for sigma in &BLAKE2S_SIGMA {
+            let m = |index: usize| message[sigma[index]];
+
+            blake2s_g(&mut v, [0, 4, 8, 12], m(0), m(1));
+            blake2s_g(&mut v, [1, 5, 9, 13], m(2), m(3));
+            blake2s_g(&mut v, [2, 6, 10, 14], m(4), m(5));
+            blake2s_g(&mut v, [3, 7, 11, 15], m(6), m(7));
+            blake2s_g(&mut v, [0, 5, 10, 15], m(8), m(9));
+            blake2s_g(&mut v, [1, 6, 11, 12], m(10), m(11));
+            blake2s_g(&mut v, [2, 7, 8, 13], m(12), m(13));
+            blake2s_g(&mut v, [3, 4, 9, 14], m(14), m(15));
+        }
+
+        for (index, word) in self.state.iter_mut().enumerate() {
+            *word ^= v[index] ^ v[index + 8];
+        }
+    }
+}
+
+/// `BLAKE2s` mixing function.
+///
+/// # Parameters
+/// - `work` - given working vector.
+/// - `indices` - given indices of mixed words.
+/// - `first` - given the first message word.
+/// - `second` - given the second message word.
+#[cfg(feature = "software_impl")]
+#[inline]
+#[allow(clippy::indexing_slicing)]
+const fn blake2s_g(
+    work: &mut [u32; 16],
+    indices: [usize; 4],
+    first: u32,
+    second: u32,
+) {
+    let [a, b, c, d] = indices;
+
+    work[a] = work[a].wrapping_add(work[b]).wrapping_add(first);
+    work[d] = (work[d] ^ work[a]).rotate_right(16);
+    work[c] = work[c].wrapping_add(work[d]);
+    work[b] = (work[b] ^ work[c]).rotate_right(12);
+    work[a] = work[a].wrapping_add(work[b]).wrapping_add(second);
+    work[d] = (work[d] ^ work[a]).rotate_right(8);
+    work[c] = work[c].wrapping_add(work[d]);
+    work[b] = (work[b] ^ work[c]).rotate_right(7);
+}
+
+/// Get closure for in-place `ChaCha20-Poly1305` encryption of `IDTP-E`
+/// frame payload.
+///
+/// # Parameters
+/// - `key` - given 32-byte key.
+///
+/// # Returns
+/// - Closure that encrypts payload in place & returns `Poly1305` tag over
+///   header & ciphertext.
+///
+/// # Errors
+/// - Invalid HMAC key - if key is missing or is not 32 bytes long.
+/// - Buffer underflow - if header is truncated.
+#[cfg(feature = "software_impl")]
+pub fn sw_seal_closure(
+    key: Option<&[u8]>,
+) -> impl FnOnce(&[u8], &mut [u8]) -> IdtpResult<[u8; AEAD_TAG_SIZE]> + '_ {
+    move |header: &[u8], payload: &mut [u8]| {
+        let key = aead_key(key)?;
+        let nonce = frame_nonce(header)?;
+
+        chacha20_xor(&key, &nonce, 1, payload);
+        aead_tag(&key, &nonce, header, payload)
+    }
+}
+
+/// Get closure for in-place `ChaCha20-Poly1305` decryption of `IDTP-E`
+/// frame payload.
+///
+/// # Parameters
+/// - `key` - given 32-byte key.
+///
+/// # Returns
+/// - Closure that checks `Poly1305` tag & decrypts payload in place.
+///
+/// # Errors
+/// - Invalid HMAC key - if key is missing or is not 32 bytes long.
+/// - Invalid HMAC - if tag does not match, payload is left untouched.
+/// - Buffer underflow - if header is truncated.
+#[cfg(feature = "software_impl")]
+pub fn sw_open_closure(
+    key: Option<&[u8]>,
+) -> impl FnOnce(&[u8], &mut [u8], &[u8]) -> IdtpResult<()> + '_ {
+    move |header: &[u8], payload: &mut [u8], tag: &[u8]| {
+        let key = aead_key(key)?;
+        let nonce = frame_nonce(header)?;
+        let computed = aead_tag(&key, &nonce, header, payload)?;
+
+        if !trailer_eq(&computed, tag) {
+            return Err(IdtpError::InvalidHMac);
+        }
+
+        chacha20_xor(&key, &nonce, 1, payload);
+        Ok(())
+    }
+}
+
+/// Get closure for calculating `Poly1305` tag of `IDTP-E` frame without
+/// decryption. Tag is stored in the first 16 bytes of result.
+///
+/// # Parameters
+/// - `key` - given 32-byte key.
+///
+/// # Returns
+/// - Closure for calculating tag over header & ciphertext.
+///
+/// # Errors
+/// - Invalid HMAC key - if key is missing or is not 32 bytes long.
+/// - Buffer underflow - if header is truncated.
+#[cfg(feature = "software_impl")]
+pub fn sw_aead_tag_closure(
+    key: Option<&[u8]>,
+) -> impl FnOnce(&[u8]) -> IdtpResult<[u8; 32]> + '_ {
+    move |data: &[u8]| {
+        let key = aead_key(key)?;
+        let (header, payload) = data
+            .split_at_checked(IDTP_HEADER_SIZE)
+            .ok_or(IdtpError::BufferUnderflow)?;
+        let nonce = frame_nonce(header)?;
+
+        let mut out = [0u8; 32];
+        out.get_mut(..AEAD_TAG_SIZE)
+            .ok_or(IdtpError::BufferOverflow)?
+            .copy_from_slice(&aead_tag(&key, &nonce, header, payload)?);
+
+        Ok(out)
+    }
+}
+
+/// Encrypt or decrypt data in place with `ChaCha20` (RFC 8439). Blocks are
+/// generated `CHACHA20_LANES` at a time in lane-interleaved layout, so
+/// rounds are auto-vectorised.
+///
+/// # Parameters
+/// - `key` - given 32-byte key.
+/// - `nonce` - given 12-byte nonce.
+/// - `counter` - given initial block counter.
+/// - `data` - given data to handle.
+#[cfg(feature = "software_impl")]
+#[allow(clippy::cast_possible_truncation)]
+pub fn chacha20_xor(
+    key: &[u8; 32],
+    nonce: &[u8; 12],
+    counter: u32,
+    data: &mut [u8],
+) {
+    let mut state = [0u32; 16];
+    let words = CHACHA20_CONSTANTS
+        .iter()
+        .copied()
+        .chain(key.chunks_exact(4).map(le_u32))
+        .chain(core::iter::once(counter))
+        .chain(nonce.chunks_exact(4).map(le_u32));
+
+    for (slot, word) in state.iter_mut().zip(words) {
+        *slot = word;
+    }
+
+    let mut keystream = [0u8; CHACHA20_BLOCK_SIZE * CHACHA20_LANES];
+
+    for chunk in data.chunks_mut(keystream.len()) {
+        chacha20_blocks(&state, &mut keystream);
+
+        for (byte, key) in chunk.iter_mut().zip(&keystream) {
+            *byte ^= key;
+        }
+
+        state[12] = state[12].wrapping_add(CHACHA20_LANES as u32);
+    }
+}
+
+/// Software-based `Poly1305` one-time authenticator (RFC 8439).
+#[cfg(feature = "software_impl")]
+#[derive(Clone)]
+pub struct Poly1305 {
+    /// Clamped key part `r` in 26-bit limbs.
+    r: [u32; 5],
+    /// Key part `s`.
+    s: [u32; 4],
+    /// Accumulator in 26-bit limbs.
+    h: [u32; 5],
+    /// Pending block.
+    block: [u8; POLY1305_BLOCK_SIZE],
+    /// Number of bytes in pending block.
+    len: usize,
+}
+
+#[cfg(feature = "software_impl")]
+impl Poly1305 {
+    /// Construct new `Poly1305` object.
+    ///
+    /// # Parameters
+    /// - `key` - given 32-byte one-time key.
+    ///
+    /// # Returns
+    /// - New `Poly1305` object.
+    #[must_use]
+    pub fn new(key: &[u8; 32]) -> Self {
+        let word = |offset: usize| {
+            key.get(offset..offset + 4).map(le_u32).unwrap_or_default()
+        };
+
+        Self {
+            r: [
+                word(0) & 0x03FF_FFFF,
+                (word(3) >> 2) & 0x03FF_FF03,
+                (word(6) >> 4) & 0x03FF_C0FF,
+                (word(9) >> 6) & 0x03F0_3FFF,
+                (word(12) >> 8) & 0x000F_FFFF,
+            ],
+            s: [word(16), word(20), word(24), word(28)],
+            h: [0; 5],
+            block: [0; POLY1305_BLOCK_SIZE],
+            len: 0,
+        }
+    }
+
+    /// Update tag with data.
+    ///
+    /// # Parameters
+    /// - `data` - given data to handle.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if pending block is out of bounds.
+    pub fn update(&mut self, mut data: &[u8]) -> IdtpResult<()> {
+        if self.len > 0 {
+            let count = (POLY1305_BLOCK_SIZE - self.len).min(data.len());
+            let (head, rest) = data.split_at(count);
+
+            self.block
+                .get_mut(self.len..self.len + count)
+                .ok_or(IdtpError::BufferOverflow)?
+                .copy_from_slice(head);
+            self.len += count;
+            data = rest;
+
+            if self.len < POLY1305_BLOCK_SIZE {
+                return Ok(());
+            }
+
+            let block = self.block;
+            self.process(&block, 1 << 24);
+            self.len = 0;
+        }
+
+        let (blocks, rest) = data.as_chunks::<POLY1305_BLOCK_SIZE>();
+
+        for block in blocks {
+            self.process(block, 1 << 24);
+        }
+
+        self.block
+            .get_mut(..rest.len())
+            .ok_or(IdtpError::BufferOverflow)?
+            .copy_from_slice(rest);
+        self.len = rest.len();
+
+        Ok(())
+    }
+
+    /// Pad data with zeros to the block boundary.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if pending block is out of bounds.
+    pub fn pad(&mut self) -> IdtpResult<()> {
+        if self.len > 0 {
+            let zeros = [0; POLY1305_BLOCK_SIZE];
+            self.update(
+                zeros.get(self.len..).ok_or(IdtpError::BufferOverflow)?,
+            )?;
+        }
+
+        Ok(())
+    }
+
+    /// Finalize tag.
+    ///
+    /// # Returns
+    /// - 16-byte tag - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if pending block is out of bounds.
+    #[allow(clippy::cast_possible_truncation)]
+    pub fn finalize(mut self) -> IdtpResult<[u8; AEAD_TAG_SIZE]> {
+        if self.len > 0 {
+            let pending = self
+                .block
+                .get(..self.len)
+                .ok_or(IdtpError::BufferOverflow)?;
+            let mut block = [0u8; POLY1305_BLOCK_SIZE];
+            block
+                .get_mut(..self.len)
+                .ok_or(IdtpError::BufferOverflow)?
+                .copy_from_slice(pending);
+            if let Some(byte) = block.get_mut(self.len) {
+                *byte = 1;
+            }
+            self.process(&block, 0);
+        }
+
+        let [mut h0, mut h1, mut h2, mut h3, mut h4] = self.h;
+
+        // Full carry.
+        h2 += h1 >> 26;
+        h1 &= 0x03FF_FFFF;
+        h3 += h2 >> 26;
+        h2 &= 0x03FF_FFFF;
+        h4 += h3 >> 26;
+        h3 &= 0x03FF_FFFF;
+        h0 += (h4 >> 26) * 5;
+        h4 &= 0x03FF_FFFF;
+        h1 += h0 >> 26;
+        h0 &= 0x03FF_FFFF;
+
+        // Compute h - p & select it if h >= p, in constant time.
+        let mut g0 = h0.wrapping_add(5);
+        let mut g1 = h1.wrapping_add(g0 >> 26);
+        g0 &= 0x03FF_FFFF;
+        let mut g2 = h2.wrapping_add(g1 >> 26);
+        g1 &= 0x03FF_FFFF;
+        let mut g3 = h3.wrapping_add(g2 >> 26);
+        g2 &= 0x03FF_FFFF;
+        let g4 = h4.wrapping_add(g3 >> 26).wrapping_sub(1 << 26);
+        g3 &= 0x03FF_FFFF;
+
+        let mask = (g4 >> 31).wrapping_sub(1);
+        h0 = (h0 & !mask) | (g0 & mask);
+        h1 = (h1 & !mask) | (g1 & mask);
+        h2 = (h2 & !mask) | (g2 & mask);
+        h3 = (h3 & !mask) | (g3 & mask);
+        h4 = (h4 & !mask) | (g4 & mask);
+
+        // Convert to 32-bit words & add s.
+        let words = [
+            h0 | (h1 << 26),
+            (h1 >> 6) | (h2 << 20),
+            (h2 >> 12) | (h3 << 14),
+            (h3 >> 18) | (h4 << 8),
+        ];
+
+        let mut tag = [0u8; AEAD_TAG_SIZE];
+        let mut carry = 0u64;
+
+        for ((bytes, word), s) in tag.chunks_exact_mut(4).zip(words).zip(self.s)
+        {
+            carry += u64::from(word) + u64::from(s);
+            bytes.copy_from_slice(&(carry as u32).to_le_bytes());
+            carry >>= 32;
+        }
+
+        Ok(tag)
+    }
+
+    /// Process single block.
+    ///
+    /// # Parameters
+    /// - `block` - given 16-byte block.
+    /// - `hibit` - given bit appended to the block (`2^128` in limb 4).
+    #[allow(clippy::cast_possible_truncation)]
+    fn process(&mut self, block: &[u8; POLY1305_BLOCK_SIZE], hibit: u32) {
+        let word = |offset: usize| {
+            block
+                .get(offset..offset + 4)
+                .map(le_u32)
+                .unwrap_or_default()
+        };
+        let [r0, r1, r2, r3, r4] = self.r.map(u64::from);
+        let [s1, s2, s3, s4] = [r1 * 5, r2 * 5, r3 * 5, r4 * 5];
+
+        let h0 = u64::from(self.h[0] + (word(0) & 0x03FF_FFFF));
+        let h1 = u64::from(self.h[1] + ((word(3) >> 2) & 0x03FF_FFFF));
+        let h2 = u64::from(self.h[2] + ((word(6) >> 4) & 0x03FF_FFFF));
+        let h3 = u64::from(self.h[3] + ((word(9) >> 6) & 0x03FF_FFFF));
+        let h4 = u64::from(self.h[4] + ((word(12) >> 8) | hibit));
+
+        let d0 = h0 * r0 + h1 * s4 + h2 * s3 + h3 * s2 + h4 * s1;
+        let d1 = h0 * r1 + h1 * r0 + h2 * s4 + h3 * s3 + h4 * s2;
+        let d2 = h0 * r2 + h1 * r1 + h2 * r0 + h3 * s4 + h4 * s3;
+        let d3 = h0 * r3 + h1 * r2 + h2 * r1 + h3 * r0 + h4 * s4;
+        let d4 = h0 * r4 + h1 * r3 + h2 * r2 + h3 * r1 + h4 * r0;
+
+        let d1 = d1 + (d0 >> 26);
+        let d2 = d2 + (d1 >> 26);
+        let d3 = d3 + (d2 >> 26);
+        let d4 = d4 + (d3 >> 26);
+        let h0 = (d0 & 0x03FF_FFFF) + (d4 >> 26) * 5;
+
+        self.h = [
+            (h0 & 0x03FF_FFFF) as u32,
+            (d1 & 0x03FF_FFFF) as u32 + (h0 >> 26) as u32,
+            (d2 & 0x03FF_FFFF) as u32,
+            (d3 & 0x03FF_FFFF) as u32,
+            (d4 & 0x03FF_FFFF) as u32,
+        ];
+    }
+}
+
+/// Check `IDTP-E` key.
+///
+/// # Parameters
+/// - `key` - given key.
+///
+/// # Returns
+/// - 32-byte key - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Invalid HMAC key - if key is missing or is not 32 bytes long.
+#[cfg(feature = "software_impl")]
+fn aead_key(key: Option<&[u8]>) -> IdtpResult<[u8; 32]> {
+    key.and_then(|key| key.try_into().ok())
+        .ok_or(IdtpError::InvalidHMacKey)
+}
+
+/// Build `IDTP-E` nonce from frame header: `device_id`, two zero bytes,
+/// `sequence` & `timestamp` in Little-Endian byte order.
+///
+/// Nonce repeats after device reset, so sender **MUST** use a fresh key for
+/// each boot.
+///
+/// # Parameters
+/// - `header` - given raw frame header.
+///
+/// # Returns
+/// - 12-byte nonce - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer underflow - if header is truncated.
+#[cfg(feature = "software_impl")]
+pub fn frame_nonce(header: &[u8]) -> IdtpResult<[u8; 12]> {
+    let (header, _) = IdtpHeader::read_from_prefix(header)
+        .map_err(|_| IdtpError::BufferUnderflow)?;
+
+    let mut nonce = [0u8; 12];
+    let parts = [
+        (0..2, &header.device_id.to_le_bytes()[..]),
+        (4..8, &header.sequence.to_le_bytes()[..]),
+        (8..12, &header.timestamp.to_le_bytes()[..]),
+    ];
+
+    for (range, bytes) in parts {
+        nonce
+            .get_mut(range)
+            .ok_or(IdtpError::BufferOverflow)?
+            .copy_from_slice(bytes);
+    }
+
+    Ok(nonce)
+}
+
+/// Calculate `ChaCha20-Poly1305` tag (RFC 8439) over header (additional
+/// data) & ciphertext.
+///
+/// # Parameters
+/// - `key` - given 32-byte key.
+/// - `nonce` - given 12-byte nonce.
+/// - `header` - given raw frame header.
+/// - `ciphertext` - given encrypted payload.
+///
+/// # Returns
+/// - 16-byte tag - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer overflow - if `Poly1305` pending block is out of bounds.
+#[cfg(feature = "software_impl")]
+fn aead_tag(
+    key: &[u8; 32],
+    nonce: &[u8; 12],
+    header: &[u8],
+    ciphertext: &[u8],
+) -> IdtpResult<[u8; AEAD_TAG_SIZE]> {
+    let mut one_time_key = [0u8; 32];
+    chacha20_xor(key, nonce, 0, &mut one_time_key);
+
+    let mut mac = Poly1305::new(&one_time_key);
+    mac.update(header)?;
+    mac.pad()?;
+    mac.update(ciphertext)?;
+    mac.pad()?;
+    mac.update(&(header.len() as u64).to_le_bytes())?;
+    mac.update(&(ciphertext.len() as u64).to_le_bytes())?;
+    mac.finalize()
+}
+
+/// Generate `CHACHA20_LANES` consecutive `ChaCha20` blocks.
+///
+/// # Parameters
+/// - `state` - given initial state of the first block.
+/// - `keystream` - given buffer to store keystream.
+#[cfg(feature = "software_impl")]
+#[allow(clippy::indexing_slicing, clippy::cast_possible_truncation)]
+fn chacha20_blocks(
+    state: &[u32; 16],
+    keystream: &mut [u8; CHACHA20_BLOCK_SIZE * CHACHA20_LANES],
+) {
+    let mut initial = [[0u32; CHACHA20_LANES]; 16];
+
+    for (lanes, word) in initial.iter_mut().zip(state) {
+        *lanes = [*word; CHACHA20_LANES];
+    }
+
+    for (lane, counter) in initial[12].iter_mut().enumerate() {
+        *counter = counter.wrapping_add(lane as u32);
+    }
+
+    let mut work = initial;
+
+    for _ in 0..10 {
+        chacha20_quarter_round(&mut work, [0, 4, 8, 12]);
+        chacha20_quarter_round(&mut work, [1, 5, 9, 13]);
+        chacha20_quarter_round(&mut work, [2, 6, 10, 14]);
+        chacha20_quarter_round(&mut work, [3, 7, 11, 15]);
+        chacha20_quarter_round(&mut work, [0, 5, 10, 15]);
+        chacha20_quarter_round(&mut work, [1, 6, 11, 12]);
+        chacha20_quarter_round(&mut work, [2, 7, 8, 13]);
+        chacha20_quarter_round(&mut work, [3, 4, 9, 14]);
+    }
+
+    for (index, (lanes, initial)) in work.iter().zip(&initial).enumerate() {
+        for (lane, (word, initial)) in lanes.iter().zip(initial).enumerate() {
+            let offset = lane * CHACHA20_BLOCK_SIZE + index * 4;
+            keystream[offset..offset + 4]
+                .copy_from_slice(&word.wrapping_add(*initial).to_le_bytes());
+        }
+    }
+}
+
+/// `ChaCha20` quarter round over all lanes.
+///
+/// # Parameters
+/// - `work` - given lane-interleaved working state.
+/// - `indices` - given indices of mixed words.
+#[cfg(feature = "software_impl")]
+#[inline]
+#[allow(clippy::indexing_slicing)]
+fn chacha20_quarter_round(
+    work: &mut [[u32; CHACHA20_LANES]; 16],
+    indices: [usize; 4],
+) {
+    let [a, b, c, d] = indices;
+
+    for lane in 0..CHACHA20_LANES {
+        work[a][lane] = work[a][lane].wrapping_add(work[b][lane]);
+        work[d][lane] = (work[d][lane] ^ work[a][lane]).rotate_left(16);
+        work[c][lane] = work[c][lane].wrapping_add(work[d][lane]);
+        work[b][lane] = (work[b][lane] ^ work[c][lane]).rotate_left(12);
+        work[a][lane] = work[a][lane].wrapping_add(work[b][lane]);
+        work[d][lane] = (work[d][lane] ^ work[a][lane]).rotate_left(8);
+        work[c][lane] = work[c][lane].wrapping_add(work[d][lane]);
+        work[b][lane] = (work[b][lane] ^ work[c][lane]).rotate_left(7);
+    }
+}
+
+/// Read Little-Endian `u32`.
+///
+/// # Parameters
+/// - `bytes` - given bytes, at least 4.
+///
+/// # Returns
+/// - Read value.
+#[cfg(feature = "software_impl")]
+fn le_u32(bytes: &[u8]) -> u32 {
+    u32::from_le_bytes(
+        bytes
+            .get(..4)
+            .and_then(|bytes| bytes.try_into().ok())
+            .unwrap_or_default(),
+    )
+}
+
+/// Software-based incremental frame trailer calculation.
+#[cfg(feature = "software_impl")]
+#[allow(clippy::large_enum_variant)]
+pub enum SwTrailerDigest {
+    /// `IDTP-L` - no trailer.
+    Lite,
+    /// `IDTP-S` - `CRC-32` trailer.
+    Safety(crc::Digest<'static, u32>),
+    /// `IDTP-SEC` - `HMAC-SHA256` trailer.
+    Secure(Hmac<Sha256>),
+    /// `IDTP-SF` - keyed `BLAKE2s-256` trailer.
+    SecureFast(Blake2s),
+}
+
+#[cfg(feature = "software_impl")]
+impl SwTrailerDigest {
+    /// Construct new `SwTrailerDigest` object.
+    ///
+    /// # Parameters
+    /// - `mode` - given IDTP mode to handle.
+    /// - `key` - given `HMAC` or `BLAKE2s` key.
+    ///
+    /// # Returns
+    /// - New `SwTrailerDigest` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Invalid HMAC key.
+    /// - Parse error - for `IDTP-E`, which can not be streamed.
+    pub fn new(mode: IdtpMode, key: Option<&[u8]>) -> IdtpResult<Self> {
+        match mode {
+            IdtpMode::Lite => Ok(Self::Lite),
+            IdtpMode::Safety => Ok(Self::Safety(CRC32.digest())),
+            IdtpMode::Secure => {
+                let k = key.ok_or(IdtpError::InvalidHMacKey)?;
+                let mac = Hmac::<Sha256>::new_from_slice(k)
+                    .map_err(|_| IdtpError::InvalidHMac)?;
+                Ok(Self::Secure(mac))
+            }
+            IdtpMode::SecureFast => {
+                Ok(Self::SecureFast(Blake2s::new_keyed(key)?))
+            }
+            // Payload must be encrypted before it is written.
+            IdtpMode::Encrypted => Err(IdtpError::ParseError),
+        }
+    }
+}
+
+#[cfg(feature = "software_impl")]
+impl TrailerDigest for SwTrailerDigest {
+    /// Update trailer calculation with frame data.
+    ///
+    /// # Parameters
+    /// - `data` - given data to handle.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if `BLAKE2s` pending block is out of bounds.
+    fn update(&mut self, data: &[u8]) -> IdtpResult<()> {
+        match self {
+            Self::Lite => {}
+            Self::Safety(digest) => digest.update(data),
+            Self::Secure(mac) => mac.update(data),
+            Self::SecureFast(mac) => mac.update(data)?,
+        }
+        Ok(())
+    }
+
+    /// Finalize trailer calculation.
+    ///
+    /// # Parameters
+    /// - `trailer` - given buffer to store frame trailer.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    fn finalize(self, trailer: &mut [u8]) -> IdtpResult<()> {
+        match self {
+            Self::Lite => Ok(()),
+            Self::Safety(digest) => {
+                let crc32 = digest.finalize().to_le_bytes();
+                trailer
+                    .get_mut(..crc32.len())
+                    .ok_or(IdtpError::BufferUnderflow)?
+                    .copy_from_slice(&crc32);
+                Ok(())
+            }
+            Self::Secure(mac) => {
+                let hmac = mac.finalize().into_bytes();
+                trailer
+                    .get_mut(..hmac.len())
+                    .ok_or(IdtpError::BufferUnderflow)?
+                    .copy_from_slice(&hmac);
+                Ok(())
+            }
+            Self::SecureFast(mac) => {
+                let digest = mac.finalize()?;
+                trailer
+                    .get_mut(..digest.len())
+                    .ok_or(IdtpError::BufferUnderflow)?
+                    .copy_from_slice(&digest);
+                Ok(())
+            }
+        }
+    }
+
+    /// Finalize trailer calculation directly into constant-time comparison
+    /// with received trailer.
+    ///
+    /// # Parameters
+    /// - `trailer` - given received frame trailer.
+    ///
+    /// # Errors
+    /// - Invalid CRC - if `CRC-32` trailer differs.
+    /// - Invalid HMAC - if `MAC` trailer differs.
+    fn verify(self, trailer: &[u8]) -> IdtpResult<()> {
+        match self {
+            Self::Lite => Ok(()),
+            Self::Safety(digest) => {
+                if digest.finalize().to_le_bytes() == trailer {
+                    Ok(())
+                } else {
+                    Err(IdtpError::InvalidCrc)
+                }
+            }
+            Self::Secure(mac) => mac
+                .verify_slice(trailer)
+                .map_err(|_| IdtpError::InvalidHMac),
+            Self::SecureFast(mac) => {
+                if trailer_eq(&mac.finalize()?, trailer) {
+                    Ok(())
+                } else {
+                    Err(IdtpError::InvalidHMac)
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,292 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Resynchronising IDTP frame decoder for byte streams.
+
+#[cfg(feature = "software_impl")]
+use crate::crypto;
+use crate::{
+    IDTP_FRAME_MAX_SIZE, IDTP_HEADER_SIZE, IDTP_PAYLOAD_MAX_SIZE,
+    IDTP_PREAMBLE, IdtpError, IdtpFrame, IdtpMode, IdtpResult,
+};
+
+/// Preamble in transmission (Little-Endian) byte order.
+const PREAMBLE_BYTES: [u8; 4] = IDTP_PREAMBLE.to_le_bytes();
+
+/// Offset of the header `payload_size` field.
+const PAYLOAD_SIZE_OFFSET: usize = 14;
+
+/// Offset of the header `mode` field.
+const MODE_OFFSET: usize = 17;
+
+/// Offset of the header `crc` field.
+const CRC_OFFSET: usize = 19;
+
+/// Decoder for IDTP frames received over a byte stream (UART, SPI, TCP etc.).
+///
+/// Incoming bytes are scanned for the preamble and every candidate header
+/// is checked with `CRC-8`. In case of mismatch decoder drops one byte and
+/// continues scanning from the next preamble candidate, as required by the
+/// specification. Frame trailer is not checked by decoder - complete frames
+/// **SHOULD** be validated by `IdtpFrame::validate` or
+/// `IdtpFrame::validate_with`.
+#[derive(Debug, Clone)]
+pub struct FrameDecoder {
+    /// Buffer for frame being assembled.
+    buffer: [u8; IDTP_FRAME_MAX_SIZE],
+    /// Number of bytes stored in buffer.
+    len: usize,
+    /// Size of frame being assembled or 0 if header is not verified yet.
+    frame_size: usize,
+    /// Complete frame is stored in buffer.
+    ready: bool,
+    /// Number of bytes dropped during resynchronisation.
+    discarded: usize,
+}
+
+impl FrameDecoder {
+    /// Construct new `FrameDecoder` object.
+    ///
+    /// # Returns
+    /// - New `FrameDecoder` object.
+    #[must_use]
+    pub const fn new() -> Self {
+        Self {
+            buffer: [0u8; IDTP_FRAME_MAX_SIZE],
+            len: 0,
+            frame_size: 0,
+            ready: false,
+            discarded: 0,
+        }
+    }
+
+    /// Reset decoder state. All buffered bytes are dropped.
+    pub const fn reset(&mut self) {
+        self.len = 0;
+        self.frame_size = 0;
+        self.ready = false;
+    }
+
+    /// Get number of bytes dropped during resynchronisation.
+    ///
+    /// # Returns
+    /// - Number of dropped bytes since decoder construction.
+    #[inline]
+    #[must_use]
+    pub const fn discarded(&self) -> usize {
+        self.discarded
+    }
+
+    /// Get complete frame.
+    ///
+    /// # Returns
+    /// - Raw IDTP frame bytes - if frame is complete.
+    /// - `None` - otherwise.
+    #[inline]
+    #[must_use]
+    pub fn frame(&self) -> Option<&[u8]> {
+        if self.ready {
+            return self.buffer.get(..self.len);
+        }
+        None
+    }
+
+    /// Get buffer space to fill with incoming bytes. Size of returned slice
+    /// never exceeds the number of bytes required to complete the current
+    /// stage (header or the rest of frame), so reading into it never consumes
+    /// bytes of the next frame.
+    ///
+    /// # Returns
+    /// - Mutable slice to fill.
+    pub fn spare(&mut self) -> &mut [u8] {
+        if self.ready {
+            self.reset();
+        }
+
+        let end = if self.frame_size == 0 {
+            IDTP_HEADER_SIZE
+        } else {
+            self.frame_size
+        };
+
+        self.buffer.get_mut(self.len..end).unwrap_or_default()
+    }
+
+    /// Commit bytes written into slice returned by `spare`.
+    ///
+    /// # Parameters
+    /// - `count` - given number of bytes written.
+    /// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+    ///
+    /// # Returns
+    /// - Frame size in bytes - if frame is complete.
+    /// - `None` - if more bytes required.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Errors returned by `calc_crc8`.
+    pub fn commit_with<C8>(
+        &mut self,
+        count: usize,
+        mut calc_crc8: C8,
+    ) -> IdtpResult<Option<usize>>
+    where
+        C8: FnMut(&[u8]) -> IdtpResult<u8>,
+    {
+        self.len = (self.len + count).min(IDTP_FRAME_MAX_SIZE);
+
+        while self.frame_size == 0 {
+            let prefix = self.len.min(PREAMBLE_BYTES.len());
+            let candidate = self.buffer.get(..prefix).unwrap_or_default();
+
+            if candidate != PREAMBLE_BYTES.get(..prefix).unwrap_or_default() {
+                self.resync();
+                continue;
+            }
+
+            if self.len < IDTP_HEADER_SIZE {
+                return Ok(None);
+            }
+
+            match self.verify_header(&mut calc_crc8)? {
+                Some(size) => self.frame_size = size,
+                None => self.resync(),
+            }
+        }
+
+        if self.len < self.frame_size {
+            return Ok(None);
+        }
+
+        self.ready = true;
+        Ok(Some(self.len))
+    }
+
+    /// Feed incoming bytes to decoder with custom `CRC-8` calculation.
+    ///
+    /// # Parameters
+    /// - `input` - given incoming bytes.
+    /// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+    ///
+    /// # Returns
+    /// - Number of consumed bytes & complete frame if any - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if spare space is out of bounds.
+    /// - Errors returned by `calc_crc8`.
+    pub fn feed_with<C8>(
+        &mut self,
+        input: &[u8],
+        mut calc_crc8: C8,
+    ) -> IdtpResult<(usize, Option<&[u8]>)>
+    where
+        C8: FnMut(&[u8]) -> IdtpResult<u8>,
+    {
+        let mut consumed = 0;
+
+        while consumed < input.len() {
+            let spare = self.spare();
+            let rest =
+                input.get(consumed..).ok_or(IdtpError::BufferUnderflow)?;
+            let count = spare.len().min(rest.len());
+
+            spare
+                .get_mut(..count)
+                .ok_or(IdtpError::BufferOverflow)?
+                .copy_from_slice(
+                    rest.get(..count).ok_or(IdtpError::BufferUnderflow)?,
+                );
+            consumed += count;
+
+            if self.commit_with(count, &mut calc_crc8)?.is_some() {
+                return Ok((consumed, self.frame()));
+            }
+        }
+
+        Ok((consumed, None))
+    }
+
+    /// Feed incoming bytes to decoder. `CRC-8` calculation is software-based.
+    ///
+    /// # Parameters
+    /// - `input` - given incoming bytes.
+    ///
+    /// # Returns
+    /// - Number of consumed bytes & complete frame if any - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - None.
+    #[cfg(feature = "software_impl")]
+    pub fn feed(&mut self, input: &[u8]) -> IdtpResult<(usize, Option<&[u8]>)> {
+        self.feed_with(input, crypto::sw_crc8)
+    }
+
+    /// Check buffered header & calculate frame size.
+    ///
+    /// # Parameters
+    /// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+    ///
+    /// # Returns
+    /// - Frame size in bytes - if header is valid.
+    /// - `None` - otherwise.
+    ///
+    /// # Errors
+    /// - Errors returned by `calc_crc8`.
+    fn verify_header<C8>(&self, calc_crc8: &mut C8) -> IdtpResult<Option<usize>>
+    where
+        C8: FnMut(&[u8]) -> IdtpResult<u8>,
+    {
+        let data = self.buffer.get(..CRC_OFFSET).unwrap_or_default();
+        let received_crc8 = self.buffer.get(CRC_OFFSET).copied();
+
+        if received_crc8 != Some(calc_crc8(data)?) {
+            return Ok(None);
+        }
+
+        let payload_size = self
+            .buffer
+            .get(PAYLOAD_SIZE_OFFSET..PAYLOAD_SIZE_OFFSET + 2)
+            .and_then(|bytes| bytes.try_into().ok())
+            .map_or(usize::MAX, |bytes| u16::from_le_bytes(bytes) as usize);
+
+        let mode = self
+            .buffer
+            .get(MODE_OFFSET)
+            .and_then(|mode| IdtpMode::try_from(*mode).ok());
+
+        match mode {
+            Some(mode) if payload_size <= IDTP_PAYLOAD_MAX_SIZE => {
+                let size = IDTP_HEADER_SIZE
+                    + payload_size
+                    + IdtpFrame::trailer_size_from(mode);
+                Ok((size <= IDTP_FRAME_MAX_SIZE).then_some(size))
+            }
+            _ => Ok(None),
+        }
+    }
+
+    /// Drop first buffered byte and move to the next preamble candidate.
+    fn resync(&mut self) {
+        let rest = self.buffer.get(1..self.len).unwrap_or_default();
+        let skip = rest
+            .iter()
+            .position(|byte| Some(byte) == PREAMBLE_BYTES.first())
+            .map_or(self.len, |position| position + 1);
+
+        self.buffer.copy_within(skip..self.len, 0);
+        self.len -= skip;
+        self.discarded += skip;
+    }
+}
+
+impl Default for FrameDecoder {
+    /// Construct default frame decoder.
+    ///
+    /// # Returns
+    /// - New default frame decoder.
+    fn default() -> Self {
+        Self::new()
+    }
+}
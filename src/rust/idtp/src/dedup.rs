@@ -0,0 +1,443 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Redundant-path de-duplication.
+//!
+//! Frames sent over several independent links are merged into a single
+//! stream: the first copy of each `(device_id, sequence)` is forwarded & the
+//! later copies are dropped. Each device has a sliding bitmap window of
+//! recent sequence numbers, so each frame costs `O(1)` work without
+//! allocations. Per-link statistics report how often each link delivered
+//! the first copy & by how much it was ahead of the other links.
+//!
+//! Parity frames (`FEC_PAYLOAD_TYPE`) do not consume sequence numbers, so
+//! they are keyed by `base_sequence + index` of their parity header in a
+//! separate window of the device.
+
+use crate::IdtpHeader;
+use crate::fec::{FEC_PAYLOAD_TYPE, FecHeader};
+use zerocopy::FromBytes;
+
+/// Number of recent sequence numbers tracked per device.
+pub const DEDUP_WINDOW: usize = 128;
+
+/// Distance after which device is treated as restarted.
+const RESYNC_DISTANCE: u32 = 1 << 16;
+
+/// Window key flag of parity frames.
+const PARITY_KEY: u32 = 1 << 17;
+
+/// Number of words in window bitmap.
+const WINDOW_WORDS: usize = DEDUP_WINDOW / 64;
+
+/// Verdict of de-duplication.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Verdict {
+    /// The first copy of frame, it should be forwarded.
+    First,
+    /// Copy of already forwarded frame.
+    Duplicate,
+    /// Frame is older than device window, it is dropped.
+    Stale,
+    /// Buffer is shorter than header or parity header, it is dropped.
+    Malformed,
+}
+
+/// Per-link statistics.
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct LinkStats {
+    /// Number of first copies delivered by link.
+    pub first: u64,
+    /// Number of duplicate copies delivered by link.
+    pub duplicates: u64,
+    /// Number of first copies later matched by duplicate from another link.
+    pub matched: u64,
+    /// Total lead of link over other links for matched copies.
+    pub lead: u64,
+}
+
+impl LinkStats {
+    /// Get mean lead of link over other links.
+    ///
+    /// # Returns
+    /// - Mean lead in units of `now` argument of `accept`.
+    #[must_use]
+    pub fn mean_lead(&self) -> u64 {
+        self.lead.checked_div(self.matched).unwrap_or_default()
+    }
+}
+
+/// Sliding window of a single device.
+#[derive(Debug, Clone, Copy)]
+struct DeviceWindow {
+    /// Device ID + 1 (with `PARITY_KEY` for parity frames) or 0 if window
+    /// is free.
+    device: u32,
+    /// The highest seen sequence number.
+    highest: u32,
+    /// Bitmap of seen sequence numbers indexed by `sequence mod window`.
+    seen: [u64; WINDOW_WORDS],
+    /// Low 32 bits of arrival time of the first copies.
+    arrival: [u32; DEDUP_WINDOW],
+    /// Links of the first copies.
+    link: [u8; DEDUP_WINDOW],
+}
+
+impl DeviceWindow {
+    /// Empty device window.
+    const EMPTY: Self = Self {
+        device: 0,
+        highest: 0,
+        seen: [0; WINDOW_WORDS],
+        arrival: [0; DEDUP_WINDOW],
+        link: [0; DEDUP_WINDOW],
+    };
+
+    /// Reset window to start at sequence number.
+    ///
+    /// # Parameters
+    /// - `sequence` - given sequence number.
+    const fn reset(&mut self, sequence: u32) {
+        self.highest = sequence;
+        self.seen = [0; WINDOW_WORDS];
+    }
+
+    /// Test & set bit of sequence number.
+    ///
+    /// # Parameters
+    /// - `sequence` - given sequence number.
+    ///
+    /// # Returns
+    /// - Previous bit value.
+    fn test_and_set(&mut self, sequence: u32) -> bool {
+        let index = sequence as usize % DEDUP_WINDOW;
+        let bit = 1 << (index % 64);
+
+        self.seen.get_mut(index / 64).is_none_or(|word| {
+            let seen = *word & bit != 0;
+            *word |= bit;
+            seen
+        })
+    }
+
+    /// Clear bit of sequence number.
+    ///
+    /// # Parameters
+    /// - `sequence` - given sequence number.
+    fn clear(&mut self, sequence: u32) {
+        let index = sequence as usize % DEDUP_WINDOW;
+
+        if let Some(word) = self.seen.get_mut(index / 64) {
+            *word &= !(1 << (index % 64));
+        }
+    }
+}
+
+/// De-duplicator of frames received over redundant links.
+///
+/// # Parameters
+/// - `N` - max number of tracked devices. **MUST** be a power of two.
+/// - `L` - number of links.
+#[derive(Debug, Clone)]
+pub struct Deduplicator<const N: usize, const L: usize> {
+    /// Device windows.
+    windows: [DeviceWindow; N],
+    /// Per-link statistics.
+    links: [LinkStats; L],
+    /// Number of stale frames.
+    stale: u64,
+    /// Number of frames of devices that do not fit into table.
+    untracked: u64,
+    /// Number of buffers shorter than header or parity header.
+    malformed: u64,
+}
+
+impl<const N: usize, const L: usize> Deduplicator<N, L> {
+    /// Construct new `Deduplicator` object.
+    ///
+    /// # Returns
+    /// - New `Deduplicator` object.
+    #[must_use]
+    pub const fn new() -> Self {
+        const {
+            assert!(N.is_power_of_two(), "N must be a power of two");
+            assert!(L > 0 && L <= u8::MAX as usize, "invalid number of links");
+        }
+
+        Self {
+            windows: [DeviceWindow::EMPTY; N],
+            links: [LinkStats {
+                first: 0,
+                duplicates: 0,
+                matched: 0,
+                lead: 0,
+            }; L],
+            stale: 0,
+            untracked: 0,
+            malformed: 0,
+        }
+    }
+
+    /// Get link statistics.
+    ///
+    /// # Parameters
+    /// - `link` - given link index.
+    ///
+    /// # Returns
+    /// - Link statistics.
+    #[must_use]
+    pub fn link_stats(&self, link: usize) -> LinkStats {
+        self.links.get(link).copied().unwrap_or_default()
+    }
+
+    /// Get link win rate.
+    ///
+    /// # Parameters
+    /// - `link` - given link index.
+    ///
+    /// # Returns
+    /// - Share of first copies delivered by link in range `[0, 1]`.
+    #[must_use]
+    #[allow(clippy::cast_precision_loss)]
+    pub fn win_rate(&self, link: usize) -> f64 {
+        let total: u64 = self.links.iter().map(|stats| stats.first).sum();
+
+        if total == 0 {
+            return 0.0;
+        }
+
+        self.link_stats(link).first as f64 / total as f64
+    }
+
+    /// Get number of stale frames.
+    ///
+    /// # Returns
+    /// - Number of frames older than device window.
+    #[inline]
+    #[must_use]
+    pub const fn stale(&self) -> u64 {
+        self.stale
+    }
+
+    /// Get number of untracked frames.
+    ///
+    /// # Returns
+    /// - Number of forwarded frames of devices that do not fit into table.
+    #[inline]
+    #[must_use]
+    pub const fn untracked(&self) -> u64 {
+        self.untracked
+    }
+
+    /// Get number of malformed frames.
+    ///
+    /// # Returns
+    /// - Number of buffers shorter than header or parity header.
+    #[inline]
+    #[must_use]
+    pub const fn malformed(&self) -> u64 {
+        self.malformed
+    }
+
+    /// Check raw IDTP frame received over link. Frame is expected to be
+    /// validated. Parity frames are checked by their parity header.
+    ///
+    /// # Parameters
+    /// - `link` - given link index.
+    /// - `buffer` - given raw IDTP frame.
+    /// - `now` - given arrival time.
+    ///
+    /// # Returns
+    /// - De-duplication verdict.
+    pub fn accept_frame(
+        &mut self,
+        link: usize,
+        buffer: &[u8],
+        now: u64,
+    ) -> Verdict {
+        let Ok((header, rest)) = IdtpHeader::ref_from_prefix(buffer) else {
+            self.malformed += 1;
+            return Verdict::Malformed;
+        };
+
+        if header.payload_type != FEC_PAYLOAD_TYPE {
+            return self.accept(link, header.device_id, header.sequence, now);
+        }
+
+        if let Ok((group, _)) = FecHeader::ref_from_prefix(rest) {
+            self.accept_parity(
+                link,
+                header.device_id,
+                group.base_sequence,
+                group.index,
+                now,
+            )
+        } else {
+            self.malformed += 1;
+            Verdict::Malformed
+        }
+    }
+
+    /// Check parity frame received over link. Parity frames are keyed by
+    /// `base_sequence + index`, so groups with more parity than data frames
+    /// share keys with the next group.
+    ///
+    /// # Parameters
+    /// - `link` - given link index.
+    /// - `device_id` - given frame device ID.
+    /// - `base_sequence` - given sequence number of the first group frame.
+    /// - `index` - given parity frame index.
+    /// - `now` - given arrival time.
+    ///
+    /// # Returns
+    /// - De-duplication verdict.
+    pub fn accept_parity(
+        &mut self,
+        link: usize,
+        device_id: u16,
+        base_sequence: u32,
+        index: u8,
+        now: u64,
+    ) -> Verdict {
+        let key = (u32::from(device_id) + 1) | PARITY_KEY;
+        let sequence = base_sequence.wrapping_add(u32::from(index));
+
+        self.accept_keyed(link, key, sequence, now)
+    }
+
+    /// Check frame received over link.
+    ///
+    /// # Parameters
+    /// - `link` - given link index.
+    /// - `device_id` - given frame device ID.
+    /// - `sequence` - given frame sequence number.
+    /// - `now` - given arrival time.
+    ///
+    /// # Returns
+    /// - De-duplication verdict.
+    pub fn accept(
+        &mut self,
+        link: usize,
+        device_id: u16,
+        sequence: u32,
+        now: u64,
+    ) -> Verdict {
+        self.accept_keyed(link, u32::from(device_id) + 1, sequence, now)
+    }
+
+    /// Check frame of window key received over link.
+    ///
+    /// # Parameters
+    /// - `link` - given link index.
+    /// - `key` - given window key.
+    /// - `sequence` - given sequence number.
+    /// - `now` - given arrival time.
+    ///
+    /// # Returns
+    /// - De-duplication verdict.
+    #[allow(clippy::cast_possible_truncation, clippy::cast_possible_wrap)]
+    fn accept_keyed(
+        &mut self,
+        link: usize,
+        key: u32,
+        sequence: u32,
+        now: u64,
+    ) -> Verdict {
+        let Some(window) = self.claim(key, sequence) else {
+            self.untracked += 1;
+            return Verdict::First;
+        };
+
+        let distance = sequence.wrapping_sub(window.highest) as i32;
+
+        if distance.unsigned_abs() >= RESYNC_DISTANCE {
+            window.reset(sequence);
+        } else if distance > 0 {
+            let start = if distance.unsigned_abs() as usize >= DEDUP_WINDOW {
+                sequence.wrapping_sub(DEDUP_WINDOW as u32 - 1)
+            } else {
+                window.highest.wrapping_add(1)
+            };
+
+            let mut stale = start;
+            while stale != sequence {
+                window.clear(stale);
+                stale = stale.wrapping_add(1);
+            }
+
+            window.clear(sequence);
+            window.highest = sequence;
+        } else if distance.unsigned_abs() as usize >= DEDUP_WINDOW {
+            self.stale += 1;
+            return Verdict::Stale;
+        }
+
+        let index = sequence as usize % DEDUP_WINDOW;
+
+        if window.test_and_set(sequence) {
+            let winner = window.link.get(index).copied().unwrap_or_default();
+            let arrival =
+                window.arrival.get(index).copied().unwrap_or_default();
+            let lead = u64::from((now as u32).wrapping_sub(arrival));
+
+            if let Some(stats) = self.links.get_mut(usize::from(winner)) {
+                stats.matched += 1;
+                stats.lead += lead;
+            }
+            if let Some(stats) = self.links.get_mut(link) {
+                stats.duplicates += 1;
+            }
+
+            return Verdict::Duplicate;
+        }
+
+        if let Some(slot) = window.arrival.get_mut(index) {
+            *slot = now as u32;
+        }
+        if let Some(slot) = window.link.get_mut(index) {
+            *slot = link as u8;
+        }
+        if let Some(stats) = self.links.get_mut(link) {
+            stats.first += 1;
+        }
+
+        Verdict::First
+    }
+
+    /// Find or claim window of key.
+    ///
+    /// # Parameters
+    /// - `key` - given window key.
+    /// - `sequence` - given sequence number to start new window at.
+    ///
+    /// # Returns
+    /// - Device window - in case of success.
+    /// - `None` - if table is full.
+    fn claim(&mut self, key: u32, sequence: u32) -> Option<&mut DeviceWindow> {
+        let hash = (key ^ (key >> 16)) as usize;
+        let start = hash.wrapping_mul(0x9E37) & (N - 1);
+        let (tail, head) = self.windows.split_at_mut(start);
+
+        let window = head
+            .iter_mut()
+            .chain(tail)
+            .find(|window| window.device == key || window.device == 0)?;
+
+        if window.device == 0 {
+            window.device = key;
+            window.reset(sequence);
+        }
+
+        Some(window)
+    }
+}
+
+impl<const N: usize, const L: usize> Default for Deduplicator<N, L> {
+    /// Construct default de-duplicator.
+    ///
+    /// # Returns
+    /// - New default de-duplicator.
+    fn default() -> Self {
+        Self::new()
+    }
+}
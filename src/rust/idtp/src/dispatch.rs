@@ -0,0 +1,348 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Typed payload dispatch.
+//!
+//! `PayloadDispatcher` holds a dense table of 256 handlers indexed by
+//! payload type, so dispatching a frame is a single indexed call. Each entry
+//! is a monomorphized trampoline that borrows payload as `&T` directly from
+//! frame bytes & passes it to `PayloadHandler<T>` implementation of context.
+//! Table can be built in `const` context for standard & vendor payload types.
+
+use crate::{
+    IDTP_HEADER_SIZE, IdtpError, IdtpFrame, IdtpHeader, IdtpResult,
+    payload::IdtpPayload,
+};
+use zerocopy::FromBytes;
+
+#[cfg(feature = "std_payloads")]
+use crate::payload::{Imu3Acc, Imu3Gyr, Imu3Mag, Imu6, Imu9, Imu10, ImuQuat};
+
+/// Offset of the header `payload_type` field.
+const PAYLOAD_TYPE_OFFSET: usize = 18;
+
+/// Number of possible payload types.
+const PAYLOAD_TYPE_COUNT: usize = 256;
+
+/// Trait for context that handles payloads of type `T`.
+pub trait PayloadHandler<T: IdtpPayload> {
+    /// Handle payload.
+    ///
+    /// # Parameters
+    /// - `header` - given IDTP frame header.
+    /// - `payload` - given payload borrowed from frame bytes.
+    fn handle(&mut self, header: &IdtpHeader, payload: &T);
+}
+
+/// Payload handler table entry.
+type Handler<C> = fn(&mut C, &IdtpHeader, &[u8]) -> IdtpResult<()>;
+
+/// Decode payload & pass it to context handler.
+///
+/// # Parameters
+/// - `context` - given handler context.
+/// - `header` - given IDTP frame header.
+/// - `payload` - given raw payload.
+///
+/// # Returns
+/// - `Ok` - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer underflow.
+fn trampoline<C, T>(
+    context: &mut C,
+    header: &IdtpHeader,
+    payload: &[u8],
+) -> IdtpResult<()>
+where
+    C: PayloadHandler<T>,
+    T: IdtpPayload,
+{
+    let (payload, _) =
+        T::ref_from_prefix(payload).map_err(|_| IdtpError::BufferUnderflow)?;
+
+    context.handle(header, payload);
+    Ok(())
+}
+
+/// Handler of payload types without registered handler.
+///
+/// # Returns
+/// - `Err` - always.
+///
+/// # Errors
+/// - Parse error.
+const fn unhandled<C>(
+    _context: &mut C,
+    _header: &IdtpHeader,
+    _payload: &[u8],
+) -> IdtpResult<()> {
+    Err(IdtpError::ParseError)
+}
+
+/// Dispatcher of IDTP payloads to typed handlers of context `C`.
+pub struct PayloadDispatcher<C> {
+    /// Handlers indexed by payload type.
+    table: [Handler<C>; PAYLOAD_TYPE_COUNT],
+}
+
+impl<C> PayloadDispatcher<C> {
+    /// Construct new `PayloadDispatcher` object with no registered handlers.
+    ///
+    /// # Returns
+    /// - New `PayloadDispatcher` object.
+    #[must_use]
+    pub const fn new() -> Self {
+        Self {
+            table: [unhandled::<C>; PAYLOAD_TYPE_COUNT],
+        }
+    }
+
+    /// Register handler for payload type `T`.
+    ///
+    /// # Returns
+    /// - Dispatcher with registered handler.
+    #[must_use]
+    #[allow(clippy::indexing_slicing)]
+    pub const fn with<T>(mut self) -> Self
+    where
+        C: PayloadHandler<T>,
+        T: IdtpPayload,
+    {
+        self.table[T::TYPE_ID as usize] = trampoline::<C, T>;
+        self
+    }
+
+    /// Register handler for payload type `T` at runtime.
+    ///
+    /// # Returns
+    /// - Dispatcher with registered handler.
+    pub fn register<T>(&mut self) -> &mut Self
+    where
+        C: PayloadHandler<T>,
+        T: IdtpPayload,
+    {
+        if let Some(handler) = self.table.get_mut(usize::from(T::TYPE_ID)) {
+            *handler = trampoline::<C, T>;
+        }
+        self
+    }
+
+    /// Unregister handler of payload type.
+    ///
+    /// # Parameters
+    /// - `payload_type` - given payload type.
+    pub fn unregister(&mut self, payload_type: u8) {
+        if let Some(handler) = self.table.get_mut(usize::from(payload_type)) {
+            *handler = unhandled::<C>;
+        }
+    }
+
+    /// Dispatch payload of IDTP frame.
+    ///
+    /// # Parameters
+    /// - `context` - given handler context.
+    /// - `frame` - given IDTP frame.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Parse error - if payload type has no registered handler.
+    #[inline]
+    pub fn dispatch(
+        &self,
+        context: &mut C,
+        frame: &IdtpFrame,
+    ) -> IdtpResult<()> {
+        let header = frame.header();
+        self.call(context, header, frame.payload_raw()?)
+    }
+
+    /// Dispatch payload of raw IDTP frame without copying. Frame is expected
+    /// to be validated.
+    ///
+    /// # Parameters
+    /// - `context` - given handler context.
+    /// - `buffer` - given raw IDTP frame.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Parse error - if payload type has no registered handler.
+    #[inline]
+    pub fn dispatch_raw(
+        &self,
+        context: &mut C,
+        buffer: &[u8],
+    ) -> IdtpResult<()> {
+        let (header, rest) = IdtpHeader::ref_from_prefix(buffer)
+            .map_err(|_| IdtpError::BufferUnderflow)?;
+
+        let payload = rest
+            .get(..usize::from(header.payload_size))
+            .ok_or(IdtpError::BufferUnderflow)?;
+
+        self.call(context, header, payload)
+    }
+
+    /// Dispatch batch of raw IDTP frames grouped by payload type. Frames of
+    /// the same type are dispatched in input order.
+    ///
+    /// # Parameters
+    /// - `context` - given handler context.
+    /// - `frames` - given raw IDTP frames. Frames are expected to be
+    ///   validated.
+    /// - `order` - given scratch buffer for dispatch order. Its size **MUST
+    ///   NOT** be less than number of frames.
+    ///
+    /// # Returns
+    /// - Number of successfully dispatched frames - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow - if scratch buffer is too small.
+    pub fn dispatch_batch<B>(
+        &self,
+        context: &mut C,
+        frames: &[B],
+        order: &mut [usize],
+    ) -> IdtpResult<usize>
+    where
+        B: AsRef<[u8]>,
+    {
+        let order = order
+            .get_mut(..frames.len())
+            .ok_or(IdtpError::BufferUnderflow)?;
+
+        // Counting sort of frame indices by payload type.
+        let mut offsets = [0usize; PAYLOAD_TYPE_COUNT];
+
+        for frame in frames {
+            if let Some(offset) = offsets.get_mut(payload_type(frame.as_ref()))
+            {
+                *offset += 1;
+            }
+        }
+
+        let mut total = 0;
+
+        for offset in &mut offsets {
+            let count = *offset;
+            *offset = total;
+            total += count;
+        }
+
+        for (index, frame) in frames.iter().enumerate() {
+            if let Some(offset) = offsets.get_mut(payload_type(frame.as_ref()))
+                && let Some(slot) = order.get_mut(*offset)
+            {
+                *slot = index;
+                *offset += 1;
+            }
+        }
+
+        let mut dispatched = 0;
+
+        for index in order.iter() {
+            if let Some(frame) = frames.get(*index)
+                && self.dispatch_raw(context, frame.as_ref()).is_ok()
+            {
+                dispatched += 1;
+            }
+        }
+
+        Ok(dispatched)
+    }
+
+    /// Call handler of payload type.
+    ///
+    /// # Parameters
+    /// - `context` - given handler context.
+    /// - `header` - given IDTP frame header.
+    /// - `payload` - given raw payload.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Parse error - if payload type has no registered handler.
+    #[inline]
+    fn call(
+        &self,
+        context: &mut C,
+        header: &IdtpHeader,
+        payload: &[u8],
+    ) -> IdtpResult<()> {
+        let handler = self
+            .table
+            .get(usize::from(header.payload_type))
+            .ok_or(IdtpError::ParseError)?;
+
+        handler(context, header, payload)
+    }
+}
+
+#[cfg(feature = "std_payloads")]
+impl<C> PayloadDispatcher<C>
+where
+    C: PayloadHandler<Imu3Acc>
+        + PayloadHandler<Imu3Gyr>
+        + PayloadHandler<Imu3Mag>
+        + PayloadHandler<Imu6>
+        + PayloadHandler<Imu9>
+        + PayloadHandler<Imu10>
+        + PayloadHandler<ImuQuat>,
+{
+    /// Construct new `PayloadDispatcher` object with handlers of all
+    /// standard payload types.
+    ///
+    /// # Returns
+    /// - New `PayloadDispatcher` object.
+    #[must_use]
+    pub const fn standard() -> Self {
+        Self::new()
+            .with::<Imu3Acc>()
+            .with::<Imu3Gyr>()
+            .with::<Imu3Mag>()
+            .with::<Imu6>()
+            .with::<Imu9>()
+            .with::<Imu10>()
+            .with::<ImuQuat>()
+    }
+}
+
+impl<C> Default for PayloadDispatcher<C> {
+    /// Construct default payload dispatcher.
+    ///
+    /// # Returns
+    /// - New default payload dispatcher.
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Get payload type of raw IDTP frame.
+///
+/// # Parameters
+/// - `buffer` - given raw IDTP frame.
+///
+/// # Returns
+/// - Payload type or 0 if frame is too short.
+fn payload_type(buffer: &[u8]) -> usize {
+    if buffer.len() < IDTP_HEADER_SIZE {
+        return 0;
+    }
+
+    buffer
+        .get(PAYLOAD_TYPE_OFFSET)
+        .map_or(0, |payload_type| usize::from(*payload_type))
+}
@@ -0,0 +1,848 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Forward error correction (FEC) parity frames.
+//!
+//! Sender groups `K` consecutive frames of a device & sends `M` extra parity
+//! frames with reserved payload type `FEC_PAYLOAD_TYPE`. Parity is computed
+//! over whole raw frames (header, payload & trailer) zero-padded to the
+//! longest frame of the group, so receiver can rebuild up to `M` lost frames
+//! of the group & validate them as usual. Lost frames are found by
+//! `sequence` gaps. Two schemes are supported:
+//!
+//! - `Xor` - single parity frame with XOR of group frames.
+//! - `ReedSolomon` - systematic Cauchy Reed-Solomon code over `GF(2^8)`,
+//!   any `M` lost frames out of `K + M` can be rebuilt.
+//!
+//! Parity frames do not consume sequence numbers: header `sequence` repeats
+//! the last data frame of group. `Deduplicator` keys them by parity header,
+//! after de-duplication they **MUST** be routed to `FecDecoder` by payload
+//! type & **MUST NOT** reach reordering or replay checks of data frames.
+
+use crate::{
+    IDTP_HEADER_SIZE, IDTP_PAYLOAD_MAX_SIZE, IdtpError, IdtpFrame, IdtpHeader,
+    IdtpMode, IdtpResult, idtp_data,
+};
+use zerocopy::{FromBytes, Immutable, IntoBytes, KnownLayout};
+
+/// Reserved standard payload type of parity frames.
+pub const FEC_PAYLOAD_TYPE: u8 = 0x70;
+
+/// Size of parity payload header in bytes.
+pub const FEC_HEADER_SIZE: usize = size_of::<FecHeader>();
+
+/// Max size of protected frame in bytes.
+pub const FEC_MAX_FRAME_SIZE: usize = IDTP_PAYLOAD_MAX_SIZE - FEC_HEADER_SIZE;
+
+/// Max number of data frames in group.
+pub const FEC_MAX_DATA_FRAMES: usize = 128;
+
+/// Max number of parity frames in group.
+pub const FEC_MAX_PARITY_FRAMES: usize = 128;
+
+/// `GF(2^8)` reducing polynomial `x^8 + x^4 + x^3 + x^2 + 1`.
+const GF_POLYNOMIAL: u16 = 0x11D;
+
+/// `GF(2^8)` exponent & logarithm tables.
+const GF_TABLES: ([u8; 512], [u8; 256]) = gf_tables();
+
+/// `GF(2^8)` exponent table, doubled to skip modulo reduction.
+const GF_EXP: [u8; 512] = GF_TABLES.0;
+
+/// `GF(2^8)` logarithm table.
+const GF_LOG: [u8; 256] = GF_TABLES.1;
+
+/// FEC scheme.
+#[repr(u8)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum FecScheme {
+    /// Single XOR parity frame.
+    Xor = 0,
+    /// Cauchy Reed-Solomon parity frames.
+    ReedSolomon = 1,
+}
+
+impl TryFrom<u8> for FecScheme {
+    /// The type returned in the event of a conversion error.
+    type Error = IdtpError;
+
+    /// Try to convert byte to FEC scheme.
+    ///
+    /// # Parameters
+    /// - `value` - given byte to convert.
+    ///
+    /// # Returns
+    /// - FEC scheme from byte - in case of success.
+    /// - Error otherwise.
+    ///
+    /// # Errors
+    /// - Parse Error.
+    fn try_from(value: u8) -> Result<Self, Self::Error> {
+        match value {
+            0 => Ok(Self::Xor),
+            1 => Ok(Self::ReedSolomon),
+            _ => Err(Self::Error::ParseError),
+        }
+    }
+}
+
+idtp_data! {
+    /// Header of parity frame payload.
+    #[derive(Default)]
+    pub struct FecHeader {
+        /// Sequence number of the first data frame of group.
+        pub base_sequence: u32,
+        /// Number of data frames in group.
+        pub data_count: u8,
+        /// Number of parity frames in group.
+        pub parity_count: u8,
+        /// Index of parity frame in group.
+        pub index: u8,
+        /// FEC scheme.
+        pub scheme: u8,
+    }
+}
+
+/// FEC decoder statistics.
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct FecStats {
+    /// Number of rebuilt frames.
+    pub recovered: u64,
+    /// Number of lost frames that could not be rebuilt.
+    pub unrecoverable: u64,
+}
+
+/// Parity frames encoder of a single device.
+///
+/// # Parameters
+/// - `M` - number of parity frames per group.
+#[derive(Debug, Clone)]
+pub struct FecEncoder<const M: usize> {
+    /// FEC scheme.
+    scheme: FecScheme,
+    /// Number of data frames in group.
+    data_count: usize,
+    /// Number of data frames pushed to current group.
+    pushed: usize,
+    /// Sequence number of the first data frame of current group.
+    base_sequence: u32,
+    /// Size of the longest frame of current group.
+    length: usize,
+    /// Parity payloads including parity header.
+    parity: [[u8; IDTP_PAYLOAD_MAX_SIZE]; M],
+}
+
+impl<const M: usize> FecEncoder<M> {
+    /// Construct new `FecEncoder` object.
+    ///
+    /// # Parameters
+    /// - `scheme` - given FEC scheme.
+    /// - `data_count` - given number of data frames per group.
+    ///
+    /// # Returns
+    /// - New `FecEncoder` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Parse error - if `data_count` is out of `1..=FEC_MAX_DATA_FRAMES` or
+    ///   XOR scheme is used with more than one parity frame.
+    pub const fn new(scheme: FecScheme, data_count: usize) -> IdtpResult<Self> {
+        const {
+            assert!(
+                M > 0 && M <= FEC_MAX_PARITY_FRAMES,
+                "invalid number of parity frames"
+            );
+        }
+
+        if !is_valid_group(scheme, data_count, M) {
+            return Err(IdtpError::ParseError);
+        }
+
+        Ok(Self {
+            scheme,
+            data_count,
+            pushed: 0,
+            base_sequence: 0,
+            length: 0,
+            parity: [[0; IDTP_PAYLOAD_MAX_SIZE]; M],
+        })
+    }
+
+    /// Add raw IDTP frame to current group. Frame that does not follow the
+    /// previous one by `sequence` starts a new group.
+    ///
+    /// # Parameters
+    /// - `buffer` - given raw IDTP frame.
+    ///
+    /// # Returns
+    /// - `true` - if group is complete & parity frames are ready.
+    /// - `false` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow - if buffer is shorter than header.
+    /// - Buffer overflow - if frame is longer than `FEC_MAX_FRAME_SIZE`.
+    #[allow(clippy::cast_possible_truncation)]
+    pub fn push(&mut self, buffer: &[u8]) -> IdtpResult<bool> {
+        let (header, _) = IdtpHeader::ref_from_prefix(buffer)
+            .map_err(|_| IdtpError::BufferUnderflow)?;
+
+        if buffer.len() > FEC_MAX_FRAME_SIZE {
+            return Err(IdtpError::BufferOverflow);
+        }
+
+        let sequence = header.sequence;
+
+        if self.is_ready()
+            || sequence != self.base_sequence.wrapping_add(self.pushed as u32)
+        {
+            self.pushed = 0;
+        }
+
+        if self.pushed == 0 {
+            self.base_sequence = sequence;
+            self.length = 0;
+
+            for row in &mut self.parity {
+                row.fill(0);
+            }
+        }
+
+        for (index, row) in self.parity.iter_mut().enumerate() {
+            let coefficient = coefficient(self.scheme, index, self.pushed);
+
+            if let Some(data) = row.get_mut(FEC_HEADER_SIZE..) {
+                mul_add(data, buffer, coefficient);
+            }
+        }
+
+        self.length = self.length.max(buffer.len());
+        self.pushed += 1;
+
+        if !self.is_ready() {
+            return Ok(false);
+        }
+
+        for (index, row) in self.parity.iter_mut().enumerate() {
+            let header = FecHeader {
+                base_sequence: self.base_sequence,
+                data_count: self.data_count as u8,
+                parity_count: M as u8,
+                index: index as u8,
+                scheme: self.scheme as u8,
+            };
+
+            if let Some(bytes) = row.get_mut(..FEC_HEADER_SIZE) {
+                bytes.copy_from_slice(header.as_bytes());
+            }
+        }
+
+        Ok(true)
+    }
+
+    /// Check whether parity frames of current group are ready.
+    ///
+    /// # Returns
+    /// - `true` - if group is complete.
+    /// - `false` - otherwise.
+    #[inline]
+    #[must_use]
+    pub const fn is_ready(&self) -> bool {
+        self.pushed == self.data_count
+    }
+
+    /// Get parity payload of current group.
+    ///
+    /// # Parameters
+    /// - `index` - given parity frame index.
+    ///
+    /// # Returns
+    /// - Parity payload bytes - if group is complete.
+    /// - `None` - otherwise.
+    #[must_use]
+    pub fn parity(&self, index: usize) -> Option<&[u8]> {
+        if !self.is_ready() {
+            return None;
+        }
+
+        self.parity.get(index)?.get(..FEC_HEADER_SIZE + self.length)
+    }
+
+    /// Set parity payload of current group to frame. Frame header (device,
+    /// mode, etc.) is expected to be set by caller, header `sequence`
+    /// **MUST** be equal to `sequence` of the last data frame of group.
+    ///
+    /// # Parameters
+    /// - `index` - given parity frame index.
+    /// - `frame` - given frame to set payload to.
+    ///
+    /// # Errors
+    /// - Buffer underflow - if group is not complete or index is invalid.
+    pub fn parity_frame(
+        &self,
+        index: usize,
+        frame: &mut IdtpFrame,
+    ) -> IdtpResult<()> {
+        let payload = self.parity(index).ok_or(IdtpError::BufferUnderflow)?;
+        frame.set_payload_raw(payload, FEC_PAYLOAD_TYPE)
+    }
+}
+
+/// Lost frames decoder of a single device.
+///
+/// # Parameters
+/// - `N` - number of buffered data frames. **SHOULD** be at least twice as
+///   large as group size to tolerate reordering.
+/// - `M` - max number of parity frames per group.
+#[derive(Debug, Clone)]
+pub struct FecDecoder<const N: usize, const M: usize> {
+    /// Ring of received data frames indexed by `sequence mod N`.
+    data: [[u8; FEC_MAX_FRAME_SIZE]; N],
+    /// Sequence number & size of buffered data frames.
+    data_info: [Option<(u32, usize)>; N],
+    /// Parity data of current group.
+    parity: [[u8; FEC_MAX_FRAME_SIZE]; M],
+    /// Parity index of received parity frames.
+    parity_index: [u8; M],
+    /// Number of received parity frames of current group.
+    parity_received: usize,
+    /// Header of current group.
+    group: Option<FecHeader>,
+    /// Number of lost data frames of current group.
+    missing: usize,
+    /// Decoder statistics.
+    stats: FecStats,
+}
+
+impl<const N: usize, const M: usize> FecDecoder<N, M> {
+    /// Construct new `FecDecoder` object.
+    ///
+    /// # Returns
+    /// - New `FecDecoder` object.
+    #[must_use]
+    pub const fn new() -> Self {
+        const {
+            assert!(N > 0, "invalid number of buffered frames");
+            assert!(
+                M > 0 && M <= FEC_MAX_PARITY_FRAMES,
+                "invalid number of parity frames"
+            );
+        }
+
+        Self {
+            data: [[0; FEC_MAX_FRAME_SIZE]; N],
+            data_info: [None; N],
+            parity: [[0; FEC_MAX_FRAME_SIZE]; M],
+            parity_index: [0; M],
+            parity_received: 0,
+            group: None,
+            missing: 0,
+            stats: FecStats {
+                recovered: 0,
+                unrecoverable: 0,
+            },
+        }
+    }
+
+    /// Get decoder statistics.
+    ///
+    /// # Returns
+    /// - Decoder statistics.
+    #[inline]
+    #[must_use]
+    pub const fn stats(&self) -> &FecStats {
+        &self.stats
+    }
+
+    /// Store received data frame.
+    ///
+    /// # Parameters
+    /// - `buffer` - given raw IDTP frame.
+    ///
+    /// # Errors
+    /// - Buffer underflow - if buffer is shorter than header.
+    /// - Buffer overflow - if frame is longer than `FEC_MAX_FRAME_SIZE`.
+    pub fn push_data(&mut self, buffer: &[u8]) -> IdtpResult<()> {
+        let (header, _) = IdtpHeader::ref_from_prefix(buffer)
+            .map_err(|_| IdtpError::BufferUnderflow)?;
+        let sequence = header.sequence;
+        let slot = sequence as usize % N;
+
+        self.data
+            .get_mut(slot)
+            .and_then(|data| data.get_mut(..buffer.len()))
+            .ok_or(IdtpError::BufferOverflow)?
+            .copy_from_slice(buffer);
+
+        if let Some(info) = self.data_info.get_mut(slot) {
+            *info = Some((sequence, buffer.len()));
+        }
+
+        Ok(())
+    }
+
+    /// Store received parity frame & rebuild lost frames of its group if
+    /// enough parity frames were received.
+    ///
+    /// # Parameters
+    /// - `buffer` - given raw IDTP parity frame.
+    /// - `on_recovered` - given closure to call for each rebuilt frame.
+    ///   Rebuilt frame is **NOT** validated.
+    ///
+    /// # Returns
+    /// - Number of rebuilt frames - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow - if buffer is shorter than frame.
+    /// - Buffer overflow - if group is larger than decoder.
+    /// - Parse error - if frame is not a valid parity frame.
+    pub fn push_parity<F>(
+        &mut self,
+        buffer: &[u8],
+        on_recovered: F,
+    ) -> IdtpResult<usize>
+    where
+        F: FnMut(&[u8]),
+    {
+        let (header, rest) = IdtpHeader::ref_from_prefix(buffer)
+            .map_err(|_| IdtpError::BufferUnderflow)?;
+
+        if header.payload_type != FEC_PAYLOAD_TYPE {
+            return Err(IdtpError::ParseError);
+        }
+
+        let payload = rest
+            .get(..usize::from(header.payload_size))
+            .ok_or(IdtpError::BufferUnderflow)?;
+        let (group, parity) = FecHeader::read_from_prefix(payload)
+            .map_err(|_| IdtpError::ParseError)?;
+        let scheme = FecScheme::try_from(group.scheme)?;
+        let data_count = usize::from(group.data_count);
+
+        if !is_valid_group(scheme, data_count, usize::from(group.parity_count))
+            || group.index >= group.parity_count
+        {
+            return Err(IdtpError::ParseError);
+        }
+
+        if data_count > N {
+            return Err(IdtpError::BufferOverflow);
+        }
+
+        let base_sequence = group.base_sequence;
+
+        if self
+            .group
+            .is_none_or(|current| current.base_sequence != base_sequence)
+        {
+            self.stats.unrecoverable += self.missing as u64;
+            self.missing = 0;
+            self.parity_received = 0;
+            self.group = Some(group);
+        }
+
+        if self.parity_received >= M
+            || self
+                .parity_index
+                .get(..self.parity_received)
+                .is_some_and(|received| received.contains(&group.index))
+        {
+            return Ok(0);
+        }
+
+        self.parity
+            .get_mut(self.parity_received)
+            .and_then(|row| row.get_mut(..parity.len()))
+            .ok_or(IdtpError::BufferOverflow)?
+            .copy_from_slice(parity);
+
+        if let Some(row) = self.parity.get_mut(self.parity_received) {
+            row.get_mut(parity.len()..).unwrap_or_default().fill(0);
+        }
+        if let Some(index) = self.parity_index.get_mut(self.parity_received) {
+            *index = group.index;
+        }
+
+        self.parity_received += 1;
+        self.recover(
+            scheme,
+            data_count,
+            base_sequence,
+            parity.len(),
+            on_recovered,
+        )
+    }
+
+    /// Rebuild lost frames of current group.
+    ///
+    /// # Parameters
+    /// - `scheme` - given FEC scheme of group.
+    /// - `data_count` - given number of data frames in group.
+    /// - `base_sequence` - given sequence number of the first group frame.
+    /// - `length` - given parity data size.
+    /// - `on_recovered` - given closure to call for each rebuilt frame.
+    ///
+    /// # Returns
+    /// - Number of rebuilt frames.
+    ///
+    /// # Errors
+    /// - Parse error - if parity frames of group are inconsistent.
+    #[allow(clippy::cast_possible_truncation)]
+    fn recover<F>(
+        &mut self,
+        scheme: FecScheme,
+        data_count: usize,
+        base_sequence: u32,
+        length: usize,
+        mut on_recovered: F,
+    ) -> IdtpResult<usize>
+    where
+        F: FnMut(&[u8]),
+    {
+        let mut lost = [0usize; M];
+        let mut lost_count = 0;
+
+        for column in 0..data_count {
+            let sequence = base_sequence.wrapping_add(column as u32);
+
+            if self.buffered_size(sequence).is_some() {
+                continue;
+            }
+
+            if let Some(slot) = lost.get_mut(lost_count) {
+                *slot = column;
+            }
+            lost_count += 1;
+        }
+
+        self.missing = lost_count;
+
+        if lost_count == 0 || lost_count > self.parity_received {
+            return Ok(0);
+        }
+
+        // Subtract received data frames from copy of parity frames, so it
+        // holds linear combinations of lost frames only. Received parity
+        // frames stay intact if group turns out to be inconsistent.
+        let mut parity = self.parity;
+
+        for column in 0..data_count {
+            let sequence = base_sequence.wrapping_add(column as u32);
+            let Some(size) = self.buffered_size(sequence) else {
+                continue;
+            };
+
+            if size > length {
+                return Err(IdtpError::ParseError);
+            }
+
+            let data = self
+                .data
+                .get(sequence as usize % N)
+                .and_then(|data| data.get(..size))
+                .unwrap_or_default();
+
+            for (row, index) in parity
+                .iter_mut()
+                .zip(self.parity_index)
+                .take(self.parity_received)
+            {
+                mul_add(row, data, coefficient(scheme, index.into(), column));
+            }
+        }
+
+        let mut matrix = [[0u8; M]; M];
+
+        for (row, index) in matrix.iter_mut().zip(self.parity_index) {
+            for (value, column) in row.iter_mut().zip(lost) {
+                *value = coefficient(scheme, index.into(), column);
+            }
+        }
+
+        let inverse =
+            invert(&mut matrix, lost_count).ok_or(IdtpError::ParseError)?;
+
+        for (column, coefficients) in lost.iter().zip(inverse).take(lost_count)
+        {
+            let sequence = base_sequence.wrapping_add(*column as u32);
+            let slot = sequence as usize % N;
+            let Some(data) = self
+                .data
+                .get_mut(slot)
+                .and_then(|data| data.get_mut(..length))
+            else {
+                continue;
+            };
+
+            data.fill(0);
+
+            for (row, coefficient) in
+                parity.iter().zip(coefficients).take(lost_count)
+            {
+                mul_add(
+                    data,
+                    row.get(..length).unwrap_or_default(),
+                    coefficient,
+                );
+            }
+
+            let size = frame_size(data).unwrap_or(length);
+
+            if let Some(info) = self.data_info.get_mut(slot) {
+                *info = Some((sequence, size));
+            }
+
+            on_recovered(data.get(..size).unwrap_or_default());
+        }
+
+        self.stats.recovered += lost_count as u64;
+        self.missing = 0;
+
+        Ok(lost_count)
+    }
+
+    /// Get size of buffered data frame.
+    ///
+    /// # Parameters
+    /// - `sequence` - given frame sequence number.
+    ///
+    /// # Returns
+    /// - Frame size - if frame is buffered.
+    /// - `None` - otherwise.
+    fn buffered_size(&self, sequence: u32) -> Option<usize> {
+        match self.data_info.get(sequence as usize % N)? {
+            Some((buffered, size)) if *buffered == sequence => Some(*size),
+            _ => None,
+        }
+    }
+}
+
+impl<const N: usize, const M: usize> Default for FecDecoder<N, M> {
+    /// Construct default FEC decoder.
+    ///
+    /// # Returns
+    /// - New default FEC decoder.
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Check FEC group parameters.
+///
+/// # Parameters
+/// - `scheme` - given FEC scheme.
+/// - `data_count` - given number of data frames.
+/// - `parity_count` - given number of parity frames.
+///
+/// # Returns
+/// - `true` - if parameters are valid.
+/// - `false` - otherwise.
+const fn is_valid_group(
+    scheme: FecScheme,
+    data_count: usize,
+    parity_count: usize,
+) -> bool {
+    let parity_limit = match scheme {
+        FecScheme::Xor => 1,
+        FecScheme::ReedSolomon => FEC_MAX_PARITY_FRAMES,
+    };
+
+    data_count > 0
+        && data_count <= FEC_MAX_DATA_FRAMES
+        && parity_count > 0
+        && parity_count <= parity_limit
+}
+
+/// Get size of raw IDTP frame from its header.
+///
+/// # Parameters
+/// - `buffer` - given raw IDTP frame padded with zeros.
+///
+/// # Returns
+/// - Frame size - if header is valid & frame fits into buffer.
+/// - `None` - otherwise.
+fn frame_size(buffer: &[u8]) -> Option<usize> {
+    let (header, _) = IdtpHeader::ref_from_prefix(buffer).ok()?;
+    let mode = IdtpMode::try_from(header.mode).ok()?;
+    let size = IDTP_HEADER_SIZE
+        + usize::from(header.payload_size)
+        + IdtpFrame::trailer_size_from(mode);
+
+    (size <= buffer.len()).then_some(size)
+}
+
+/// Get coefficient of data frame in parity frame.
+///
+/// # Parameters
+/// - `scheme` - given FEC scheme.
+/// - `row` - given parity frame index.
+/// - `column` - given data frame index in group.
+///
+/// # Returns
+/// - `GF(2^8)` coefficient.
+#[allow(clippy::cast_possible_truncation)]
+const fn coefficient(scheme: FecScheme, row: usize, column: usize) -> u8 {
+    match scheme {
+        FecScheme::Xor => 1,
+        // Cauchy matrix element 1 / (x_row + y_column), where x & y are
+        // taken from disjoint halves of the field.
+        FecScheme::ReedSolomon => gf_inv((0x80 | row as u8) ^ column as u8),
+    }
+}
+
+/// Build `GF(2^8)` exponent & logarithm tables.
+///
+/// # Returns
+/// - Exponent & logarithm tables.
+#[allow(clippy::indexing_slicing, clippy::cast_possible_truncation)]
+const fn gf_tables() -> ([u8; 512], [u8; 256]) {
+    let mut exp = [0u8; 512];
+    let mut log = [0u8; 256];
+    let mut value: u16 = 1;
+    let mut power = 0;
+
+    while power < 255 {
+        exp[power] = value as u8;
+        exp[power + 255] = value as u8;
+        log[value as usize] = power as u8;
+        value <<= 1;
+
+        if value & 0x100 != 0 {
+            value ^= GF_POLYNOMIAL;
+        }
+
+        power += 1;
+    }
+
+    (exp, log)
+}
+
+/// Multiply `GF(2^8)` elements.
+///
+/// # Parameters
+/// - `a` - given first element.
+/// - `b` - given second element.
+///
+/// # Returns
+/// - Product of elements.
+#[allow(clippy::indexing_slicing)]
+const fn gf_mul(a: u8, b: u8) -> u8 {
+    if a == 0 || b == 0 {
+        return 0;
+    }
+
+    let power = GF_LOG[a as usize] as usize + GF_LOG[b as usize] as usize;
+
+    GF_EXP[power]
+}
+
+/// Invert `GF(2^8)` element.
+///
+/// # Parameters
+/// - `a` - given non-zero element.
+///
+/// # Returns
+/// - Inverse element or zero for zero element.
+#[allow(clippy::indexing_slicing)]
+const fn gf_inv(a: u8) -> u8 {
+    if a == 0 {
+        return 0;
+    }
+
+    GF_EXP[255 - GF_LOG[a as usize] as usize]
+}
+
+/// Multiply region by constant & add it to destination region:
+/// `destination += coefficient * source`. Regions are processed with split
+/// 4-bit product tables, the layout used by byte shuffle SIMD instructions.
+///
+/// # Parameters
+/// - `destination` - given destination region.
+/// - `source` - given source region. Excess bytes are ignored.
+/// - `coefficient` - given `GF(2^8)` coefficient.
+fn mul_add(destination: &mut [u8], source: &[u8], coefficient: u8) {
+    match coefficient {
+        0 => {}
+        1 => {
+            for (output, input) in destination.iter_mut().zip(source) {
+                *output ^= input;
+            }
+        }
+        _ => {
+            let mut low = [0u8; 16];
+            let mut high = [0u8; 16];
+
+            #[allow(clippy::cast_possible_truncation)]
+            for (nibble, (low, high)) in
+                low.iter_mut().zip(high.iter_mut()).enumerate()
+            {
+                *low = gf_mul(coefficient, nibble as u8);
+                *high = gf_mul(coefficient, (nibble as u8) << 4);
+            }
+
+            for (output, input) in destination.iter_mut().zip(source) {
+                let product = low.get(usize::from(input & 0x0F)).unwrap_or(&0)
+                    ^ high.get(usize::from(input >> 4)).unwrap_or(&0);
+                *output ^= product;
+            }
+        }
+    }
+}
+
+/// Invert square matrix over `GF(2^8)` with Gauss-Jordan elimination.
+///
+/// # Parameters
+/// - `matrix` - given matrix. It is destroyed.
+/// - `size` - given number of used rows & columns.
+///
+/// # Returns
+/// - Inverse matrix - if matrix is invertible.
+/// - `None` - otherwise.
+fn invert<const M: usize>(
+    matrix: &mut [[u8; M]; M],
+    size: usize,
+) -> Option<[[u8; M]; M]> {
+    let mut inverse = [[0u8; M]; M];
+
+    for (index, row) in inverse.iter_mut().enumerate().take(size) {
+        *row.get_mut(index)? = 1;
+    }
+
+    for pivot in 0..size {
+        let found = (pivot..size).find(|row| {
+            matrix.get(*row).and_then(|row| row.get(pivot)) != Some(&0)
+        })?;
+
+        matrix.swap(pivot, found);
+        inverse.swap(pivot, found);
+
+        let scale = gf_inv(*matrix.get(pivot)?.get(pivot)?);
+
+        for value in matrix.get_mut(pivot)?.iter_mut().take(size) {
+            *value = gf_mul(*value, scale);
+        }
+        for value in inverse.get_mut(pivot)?.iter_mut().take(size) {
+            *value = gf_mul(*value, scale);
+        }
+
+        let pivot_row = *matrix.get(pivot)?;
+        let pivot_inverse = *inverse.get(pivot)?;
+
+        for row in (0..size).filter(|row| *row != pivot) {
+            let factor = *matrix.get(row)?.get(pivot)?;
+
+            for (value, source) in
+                matrix.get_mut(row)?.iter_mut().zip(pivot_row)
+            {
+                *value ^= gf_mul(factor, source);
+            }
+            for (value, source) in
+                inverse.get_mut(row)?.iter_mut().zip(pivot_inverse)
+            {
+                *value ^= gf_mul(factor, source);
+            }
+        }
+    }
+
+    Some(inverse)
+}
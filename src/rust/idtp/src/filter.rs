@@ -0,0 +1,312 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Header-only fast-reject filter.
+//!
+//! Unwanted frames (foreign devices, unsupported versions, modes or payload
+//! types) are rejected with plain loads of the header fields before any
+//! `CRC`/`HMAC` calculation. Device & payload type allowlists are bitmaps, so
+//! each check is a single load & bit test. Rejections are counted per rule.
+
+use crate::{
+    IDTP_HEADER_SIZE, IDTP_PAYLOAD_MAX_SIZE, IDTP_PREAMBLE, IDTP_VERSION,
+    IdtpFrame, IdtpHeader, IdtpMode,
+};
+use core::ops::RangeInclusive;
+use zerocopy::FromBytes;
+
+/// Number of filter rules.
+pub const FILTER_RULE_COUNT: usize = 7;
+
+/// Number of words in device bitmap.
+const DEVICE_WORDS: usize = (u16::MAX as usize + 1) / 64;
+
+/// Number of words in payload type bitmap.
+const PAYLOAD_TYPE_WORDS: usize = (u8::MAX as usize + 1) / 64;
+
+/// Bitmask of modes defined by IDTP specification.
+const DEFAULT_MODES: u32 = (1 << IdtpMode::Lite as u8)
+    | (1 << IdtpMode::Safety as u8)
+    | (1 << IdtpMode::Secure as u8)
+    | (1 << IdtpMode::SecureFast as u8)
+    | (1 << IdtpMode::Encrypted as u8);
+
+/// Filter rule that rejected frame.
+#[repr(usize)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum FilterRule {
+    /// Buffer is shorter than frame.
+    Size = 0,
+    /// Invalid preamble.
+    Preamble = 1,
+    /// Unsupported protocol version.
+    Version = 2,
+    /// Unsupported operating mode.
+    Mode = 3,
+    /// Payload size out of bounds.
+    PayloadSize = 4,
+    /// Device is not allowed.
+    Device = 5,
+    /// Payload type is not allowed.
+    PayloadType = 6,
+}
+
+/// Header-only frame filter.
+#[derive(Debug, Clone)]
+pub struct FrameFilter {
+    /// Allowed protocol versions.
+    versions: RangeInclusive<u8>,
+    /// Bitmask of allowed modes.
+    modes: u32,
+    /// Allowed payload sizes.
+    payload_sizes: RangeInclusive<u16>,
+    /// Bitmap of allowed devices.
+    devices: [u64; DEVICE_WORDS],
+    /// Bitmap of allowed payload types.
+    payload_types: [u64; PAYLOAD_TYPE_WORDS],
+    /// Number of rejected frames per rule.
+    rejected: [u64; FILTER_RULE_COUNT],
+    /// Number of accepted frames.
+    accepted: u64,
+}
+
+impl FrameFilter {
+    /// Construct new `FrameFilter` object. Filter accepts well-formed
+    /// frames of current protocol major version from all devices.
+    ///
+    /// # Returns
+    /// - New `FrameFilter` object.
+    #[must_use]
+    #[allow(clippy::cast_possible_truncation)]
+    pub const fn new() -> Self {
+        let major = IDTP_VERSION & 0xF0;
+
+        Self {
+            versions: major..=major | 0x0F,
+            modes: DEFAULT_MODES,
+            payload_sizes: 0..=IDTP_PAYLOAD_MAX_SIZE as u16,
+            devices: [u64::MAX; DEVICE_WORDS],
+            payload_types: [u64::MAX; PAYLOAD_TYPE_WORDS],
+            rejected: [0; FILTER_RULE_COUNT],
+            accepted: 0,
+        }
+    }
+
+    /// Set allowed protocol versions.
+    ///
+    /// # Parameters
+    /// - `versions` - given range of versions in format MAJOR.MINOR.
+    pub const fn set_versions(&mut self, versions: RangeInclusive<u8>) {
+        self.versions = versions;
+    }
+
+    /// Set allowed operating modes.
+    ///
+    /// # Parameters
+    /// - `modes` - given allowed modes.
+    pub fn set_modes(&mut self, modes: &[IdtpMode]) {
+        self.modes =
+            modes.iter().fold(0, |mask, mode| mask | (1 << *mode as u8));
+    }
+
+    /// Set allowed payload sizes.
+    ///
+    /// # Parameters
+    /// - `sizes` - given range of payload sizes in bytes.
+    pub const fn set_payload_sizes(&mut self, sizes: RangeInclusive<u16>) {
+        self.payload_sizes = sizes;
+    }
+
+    /// Allow or deny all devices.
+    ///
+    /// # Parameters
+    /// - `allow` - given flag whether devices are allowed.
+    pub fn set_all_devices(&mut self, allow: bool) {
+        self.devices.fill(if allow { u64::MAX } else { 0 });
+    }
+
+    /// Allow or deny device.
+    ///
+    /// # Parameters
+    /// - `device_id` - given device ID.
+    /// - `allow` - given flag whether device is allowed.
+    pub fn set_device(&mut self, device_id: u16, allow: bool) {
+        set_bit(&mut self.devices, usize::from(device_id), allow);
+    }
+
+    /// Allow or deny all payload types.
+    ///
+    /// # Parameters
+    /// - `allow` - given flag whether payload types are allowed.
+    pub fn set_all_payload_types(&mut self, allow: bool) {
+        self.payload_types.fill(if allow { u64::MAX } else { 0 });
+    }
+
+    /// Allow or deny payload type.
+    ///
+    /// # Parameters
+    /// - `payload_type` - given payload type.
+    /// - `allow` - given flag whether payload type is allowed.
+    pub fn set_payload_type(&mut self, payload_type: u8, allow: bool) {
+        set_bit(&mut self.payload_types, usize::from(payload_type), allow);
+    }
+
+    /// Check raw IDTP frame header. Integrity is not checked.
+    ///
+    /// # Parameters
+    /// - `buffer` - given raw IDTP frame.
+    ///
+    /// # Returns
+    /// - Frame header - if frame is accepted.
+    /// - Rule that rejected frame - otherwise.
+    ///
+    /// # Errors
+    /// - Rule that rejected frame.
+    pub fn check<'a>(
+        &mut self,
+        buffer: &'a [u8],
+    ) -> Result<&'a IdtpHeader, FilterRule> {
+        match self.evaluate(buffer) {
+            Ok(header) => {
+                self.accepted += 1;
+                Ok(header)
+            }
+            Err(rule) => {
+                if let Some(counter) = self.rejected.get_mut(rule as usize) {
+                    *counter += 1;
+                }
+                Err(rule)
+            }
+        }
+    }
+
+    /// Get number of frames rejected by rule.
+    ///
+    /// # Parameters
+    /// - `rule` - given filter rule.
+    ///
+    /// # Returns
+    /// - Number of rejected frames.
+    #[must_use]
+    pub fn rejected(&self, rule: FilterRule) -> u64 {
+        self.rejected
+            .get(rule as usize)
+            .copied()
+            .unwrap_or_default()
+    }
+
+    /// Get number of accepted frames.
+    ///
+    /// # Returns
+    /// - Number of accepted frames.
+    #[inline]
+    #[must_use]
+    pub const fn accepted(&self) -> u64 {
+        self.accepted
+    }
+
+    /// Reset rejection & acceptance counters.
+    pub const fn reset_counters(&mut self) {
+        self.rejected = [0; FILTER_RULE_COUNT];
+        self.accepted = 0;
+    }
+
+    /// Evaluate filter rules.
+    ///
+    /// # Parameters
+    /// - `buffer` - given raw IDTP frame.
+    ///
+    /// # Returns
+    /// - Frame header - if frame is accepted.
+    /// - Rule that rejected frame - otherwise.
+    ///
+    /// # Errors
+    /// - Rule that rejected frame.
+    fn evaluate<'a>(
+        &self,
+        buffer: &'a [u8],
+    ) -> Result<&'a IdtpHeader, FilterRule> {
+        let (header, _) = IdtpHeader::ref_from_prefix(buffer)
+            .map_err(|_| FilterRule::Size)?;
+
+        if header.preamble != IDTP_PREAMBLE {
+            return Err(FilterRule::Preamble);
+        }
+
+        if !self.versions.contains(&header.version) {
+            return Err(FilterRule::Version);
+        }
+
+        let mode = IdtpMode::try_from(header.mode)
+            .ok()
+            .filter(|mode| self.modes & (1 << *mode as u8) != 0)
+            .ok_or(FilterRule::Mode)?;
+
+        let payload_size = header.payload_size;
+
+        if !self.payload_sizes.contains(&payload_size) {
+            return Err(FilterRule::PayloadSize);
+        }
+
+        if !test_bit(&self.devices, usize::from(header.device_id)) {
+            return Err(FilterRule::Device);
+        }
+
+        if !test_bit(&self.payload_types, usize::from(header.payload_type)) {
+            return Err(FilterRule::PayloadType);
+        }
+
+        let frame_size = IDTP_HEADER_SIZE
+            + usize::from(payload_size)
+            + IdtpFrame::trailer_size_from(mode);
+
+        if buffer.len() < frame_size {
+            return Err(FilterRule::Size);
+        }
+
+        Ok(header)
+    }
+}
+
+impl Default for FrameFilter {
+    /// Construct default frame filter.
+    ///
+    /// # Returns
+    /// - New default frame filter.
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Test bit of bitmap.
+///
+/// # Parameters
+/// - `bitmap` - given bitmap to handle.
+/// - `index` - given bit index.
+///
+/// # Returns
+/// - `true` - if bit is set.
+/// - `false` - otherwise.
+#[inline]
+fn test_bit(bitmap: &[u64], index: usize) -> bool {
+    bitmap
+        .get(index / 64)
+        .is_some_and(|word| word & (1 << (index % 64)) != 0)
+}
+
+/// Set or clear bit of bitmap.
+///
+/// # Parameters
+/// - `bitmap` - given bitmap to handle.
+/// - `index` - given bit index.
+/// - `value` - given bit value.
+#[inline]
+fn set_bit(bitmap: &mut [u64], index: usize, value: bool) {
+    if let Some(word) = bitmap.get_mut(index / 64) {
+        if value {
+            *word |= 1 << (index % 64);
+        } else {
+            *word &= !(1 << (index % 64));
+        }
+    }
+}
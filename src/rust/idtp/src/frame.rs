@@ -21,6 +21,88 @@ pub const IDTP_FRAME_MIN_SIZE: usize = IDTP_HEADER_SIZE;
 /// IDTP network packet payload max size in bytes.
 pub const IDTP_PAYLOAD_MAX_SIZE: usize = 972;
 
+/// Trait for incremental frame trailer calculation. Used for streaming frames
+/// without packing them into intermediate buffer.
+pub trait TrailerDigest {
+    /// Update trailer calculation with frame data.
+    ///
+    /// # Parameters
+    /// - `data` - given data to handle.
+    ///
+    /// # Errors
+    /// - Implementation-specific.
+    fn update(&mut self, data: &[u8]) -> IdtpResult<()>;
+
+    /// Finalize trailer calculation.
+    ///
+    /// # Parameters
+    /// - `trailer` - given buffer to store frame trailer.
+    ///
+    /// # Errors
+    /// - Implementation-specific.
+    fn finalize(self, trailer: &mut [u8]) -> IdtpResult<()>;
+
+    /// Finalize trailer calculation & compare it with received trailer in
+    /// constant time. Implementations **SHOULD** override it if underlying
+    /// `MAC` can be verified without storing computed value.
+    ///
+    /// # Parameters
+    /// - `trailer` - given received frame trailer.
+    ///
+    /// # Returns
+    /// - `Ok` - if trailers are equal.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Invalid CRC - if `CRC-32` trailer differs.
+    /// - Invalid HMAC - if `MAC` trailer differs.
+    /// - Implementation-specific.
+    fn verify(self, trailer: &[u8]) -> IdtpResult<()>
+    where
+        Self: Sized,
+    {
+        let mut computed = [0u8; 32];
+        let computed = computed
+            .get_mut(..trailer.len())
+            .ok_or(IdtpError::BufferOverflow)?;
+
+        self.finalize(computed)?;
+
+        if trailer_eq(computed, trailer) {
+            Ok(())
+        } else if trailer.len() == 4 {
+            Err(IdtpError::InvalidCrc)
+        } else {
+            Err(IdtpError::InvalidHMac)
+        }
+    }
+}
+
+/// Compare frame trailers in constant time: running time depends on trailer
+/// size only, not on position of the first differing byte.
+///
+/// # Parameters
+/// - `computed` - given computed trailer.
+/// - `received` - given received trailer.
+///
+/// # Returns
+/// - `true` - if trailers are equal.
+/// - `false` - otherwise.
+#[must_use]
+pub fn trailer_eq(computed: &[u8], received: &[u8]) -> bool {
+    if computed.len() != received.len() {
+        return false;
+    }
+
+    let diff = computed
+        .iter()
+        .zip(received)
+        .fold(0u8, |diff, (a, b)| diff | (a ^ b));
+
+    // Keep compiler from turning the fold into early-exit comparison.
+    core::hint::black_box(diff) == 0
+}
+
 /// Inertial Measurement Unit Data Transfer Protocol frame struct.
 #[derive(Debug, Clone, Copy)]
 pub struct IdtpFrame {
@@ -192,7 +274,8 @@ impl IdtpFrame {
     pub const fn trailer_size_from(mode: IdtpMode) -> usize {
         match mode {
             IdtpMode::Safety => 4,
-            IdtpMode::Secure => 32,
+            IdtpMode::Secure | IdtpMode::SecureFast => 32,
+            IdtpMode::Encrypted => 16,
             IdtpMode::Lite => 0,
         }
     }
@@ -209,10 +292,11 @@ impl IdtpFrame {
     }
 
     /// Pack into raw IDTP frame. `CRC` & `HMAC` calculation is software-based.
+    /// `IDTP-E` frames are sealed with `ChaCha20-Poly1305`.
     ///
     /// # Parameters
     /// - `buffer` - given buffer to store IDTP frame bytes.
-    /// - `key` - given `HMAC` key.
+    /// - `key` - given `HMAC`, `BLAKE2s` or `ChaCha20-Poly1305` key.
     ///
     /// # Returns
     /// - Frame size in bytes - in case of success.
@@ -226,11 +310,21 @@ impl IdtpFrame {
         buffer: &mut [u8],
         key: Option<&[u8]>,
     ) -> IdtpResult<usize> {
+        let mode = IdtpMode::try_from(self.header.mode).ok();
+
+        if mode == Some(IdtpMode::Encrypted) {
+            return self.seal_with(
+                buffer,
+                crypto::sw_crc8,
+                crypto::sw_seal_closure(key),
+            );
+        }
+
         self.pack_with(
             buffer,
             crypto::sw_crc8,
             crypto::sw_crc32,
-            crypto::sw_hmac_closure(key),
+            crypto::sw_mac_closure(mode, key),
         )
     }
 
@@ -241,8 +335,8 @@ impl IdtpFrame {
     /// - `buffer` - given buffer to store IDTP frame bytes.
     /// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
     /// - `calc_crc32` - given closure with custom `CRC-32` calculation logic.
-    /// - `calc_hmac` - given closure with custom `HMAC-SHA256`
-    ///   calculation logic.
+    /// - `calc_hmac` - given closure with custom `HMAC-SHA256` (`IDTP-SEC`)
+    ///   or keyed `BLAKE2s-256` (`IDTP-SF`) calculation logic.
     ///
     /// # Returns
     /// - Frame size in bytes - in case of success.
@@ -250,6 +344,7 @@ impl IdtpFrame {
     ///
     /// # Errors
     /// - Buffer underflow.
+    /// - Parse error - for `IDTP-E` frame, use `seal_with` instead.
     pub fn pack_with<C8, C32, H>(
         &self,
         buffer: &mut [u8],
@@ -263,6 +358,103 @@ impl IdtpFrame {
         H: FnOnce(&[u8]) -> IdtpResult<[u8; 32]>,
     {
         let trailer_size = self.trailer_size();
+        let data_size = self.pack_data(buffer, calc_crc8)?;
+
+        // Packing frame trailer.
+        let mode = IdtpMode::try_from(self.header.mode)
+            .map_err(|_| IdtpError::ParseError)?;
+
+        let frame_size = data_size + trailer_size;
+        let data =
+            &buffer.get(..data_size).ok_or(IdtpError::BufferUnderflow)?;
+
+        match mode {
+            IdtpMode::Safety => {
+                let crc32 = calc_crc32(data)?;
+                buffer
+                    .get_mut(data_size..frame_size)
+                    .ok_or(IdtpError::BufferUnderflow)?
+                    .copy_from_slice(&crc32.to_le_bytes());
+            }
+            IdtpMode::Secure | IdtpMode::SecureFast => {
+                let hmac = calc_hmac(data)?;
+                buffer
+                    .get_mut(data_size..frame_size)
+                    .ok_or(IdtpError::BufferUnderflow)?
+                    .copy_from_slice(&hmac);
+            }
+            // Payload must be encrypted, use `seal_with`.
+            IdtpMode::Encrypted => return Err(IdtpError::ParseError),
+            IdtpMode::Lite => {}
+        }
+
+        Ok(frame_size)
+    }
+
+    /// Pack into raw `IDTP-E` frame with custom `CRC` and `ChaCha20-Poly1305`
+    /// calculation. Payload is encrypted in place in `buffer`.
+    ///
+    /// # Parameters
+    /// - `buffer` - given buffer to store IDTP frame bytes.
+    /// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+    /// - `seal` - given closure that encrypts payload in place & returns
+    ///   authentication tag over header & ciphertext.
+    ///
+    /// # Returns
+    /// - Frame size in bytes - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Parse error - if frame mode is not `IDTP-E`.
+    pub fn seal_with<C8, S>(
+        &self,
+        buffer: &mut [u8],
+        calc_crc8: C8,
+        seal: S,
+    ) -> IdtpResult<usize>
+    where
+        C8: FnOnce(&[u8]) -> IdtpResult<u8>,
+        S: FnOnce(&[u8], &mut [u8]) -> IdtpResult<[u8; 16]>,
+    {
+        if IdtpMode::try_from(self.header.mode)? != IdtpMode::Encrypted {
+            return Err(IdtpError::ParseError);
+        }
+
+        let data_size = self.pack_data(buffer, calc_crc8)?;
+        let frame_size = data_size + self.trailer_size();
+
+        let (data, trailer) = buffer
+            .get_mut(..frame_size)
+            .ok_or(IdtpError::BufferUnderflow)?
+            .split_at_mut(data_size);
+        let (header, payload) = data.split_at_mut(IDTP_HEADER_SIZE);
+
+        trailer.copy_from_slice(&seal(header, payload)?);
+
+        Ok(frame_size)
+    }
+
+    /// Pack IDTP header & payload.
+    ///
+    /// # Parameters
+    /// - `buffer` - given buffer to store IDTP frame bytes.
+    /// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+    ///
+    /// # Returns
+    /// - Size of header & payload in bytes - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    fn pack_data<C8>(
+        &self,
+        buffer: &mut [u8],
+        calc_crc8: C8,
+    ) -> IdtpResult<usize>
+    where
+        C8: FnOnce(&[u8]) -> IdtpResult<u8>,
+    {
         let expected_size = self.size();
 
         if buffer.len() < expected_size {
@@ -292,42 +484,16 @@ impl IdtpFrame {
             .ok_or(IdtpError::BufferUnderflow)?
             .copy_from_slice(payload);
 
-        // Packing frame trailer.
-        let data_size = header_size + payload_size;
-        let mode = IdtpMode::try_from(self.header.mode)
-            .map_err(|_| IdtpError::ParseError)?;
-
-        let frame_size = data_size + trailer_size;
-        let data =
-            &buffer.get(..data_size).ok_or(IdtpError::BufferUnderflow)?;
-
-        match mode {
-            IdtpMode::Safety => {
-                let crc32 = calc_crc32(data)?;
-                buffer
-                    .get_mut(data_size..frame_size)
-                    .ok_or(IdtpError::BufferUnderflow)?
-                    .copy_from_slice(&crc32.to_le_bytes());
-            }
-            IdtpMode::Secure => {
-                let hmac = calc_hmac(data)?;
-                buffer
-                    .get_mut(data_size..frame_size)
-                    .ok_or(IdtpError::BufferUnderflow)?
-                    .copy_from_slice(&hmac);
-            }
-            IdtpMode::Lite => {}
-        }
-
-        Ok(frame_size)
+        Ok(header_size + payload_size)
     }
 
     /// Validate IDTP frame integrity. `CRC` & `HMAC` calculation
-    /// is software-based.
+    /// is software-based. `IDTP-E` frames are authenticated, but not
+    /// decrypted, use `open` for this.
     ///
     /// # Parameters
     /// - `buffer` - given IDTP frame bytes.
-    /// - `key` - given `HMAC` key.
+    /// - `key` - given `HMAC`, `BLAKE2s` or `ChaCha20-Poly1305` key.
     ///
     /// # Returns
     /// - `Ok` - in case of success.
@@ -337,22 +503,37 @@ impl IdtpFrame {
     /// - Buffer underflow.
     #[cfg(feature = "software_impl")]
     pub fn validate(buffer: &[u8], key: Option<&[u8]>) -> IdtpResult<()> {
-        Self::validate_with(
-            buffer,
-            crypto::sw_crc8,
-            crypto::sw_crc32,
-            crypto::sw_hmac_closure(key),
-        )
+        let mode = buffer
+            .get(17)
+            .and_then(|mode| IdtpMode::try_from(*mode).ok());
+
+        if mode == Some(IdtpMode::Encrypted) {
+            return Self::validate_with(
+                buffer,
+                crypto::sw_crc8,
+                crypto::sw_crc32,
+                crypto::sw_mac_closure(mode, key),
+            );
+        }
+
+        Self::verify_with(buffer, crypto::sw_crc8, |mode| {
+            crypto::SwTrailerDigest::new(mode, key)
+        })
     }
 
     /// Validate IDTP frame integrity with custom `CRC` and `HMAC` calculation.
     /// Recommended to use if hardware acceleration for `CRC`/`HMAC` available.
+    /// `MAC` trailers are compared in constant time. Computed trailer is
+    /// returned by closure & copied before comparison, use `verify_with` with
+    /// `TrailerDigest` to finalize it directly into comparison.
     ///
     /// # Parameters
     /// - `buffer` - given IDTP frame bytes.
     /// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
     /// - `calc_crc32` - given closure with custom `CRC-32` calculation logic.
-    /// - `calc_hmac` - given closure with custom `HMAC-SHA256` calculation logic.
+    /// - `calc_hmac` - given closure with custom `HMAC-SHA256` (`IDTP-SEC`),
+    ///   keyed `BLAKE2s-256` (`IDTP-SF`) or `Poly1305` tag in the first
+    ///   16 bytes (`IDTP-E`) calculation logic.
     ///
     /// # Returns
     /// - `Ok` - in case of success.
@@ -371,9 +552,162 @@ impl IdtpFrame {
         C32: FnOnce(&[u8]) -> IdtpResult<u32>,
         H: FnOnce(&[u8]) -> IdtpResult<[u8; 32]>,
     {
-        let header_size = IDTP_HEADER_SIZE;
+        let (mode, data_size, frame_size) =
+            Self::check_header(buffer, calc_crc8)?;
+        let data =
+            &buffer.get(..data_size).ok_or(IdtpError::BufferUnderflow)?;
+        let received = buffer
+            .get(data_size..frame_size)
+            .ok_or(IdtpError::BufferUnderflow)?;
 
-        if buffer.len() < header_size {
+        // Checking frame trailer.
+        match mode {
+            IdtpMode::Lite => {}
+            IdtpMode::Safety => {
+                let computed_crc32 = calc_crc32(data)?;
+
+                if computed_crc32.to_le_bytes() != received {
+                    return Err(IdtpError::InvalidCrc);
+                }
+            }
+            IdtpMode::Secure | IdtpMode::SecureFast | IdtpMode::Encrypted => {
+                let computed_hmac = calc_hmac(data)?;
+                let computed = computed_hmac
+                    .get(..received.len())
+                    .ok_or(IdtpError::BufferUnderflow)?;
+
+                if !trailer_eq(computed, received) {
+                    return Err(IdtpError::InvalidHMac);
+                }
+            }
+        }
+
+        Ok(())
+    }
+
+    /// Validate IDTP frame integrity with custom incremental trailer
+    /// calculation. Computed trailer is finalized directly into constant-time
+    /// comparison with received one (see `TrailerDigest::verify`).
+    ///
+    /// # Parameters
+    /// - `buffer` - given IDTP frame bytes.
+    /// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+    /// - `new_digest` - given closure that constructs trailer digest for
+    ///   frame mode. It is not called for `IDTP-L` frames.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Invalid CRC / HMAC.
+    /// - Digest-specific.
+    pub fn verify_with<C8, N, D>(
+        buffer: &[u8],
+        calc_crc8: C8,
+        new_digest: N,
+    ) -> IdtpResult<()>
+    where
+        C8: FnOnce(&[u8]) -> IdtpResult<u8>,
+        N: FnOnce(IdtpMode) -> IdtpResult<D>,
+        D: TrailerDigest,
+    {
+        let (mode, data_size, frame_size) =
+            Self::check_header(buffer, calc_crc8)?;
+
+        if mode == IdtpMode::Lite {
+            return Ok(());
+        }
+
+        let data = buffer.get(..data_size).ok_or(IdtpError::BufferUnderflow)?;
+        let received = buffer
+            .get(data_size..frame_size)
+            .ok_or(IdtpError::BufferUnderflow)?;
+
+        let mut digest = new_digest(mode)?;
+        digest.update(data)?;
+        digest.verify(received)
+    }
+
+    /// Validate batch of frames & accumulate results into bitmask without
+    /// branching on them. Bit `i` is set if frame `i` is valid.
+    ///
+    /// # Parameters
+    /// - `frames` - given raw IDTP frames, at most 64.
+    /// - `validate` - given closure that validates single frame
+    ///   (e.g. wrapper around `IdtpFrame::verify_with`).
+    ///
+    /// # Returns
+    /// - Bitmask of valid frames - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if there are more than 64 frames.
+    pub fn validate_batch_with<B, F>(
+        frames: &[B],
+        mut validate: F,
+    ) -> IdtpResult<u64>
+    where
+        B: AsRef<[u8]>,
+        F: FnMut(&[u8]) -> IdtpResult<()>,
+    {
+        if frames.len() > u64::BITS as usize {
+            return Err(IdtpError::BufferOverflow);
+        }
+
+        Ok(frames.iter().enumerate().fold(0, |mask, (index, frame)| {
+            mask | (u64::from(validate(frame.as_ref()).is_ok()) << index)
+        }))
+    }
+
+    /// Validate batch of frames & accumulate results into bitmask.
+    /// `CRC` & `HMAC` calculation is software-based.
+    ///
+    /// # Parameters
+    /// - `frames` - given raw IDTP frames, at most 64.
+    /// - `key` - given `HMAC`, `BLAKE2s` or `ChaCha20-Poly1305` key.
+    ///
+    /// # Returns
+    /// - Bitmask of valid frames - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if there are more than 64 frames.
+    #[cfg(feature = "software_impl")]
+    pub fn validate_batch<B>(
+        frames: &[B],
+        key: Option<&[u8]>,
+    ) -> IdtpResult<u64>
+    where
+        B: AsRef<[u8]>,
+    {
+        Self::validate_batch_with(frames, |frame| Self::validate(frame, key))
+    }
+
+    /// Check `CRC-8` of IDTP header & frame size.
+    ///
+    /// # Parameters
+    /// - `buffer` - given IDTP frame bytes.
+    /// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+    ///
+    /// # Returns
+    /// - Frame mode, size of header & payload and frame size in bytes -
+    ///   in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Invalid CRC.
+    /// - Parse error.
+    fn check_header<C8>(
+        buffer: &[u8],
+        calc_crc8: C8,
+    ) -> IdtpResult<(IdtpMode, usize, usize)>
+    where
+        C8: FnOnce(&[u8]) -> IdtpResult<u8>,
+    {
+        if buffer.len() < IDTP_HEADER_SIZE {
             return Err(IdtpError::BufferUnderflow);
         }
 
@@ -391,53 +725,81 @@ impl IdtpFrame {
             .map_err(|_| IdtpError::ParseError)?
             .0;
 
-        let payload_size = header.payload_size as usize;
-
         let mode = IdtpMode::try_from(header.mode)
             .map_err(|_| IdtpError::ParseError)?;
-        let trailer_size = Self::trailer_size_from(mode);
 
-        let data_size = header_size + payload_size;
-        let expected_size = data_size + trailer_size;
+        let data_size = IDTP_HEADER_SIZE + header.payload_size as usize;
+        let frame_size = data_size + Self::trailer_size_from(mode);
 
-        if buffer.len() < expected_size {
+        if buffer.len() < frame_size {
             return Err(IdtpError::BufferUnderflow);
         }
 
-        let frame_size = data_size + trailer_size;
-        let data =
-            &buffer.get(..data_size).ok_or(IdtpError::BufferUnderflow)?;
+        Ok((mode, data_size, frame_size))
+    }
 
-        // Checking frame trailer.
-        match mode {
-            IdtpMode::Lite => {}
-            IdtpMode::Safety => {
-                let computed_crc32 = calc_crc32(data)?;
-                let received_crc32 = u32::from_le_bytes(
-                    buffer
-                        .get(data_size..frame_size)
-                        .ok_or(IdtpError::BufferUnderflow)?
-                        .try_into()
-                        .map_err(|_| IdtpError::ParseError)?,
-                );
-
-                if computed_crc32 != received_crc32 {
-                    return Err(IdtpError::InvalidCrc);
-                }
-            }
-            IdtpMode::Secure => {
-                let computed_hmac = calc_hmac(data)?;
-                let received_hmac = buffer
-                    .get(data_size..frame_size)
-                    .ok_or(IdtpError::BufferUnderflow)?;
+    /// Authenticate & decrypt raw `IDTP-E` frame in place.
+    /// `CRC` & `ChaCha20-Poly1305` calculation is software-based.
+    ///
+    /// # Parameters
+    /// - `buffer` - given IDTP frame bytes.
+    /// - `key` - given `ChaCha20-Poly1305` key.
+    ///
+    /// # Returns
+    /// - Frame size in bytes - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Invalid CRC / HMAC.
+    #[cfg(feature = "software_impl")]
+    pub fn open(buffer: &mut [u8], key: Option<&[u8]>) -> IdtpResult<usize> {
+        Self::open_with(buffer, crypto::sw_crc8, crypto::sw_open_closure(key))
+    }
 
-                if computed_hmac != received_hmac {
-                    return Err(IdtpError::InvalidHMac);
-                }
-            }
+    /// Authenticate & decrypt raw `IDTP-E` frame in place with custom `CRC`
+    /// and `ChaCha20-Poly1305` calculation. Payload is left encrypted if
+    /// authentication fails.
+    ///
+    /// # Parameters
+    /// - `buffer` - given IDTP frame bytes.
+    /// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+    /// - `open` - given closure that checks authentication tag over header &
+    ///   ciphertext & decrypts payload in place.
+    ///
+    /// # Returns
+    /// - Frame size in bytes - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Invalid CRC / HMAC.
+    /// - Parse error - if frame mode is not `IDTP-E`.
+    pub fn open_with<C8, O>(
+        buffer: &mut [u8],
+        calc_crc8: C8,
+        open: O,
+    ) -> IdtpResult<usize>
+    where
+        C8: FnOnce(&[u8]) -> IdtpResult<u8>,
+        O: FnOnce(&[u8], &mut [u8], &[u8]) -> IdtpResult<()>,
+    {
+        let (mode, data_size, frame_size) =
+            Self::check_header(buffer, calc_crc8)?;
+
+        if mode != IdtpMode::Encrypted {
+            return Err(IdtpError::ParseError);
         }
 
-        Ok(())
+        let (data, tag) = buffer
+            .get_mut(..frame_size)
+            .ok_or(IdtpError::BufferUnderflow)?
+            .split_at_mut(data_size);
+        let (header, payload) = data.split_at_mut(IDTP_HEADER_SIZE);
+
+        open(header, payload, tag)?;
+
+        Ok(frame_size)
     }
 }
 
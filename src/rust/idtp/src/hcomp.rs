@@ -0,0 +1,412 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Header compression for slow serial links.
+//!
+//! Within a stream `preamble`, `device_id`, `payload_size`, `version`, `mode`
+//! & `payload_type` rarely change, while `sequence` & `timestamp` grow by
+//! predictable amounts. Similar to ROHC, compressor & decompressor keep a
+//! shared context per stream & the header is replaced with a context id plus
+//! small deltas:
+//!
+//! - `IR` packet - full header, (re)initialises context. Sent for the first
+//!   frame, on change of any static field & every `refresh` frames.
+//! - `CO_MIN` packet - only header `CRC-8`, when `sequence` grows by 1 &
+//!   `timestamp` grows by the same amount as in the previous frame.
+//! - `CO` packet - header `CRC-8` plus varint deltas of `sequence` &
+//!   `timestamp`.
+//!
+//! Payload & trailer are sent unchanged, so reconstructed header is verified
+//! by regular frame validation. Header compression is a link-local encoding
+//! negotiated out of band, it is not a protocol operating mode.
+
+use crate::{
+    IDTP_HEADER_SIZE, IdtpError, IdtpHeader, IdtpResult,
+    varint::{read_varint, unzigzag, write_varint, zigzag},
+};
+use zerocopy::{FromBytes, IntoBytes};
+
+/// Max number of contexts multiplexed on a single link.
+pub const HC_MAX_CONTEXTS: usize = 16;
+
+/// Size of `IR` packet header in bytes.
+pub const HC_IR_HEADER_SIZE: usize = 1 + IDTP_HEADER_SIZE;
+
+/// Size of `CO_MIN` packet header in bytes.
+pub const HC_CO_MIN_HEADER_SIZE: usize = 2;
+
+/// Max size of compressed packet header in bytes.
+pub const HC_MAX_HEADER_SIZE: usize = HC_IR_HEADER_SIZE;
+
+/// Compressed packet type.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(u8)]
+pub enum PacketType {
+    /// Full header.
+    Ir = 0x00,
+    /// Header `CRC-8` only.
+    CoMin = 0x01,
+    /// Header `CRC-8` plus `sequence` & `timestamp` deltas.
+    Co = 0x02,
+}
+
+impl TryFrom<u8> for PacketType {
+    /// The type returned in the event of a conversion error.
+    type Error = IdtpError;
+
+    /// Try to convert byte to packet type.
+    ///
+    /// # Parameters
+    /// - `value` - given byte to convert.
+    ///
+    /// # Returns
+    /// - Packet type from byte - in case of success.
+    /// - Error otherwise.
+    ///
+    /// # Errors
+    /// - Parse Error.
+    fn try_from(value: u8) -> Result<Self, Self::Error> {
+        match value {
+            0x00 => Ok(Self::Ir),
+            0x01 => Ok(Self::CoMin),
+            0x02 => Ok(Self::Co),
+            _ => Err(Self::Error::ParseError),
+        }
+    }
+}
+
+/// Shared compression context.
+#[derive(Debug, Clone, Copy)]
+struct Context {
+    /// Last header.
+    header: IdtpHeader,
+    /// Last `timestamp` delta.
+    stride: u32,
+}
+
+impl Context {
+    /// Construct new `Context` object from `IR` header.
+    ///
+    /// # Parameters
+    /// - `header` - given full header.
+    ///
+    /// # Returns
+    /// - New `Context` object.
+    const fn new(header: IdtpHeader) -> Self {
+        Self { header, stride: 0 }
+    }
+
+    /// Check whether static fields of header match context.
+    ///
+    /// # Parameters
+    /// - `header` - given header to check.
+    ///
+    /// # Returns
+    /// - `true` - if header can be compressed against context.
+    /// - `false` - otherwise.
+    fn matches(&self, header: &IdtpHeader) -> bool {
+        let candidate = IdtpHeader {
+            timestamp: self.header.timestamp,
+            sequence: self.header.sequence,
+            crc: self.header.crc,
+            ..*header
+        };
+
+        candidate.as_bytes() == self.header.as_bytes()
+    }
+
+    /// Advance context to the next header.
+    ///
+    /// # Parameters
+    /// - `sequence` - given `sequence` of the next header.
+    /// - `timestamp` - given `timestamp` of the next header.
+    /// - `crc` - given `CRC-8` of the next header.
+    const fn advance(&mut self, sequence: u32, timestamp: u32, crc: u8) {
+        self.stride = timestamp.wrapping_sub(self.header.timestamp);
+        self.header.sequence = sequence;
+        self.header.timestamp = timestamp;
+        self.header.crc = crc;
+    }
+}
+
+/// Header compressor of a single stream.
+#[derive(Debug, Clone)]
+pub struct HeaderCompressor {
+    /// Context id.
+    context_id: u8,
+    /// Number of frames between `IR` packets.
+    refresh: u16,
+    /// Number of frames since the last `IR` packet.
+    since_refresh: u16,
+    /// Compression context.
+    context: Option<Context>,
+}
+
+impl HeaderCompressor {
+    /// Construct new `HeaderCompressor` object.
+    ///
+    /// # Parameters
+    /// - `context_id` - given context id, less than `HC_MAX_CONTEXTS`.
+    /// - `refresh` - given number of frames between `IR` packets.
+    ///
+    /// # Returns
+    /// - New `HeaderCompressor` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Parse error - if context id is out of range or `refresh` is zero.
+    pub const fn new(context_id: u8, refresh: u16) -> IdtpResult<Self> {
+        if context_id as usize >= HC_MAX_CONTEXTS || refresh == 0 {
+            return Err(IdtpError::ParseError);
+        }
+
+        Ok(Self {
+            context_id,
+            refresh,
+            since_refresh: 0,
+            context: None,
+        })
+    }
+
+    /// Force `IR` packet for the next frame, e.g. on decompressor request.
+    pub const fn reset(&mut self) {
+        self.context = None;
+    }
+
+    /// Compress frame header.
+    ///
+    /// # Parameters
+    /// - `frame` - given IDTP frame bytes.
+    /// - `output` - given buffer to store compressed packet.
+    ///
+    /// # Returns
+    /// - Size of compressed packet in bytes - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow - if frame is shorter than header.
+    /// - Buffer overflow - if output buffer is too short.
+    pub fn compress(
+        &mut self,
+        frame: &[u8],
+        output: &mut [u8],
+    ) -> IdtpResult<usize> {
+        let (header, rest) = IdtpHeader::read_from_prefix(frame)
+            .map_err(|_| IdtpError::BufferUnderflow)?;
+        let refresh_due = self.since_refresh + 1 >= self.refresh;
+
+        // Context changes are committed only after whole packet is written.
+        let (size, context, since_refresh) = match self.context {
+            Some(mut context) if !refresh_due && context.matches(&header) => {
+                let sequence_delta =
+                    header.sequence.wrapping_sub(context.header.sequence);
+                let stride =
+                    header.timestamp.wrapping_sub(context.header.timestamp);
+
+                let size = if sequence_delta == 1 && stride == context.stride {
+                    write_prefix(output, PacketType::CoMin, self.context_id)?;
+                    write_byte(output, 1, header.crc)?;
+                    HC_CO_MIN_HEADER_SIZE
+                } else {
+                    #[allow(clippy::cast_possible_wrap)]
+                    let stride_delta =
+                        stride.wrapping_sub(context.stride) as i32;
+                    let mut position = HC_CO_MIN_HEADER_SIZE;
+
+                    write_prefix(output, PacketType::Co, self.context_id)?;
+                    write_byte(output, 1, header.crc)?;
+                    write_varint(output, &mut position, sequence_delta)?;
+                    write_varint(output, &mut position, zigzag(stride_delta))?;
+                    position
+                };
+
+                context.advance(header.sequence, header.timestamp, header.crc);
+                (size, context, self.since_refresh + 1)
+            }
+            _ => {
+                write_prefix(output, PacketType::Ir, self.context_id)?;
+                output
+                    .get_mut(1..HC_IR_HEADER_SIZE)
+                    .ok_or(IdtpError::BufferOverflow)?
+                    .copy_from_slice(header.as_bytes());
+
+                (HC_IR_HEADER_SIZE, Context::new(header), 0)
+            }
+        };
+
+        let size = copy_rest(rest, output, size)?;
+
+        self.context = Some(context);
+        self.since_refresh = since_refresh;
+        Ok(size)
+    }
+}
+
+/// Header decompressor of all streams of a link.
+#[derive(Debug, Clone, Default)]
+pub struct HeaderDecompressor {
+    /// Compression contexts by context id.
+    contexts: [Option<Context>; HC_MAX_CONTEXTS],
+}
+
+impl HeaderDecompressor {
+    /// Construct new `HeaderDecompressor` object.
+    ///
+    /// # Returns
+    /// - New `HeaderDecompressor` object.
+    #[must_use]
+    pub const fn new() -> Self {
+        Self {
+            contexts: [None; HC_MAX_CONTEXTS],
+        }
+    }
+
+    /// Drop context, e.g. after reconstructed frame failed validation.
+    /// Packets of this context are rejected until the next `IR` packet.
+    ///
+    /// # Parameters
+    /// - `context_id` - given context id.
+    pub fn invalidate(&mut self, context_id: u8) {
+        if let Some(context) = self.contexts.get_mut(usize::from(context_id)) {
+            *context = None;
+        }
+    }
+
+    /// Decompress packet into IDTP frame.
+    ///
+    /// # Parameters
+    /// - `packet` - given compressed packet.
+    /// - `output` - given buffer to store IDTP frame.
+    ///
+    /// # Returns
+    /// - Size of IDTP frame in bytes - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow - if packet is truncated.
+    /// - Buffer overflow - if output buffer is too short.
+    /// - Parse error - if packet type is unknown or context is not
+    ///   initialised.
+    pub fn decompress(
+        &mut self,
+        packet: &[u8],
+        output: &mut [u8],
+    ) -> IdtpResult<usize> {
+        let prefix = *packet.first().ok_or(IdtpError::BufferUnderflow)?;
+        let kind = PacketType::try_from(prefix >> 4)?;
+        let slot = self
+            .contexts
+            .get_mut(usize::from(prefix & 0x0F))
+            .ok_or(IdtpError::ParseError)?;
+
+        // Context changes are committed only after whole frame is written.
+        let (context, size) = match kind {
+            PacketType::Ir => {
+                let (header, _) = IdtpHeader::read_from_prefix(
+                    packet.get(1..).ok_or(IdtpError::BufferUnderflow)?,
+                )
+                .map_err(|_| IdtpError::BufferUnderflow)?;
+
+                (Context::new(header), HC_IR_HEADER_SIZE)
+            }
+            PacketType::CoMin | PacketType::Co => {
+                let mut context = (*slot).ok_or(IdtpError::ParseError)?;
+                let crc = *packet.get(1).ok_or(IdtpError::BufferUnderflow)?;
+                let mut position = HC_CO_MIN_HEADER_SIZE;
+
+                let (sequence_delta, stride) = if kind == PacketType::Co {
+                    let sequence_delta = read_varint(packet, &mut position)?;
+                    let stride_delta =
+                        unzigzag(read_varint(packet, &mut position)?);
+
+                    #[allow(clippy::cast_sign_loss)]
+                    let stride =
+                        context.stride.wrapping_add(stride_delta as u32);
+                    (sequence_delta, stride)
+                } else {
+                    (1, context.stride)
+                };
+
+                context.advance(
+                    context.header.sequence.wrapping_add(sequence_delta),
+                    context.header.timestamp.wrapping_add(stride),
+                    crc,
+                );
+                (context, position)
+            }
+        };
+
+        output
+            .get_mut(..IDTP_HEADER_SIZE)
+            .ok_or(IdtpError::BufferOverflow)?
+            .copy_from_slice(context.header.as_bytes());
+
+        let size = copy_rest(
+            packet.get(size..).ok_or(IdtpError::BufferUnderflow)?,
+            output,
+            IDTP_HEADER_SIZE,
+        )?;
+
+        *slot = Some(context);
+        Ok(size)
+    }
+}
+
+/// Write packet type & context id byte.
+///
+/// # Parameters
+/// - `output` - given output buffer.
+/// - `kind` - given packet type.
+/// - `context_id` - given context id.
+///
+/// # Errors
+/// - Buffer overflow.
+fn write_prefix(
+    output: &mut [u8],
+    kind: PacketType,
+    context_id: u8,
+) -> IdtpResult<()> {
+    write_byte(output, 0, ((kind as u8) << 4) | context_id)
+}
+
+/// Write single byte.
+///
+/// # Parameters
+/// - `output` - given output buffer.
+/// - `position` - given byte position.
+/// - `value` - given byte value.
+///
+/// # Errors
+/// - Buffer overflow.
+fn write_byte(output: &mut [u8], position: usize, value: u8) -> IdtpResult<()> {
+    *output.get_mut(position).ok_or(IdtpError::BufferOverflow)? = value;
+    Ok(())
+}
+
+/// Copy payload & trailer after header.
+///
+/// # Parameters
+/// - `rest` - given payload & trailer bytes.
+/// - `output` - given output buffer.
+/// - `offset` - given size of header already written.
+///
+/// # Returns
+/// - Total size in bytes - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer overflow.
+fn copy_rest(
+    rest: &[u8],
+    output: &mut [u8],
+    offset: usize,
+) -> IdtpResult<usize> {
+    let size = offset + rest.len();
+
+    output
+        .get_mut(offset..size)
+        .ok_or(IdtpError::BufferOverflow)?
+        .copy_from_slice(rest);
+
+    Ok(size)
+}
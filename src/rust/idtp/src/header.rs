@@ -14,9 +14,10 @@ pub const IDTP_PREAMBLE: u32 = 0x5054_4449;
 /// For v2.0, the value is 0x21 (where 0x2 is Major and 0x1 is Minor).
 pub const IDTP_VERSION: u8 = 0x21;
 
-/// IDTP operating mode.
+/// IDTP operating mode. New modes MAY be added in minor releases.
 #[derive(Debug, Default, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
 #[repr(u8)]
+#[non_exhaustive]
 pub enum IdtpMode {
     /// `IDTP-L (Lite mode)` - operating mode for minimum latency & overhead
     /// with general protection. SHOULD be used for trusted channels only.
@@ -30,6 +31,17 @@ pub enum IdtpMode {
     /// data spoofing. MUST be used for data transmission over unsecured
     /// channels.
     Secure = 0x02,
+    /// `IDTP-SF (Secure Fast mode)` - operating mode with protection against
+    /// data spoofing by keyed `BLAKE2s-256`, which is several times cheaper
+    /// than `HMAC-SHA256` on short frames. MAY be used instead of `IDTP-SEC`
+    /// on constrained devices.
+    SecureFast = 0x03,
+    /// `IDTP-E (Encrypted mode)` - operating mode with payload confidentiality
+    /// & protection against data spoofing by `ChaCha20-Poly1305`. Payload is
+    /// encrypted in place, header is authenticated only. MUST be used for
+    /// transmission of sensitive data over unsecured channels. Key MUST be
+    /// fresh for each boot of sender, since nonce is built from header.
+    Encrypted = 0x04,
 }
 
 impl From<IdtpMode> for u8 {
@@ -65,6 +77,8 @@ impl TryFrom<u8> for IdtpMode {
             0x00 => Ok(Self::Lite),
             0x01 => Ok(Self::Safety),
             0x02 => Ok(Self::Secure),
+            0x03 => Ok(Self::SecureFast),
+            0x04 => Ok(Self::Encrypted),
             _ => Err(Self::Error::ParseError),
         }
     }
@@ -0,0 +1,380 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Streaming adapters over `embedded-io` & `embedded-io-async` traits.
+//!
+//! Frames are written section by section (header, payload, trailer) with
+//! incremental trailer calculation, so no intermediate frame buffer is
+//! required. Frames are read through `FrameDecoder`, which handles
+//! resynchronisation on corrupted streams.
+
+#[cfg(feature = "software_impl")]
+use crate::crypto::{self, SwTrailerDigest};
+use crate::{
+    FrameDecoder, IDTP_HEADER_SIZE, IdtpError, IdtpFrame, IdtpMode, IdtpResult,
+    TrailerDigest,
+};
+use zerocopy::IntoBytes;
+
+/// Max frame trailer size in bytes.
+const TRAILER_MAX_SIZE: usize = 32;
+
+/// Offset of the header `crc` field.
+const CRC_OFFSET: usize = 19;
+
+/// Prepare frame header bytes for transmission.
+///
+/// # Parameters
+/// - `frame` - given IDTP frame to handle.
+/// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+///
+/// # Returns
+/// - Header bytes with `CRC-8` & trailer size - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Parse error - if mode is unknown or `IDTP-E`: payload must be
+///   encrypted, which streaming writers do not support.
+/// - Errors returned by `calc_crc8`.
+fn prepare_header<C8>(
+    frame: &IdtpFrame,
+    calc_crc8: C8,
+) -> IdtpResult<([u8; IDTP_HEADER_SIZE], usize)>
+where
+    C8: FnOnce(&[u8]) -> IdtpResult<u8>,
+{
+    let mode = IdtpMode::try_from(frame.header().mode)?;
+
+    // Payload must be encrypted, use `IdtpFrame::seal_with`.
+    if mode == IdtpMode::Encrypted {
+        return Err(IdtpError::ParseError);
+    }
+
+    let trailer_size = IdtpFrame::trailer_size_from(mode);
+
+    let mut header = [0u8; IDTP_HEADER_SIZE];
+    header.copy_from_slice(frame.header().as_bytes());
+
+    let crc8 =
+        calc_crc8(header.get(..CRC_OFFSET).ok_or(IdtpError::BufferUnderflow)?)?;
+    *header
+        .get_mut(CRC_OFFSET)
+        .ok_or(IdtpError::BufferUnderflow)? = crc8;
+
+    Ok((header, trailer_size))
+}
+
+/// Write IDTP frame to blocking writer with custom `CRC-8` and trailer
+/// calculation.
+///
+/// # Parameters
+/// - `writer` - given writer to handle.
+/// - `frame` - given IDTP frame to write.
+/// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+/// - `digest` - given incremental trailer calculator.
+///
+/// # Returns
+/// - Frame size in bytes - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - I/O error.
+/// - Parse error - if mode is unknown or `IDTP-E`.
+/// - Errors returned by `calc_crc8` & `digest`.
+#[cfg(feature = "embedded_io")]
+pub fn write_frame_with<W, C8, D>(
+    writer: &mut W,
+    frame: &IdtpFrame,
+    calc_crc8: C8,
+    mut digest: D,
+) -> IdtpResult<usize>
+where
+    W: embedded_io::Write,
+    C8: FnOnce(&[u8]) -> IdtpResult<u8>,
+    D: TrailerDigest,
+{
+    let (header, trailer_size) = prepare_header(frame, calc_crc8)?;
+    let payload = frame.payload_raw()?;
+
+    writer.write_all(&header).map_err(|_| IdtpError::IoError)?;
+
+    if trailer_size == 0 {
+        writer.write_all(payload).map_err(|_| IdtpError::IoError)?;
+        return Ok(frame.size());
+    }
+
+    digest.update(&header)?;
+    writer.write_all(payload).map_err(|_| IdtpError::IoError)?;
+    digest.update(payload)?;
+
+    let mut trailer = [0u8; TRAILER_MAX_SIZE];
+    let trailer = trailer
+        .get_mut(..trailer_size)
+        .ok_or(IdtpError::BufferOverflow)?;
+
+    digest.finalize(trailer)?;
+    writer.write_all(trailer).map_err(|_| IdtpError::IoError)?;
+
+    Ok(frame.size())
+}
+
+/// Write IDTP frame to blocking writer. `CRC` & `HMAC` calculation
+/// is software-based.
+///
+/// # Parameters
+/// - `writer` - given writer to handle.
+/// - `frame` - given IDTP frame to write.
+/// - `key` - given `HMAC` or `BLAKE2s` key.
+///
+/// # Returns
+/// - Frame size in bytes - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - I/O error.
+/// - Parse error - if mode is unknown or `IDTP-E`.
+/// - Invalid HMAC key.
+#[cfg(all(feature = "embedded_io", feature = "software_impl"))]
+pub fn write_frame<W>(
+    writer: &mut W,
+    frame: &IdtpFrame,
+    key: Option<&[u8]>,
+) -> IdtpResult<usize>
+where
+    W: embedded_io::Write,
+{
+    let mode = IdtpMode::try_from(frame.header().mode)?;
+    let digest = SwTrailerDigest::new(mode, key)?;
+
+    write_frame_with(writer, frame, crypto::sw_crc8, digest)
+}
+
+/// Read next IDTP frame from blocking reader with custom `CRC-8`
+/// calculation. Frame trailer is not checked.
+///
+/// # Parameters
+/// - `reader` - given reader to handle.
+/// - `decoder` - given frame decoder to assemble frame.
+/// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+///
+/// # Returns
+/// - Raw IDTP frame bytes - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - I/O error (including end of stream).
+/// - Errors returned by `calc_crc8`.
+#[cfg(feature = "embedded_io")]
+pub fn read_frame_with<'a, R, C8>(
+    reader: &mut R,
+    decoder: &'a mut FrameDecoder,
+    mut calc_crc8: C8,
+) -> IdtpResult<&'a [u8]>
+where
+    R: embedded_io::Read,
+    C8: FnMut(&[u8]) -> IdtpResult<u8>,
+{
+    loop {
+        let count = reader
+            .read(decoder.spare())
+            .map_err(|_| IdtpError::IoError)?;
+
+        if count == 0 {
+            return Err(IdtpError::IoError);
+        }
+
+        if decoder.commit_with(count, &mut calc_crc8)?.is_some() {
+            return decoder.frame().ok_or(IdtpError::ParseError);
+        }
+    }
+}
+
+/// Read next IDTP frame from blocking reader. `CRC-8` calculation is
+/// software-based. Frame trailer is not checked.
+///
+/// # Parameters
+/// - `reader` - given reader to handle.
+/// - `decoder` - given frame decoder to assemble frame.
+///
+/// # Returns
+/// - Raw IDTP frame bytes - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - I/O error (including end of stream).
+#[cfg(all(feature = "embedded_io", feature = "software_impl"))]
+pub fn read_frame<'a, R>(
+    reader: &mut R,
+    decoder: &'a mut FrameDecoder,
+) -> IdtpResult<&'a [u8]>
+where
+    R: embedded_io::Read,
+{
+    read_frame_with(reader, decoder, crypto::sw_crc8)
+}
+
+/// Write IDTP frame to async writer with custom `CRC-8` and trailer
+/// calculation. Trailer calculation of each section is performed before
+/// awaiting its transmission.
+///
+/// # Parameters
+/// - `writer` - given writer to handle.
+/// - `frame` - given IDTP frame to write.
+/// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+/// - `digest` - given incremental trailer calculator.
+///
+/// # Returns
+/// - Frame size in bytes - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - I/O error.
+/// - Parse error - if mode is unknown or `IDTP-E`.
+/// - Errors returned by `calc_crc8` & `digest`.
+#[cfg(feature = "embedded_io_async")]
+pub async fn write_frame_with_async<W, C8, D>(
+    writer: &mut W,
+    frame: &IdtpFrame,
+    calc_crc8: C8,
+    mut digest: D,
+) -> IdtpResult<usize>
+where
+    W: embedded_io_async::Write,
+    C8: FnOnce(&[u8]) -> IdtpResult<u8>,
+    D: TrailerDigest,
+{
+    let (header, trailer_size) = prepare_header(frame, calc_crc8)?;
+    let payload = frame.payload_raw()?;
+
+    if trailer_size == 0 {
+        writer
+            .write_all(&header)
+            .await
+            .map_err(|_| IdtpError::IoError)?;
+        writer
+            .write_all(payload)
+            .await
+            .map_err(|_| IdtpError::IoError)?;
+        return Ok(frame.size());
+    }
+
+    digest.update(&header)?;
+    writer
+        .write_all(&header)
+        .await
+        .map_err(|_| IdtpError::IoError)?;
+    digest.update(payload)?;
+    writer
+        .write_all(payload)
+        .await
+        .map_err(|_| IdtpError::IoError)?;
+
+    let mut trailer = [0u8; TRAILER_MAX_SIZE];
+    let trailer = trailer
+        .get_mut(..trailer_size)
+        .ok_or(IdtpError::BufferOverflow)?;
+
+    digest.finalize(trailer)?;
+    writer
+        .write_all(trailer)
+        .await
+        .map_err(|_| IdtpError::IoError)?;
+
+    Ok(frame.size())
+}
+
+/// Write IDTP frame to async writer. `CRC` & `HMAC` calculation
+/// is software-based.
+///
+/// # Parameters
+/// - `writer` - given writer to handle.
+/// - `frame` - given IDTP frame to write.
+/// - `key` - given `HMAC` or `BLAKE2s` key.
+///
+/// # Returns
+/// - Frame size in bytes - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - I/O error.
+/// - Parse error - if mode is unknown or `IDTP-E`.
+/// - Invalid HMAC key.
+#[cfg(all(feature = "embedded_io_async", feature = "software_impl"))]
+pub async fn write_frame_async<W>(
+    writer: &mut W,
+    frame: &IdtpFrame,
+    key: Option<&[u8]>,
+) -> IdtpResult<usize>
+where
+    W: embedded_io_async::Write,
+{
+    let mode = IdtpMode::try_from(frame.header().mode)?;
+    let digest = SwTrailerDigest::new(mode, key)?;
+
+    write_frame_with_async(writer, frame, crypto::sw_crc8, digest).await
+}
+
+/// Read next IDTP frame from async reader with custom `CRC-8`
+/// calculation. Frame trailer is not checked.
+///
+/// # Parameters
+/// - `reader` - given reader to handle.
+/// - `decoder` - given frame decoder to assemble frame.
+/// - `calc_crc8` - given closure with custom `CRC-8` calculation logic.
+///
+/// # Returns
+/// - Raw IDTP frame bytes - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - I/O error (including end of stream).
+/// - Errors returned by `calc_crc8`.
+#[cfg(feature = "embedded_io_async")]
+pub async fn read_frame_with_async<'a, R, C8>(
+    reader: &mut R,
+    decoder: &'a mut FrameDecoder,
+    mut calc_crc8: C8,
+) -> IdtpResult<&'a [u8]>
+where
+    R: embedded_io_async::Read,
+    C8: FnMut(&[u8]) -> IdtpResult<u8>,
+{
+    loop {
+        let count = reader
+            .read(decoder.spare())
+            .await
+            .map_err(|_| IdtpError::IoError)?;
+
+        if count == 0 {
+            return Err(IdtpError::IoError);
+        }
+
+        if decoder.commit_with(count, &mut calc_crc8)?.is_some() {
+            return decoder.frame().ok_or(IdtpError::ParseError);
+        }
+    }
+}
+
+/// Read next IDTP frame from async reader. `CRC-8` calculation is
+/// software-based. Frame trailer is not checked.
+///
+/// # Parameters
+/// - `reader` - given reader to handle.
+/// - `decoder` - given frame decoder to assemble frame.
+///
+/// # Returns
+/// - Raw IDTP frame bytes - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - I/O error (including end of stream).
+#[cfg(all(feature = "embedded_io_async", feature = "software_impl"))]
+pub async fn read_frame_async<'a, R>(
+    reader: &mut R,
+    decoder: &'a mut FrameDecoder,
+) -> IdtpResult<&'a [u8]>
+where
+    R: embedded_io_async::Read,
+{
+    read_frame_with_async(reader, decoder, crypto::sw_crc8).await
+}
@@ -0,0 +1,744 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Per-device key store for receivers of keyed-mode frames.
+//!
+//! Each slot holds precomputed state of one device key: `HMAC-SHA256` inner
+//! & outer midstates, `BLAKE2s` chained state after the key block & raw
+//! `ChaCha20-Poly1305` key. Slots are found by `device_id` hash & protected
+//! by seqlock like `LatestTable`, so key rotation never blocks validation
+//! and per-frame key setup is a copy of slot words. Rotated-out key is still
+//! accepted until its grace deadline. Time is supplied by caller in
+//! microseconds.
+
+use crate::{
+    IdtpError, IdtpFrame, IdtpMode, IdtpResult, TrailerDigest,
+    crypto::{self, Blake2s, HmacMidstate, HmacMidstateDigest},
+    trailer_eq,
+};
+use core::sync::atomic::{AtomicU32, Ordering, fence};
+
+/// Offset of the header `device_id` field.
+const DEVICE_ID_OFFSET: usize = 12;
+
+/// Offset of the header `mode` field.
+const MODE_OFFSET: usize = 17;
+
+/// Number of 32-bit words in key state.
+const STATE_WORDS: usize = 33;
+
+/// Number of 32-bit words in slot: current & previous key states and grace
+/// deadline of previous key.
+const SLOT_WORDS: usize = STATE_WORDS * 2 + 2;
+
+/// Key state flag: `BLAKE2s` midstate is valid.
+const FLAG_BLAKE2S: u32 = 1 << 0;
+
+/// Key state flag: `ChaCha20-Poly1305` key is valid.
+const FLAG_AEAD: u32 = 1 << 1;
+
+/// Key state flag: key is present.
+const FLAG_PRESENT: u32 = 1 << 2;
+
+/// Precomputed state of device key.
+#[derive(Debug, Clone, Copy)]
+struct KeyState {
+    /// `HMAC-SHA256` midstates.
+    hmac: HmacMidstate,
+    /// `BLAKE2s` chained state after the key block.
+    blake2s: [u32; 8],
+    /// `ChaCha20-Poly1305` key.
+    aead: [u8; 32],
+    /// Key state flags.
+    flags: u32,
+}
+
+impl KeyState {
+    /// Construct new `KeyState` object.
+    ///
+    /// # Parameters
+    /// - `key` - given device key.
+    ///
+    /// # Returns
+    /// - New `KeyState` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Invalid HMAC key - if `HMAC` midstate can not be precomputed.
+    fn new(key: &[u8]) -> IdtpResult<Self> {
+        let mut flags = FLAG_PRESENT;
+        let blake2s =
+            Blake2s::keyed_midstate(Some(key)).map_or([0; 8], |state| {
+                flags |= FLAG_BLAKE2S;
+                state
+            });
+        let aead = <[u8; 32]>::try_from(key).map_or([0; 32], |key| {
+            flags |= FLAG_AEAD;
+            key
+        });
+
+        Ok(Self {
+            hmac: HmacMidstate::new(key)?,
+            blake2s,
+            aead,
+            flags,
+        })
+    }
+
+    /// Convert to slot words.
+    ///
+    /// # Parameters
+    /// - `words` - given buffer to store key state.
+    fn store(&self, words: &mut [u32]) {
+        let aead = self.aead.as_chunks::<4>().0.iter().copied();
+        let aead = aead.map(u32::from_le_bytes);
+        let values = self
+            .hmac
+            .inner
+            .into_iter()
+            .chain(self.hmac.outer)
+            .chain(self.blake2s)
+            .chain(aead)
+            .chain(core::iter::once(self.flags));
+
+        for (word, value) in words.iter_mut().zip(values) {
+            *word = value;
+        }
+    }
+
+    /// Convert from slot words.
+    ///
+    /// # Parameters
+    /// - `words` - given key state words.
+    ///
+    /// # Returns
+    /// - Key state - if key is present.
+    /// - `None` - otherwise.
+    fn load(words: &[u32]) -> Option<Self> {
+        let mut state = Self {
+            hmac: HmacMidstate {
+                inner: [0; 8],
+                outer: [0; 8],
+            },
+            blake2s: [0; 8],
+            aead: [0; 32],
+            flags: *words.get(STATE_WORDS - 1)?,
+        };
+
+        if state.flags & FLAG_PRESENT == 0 {
+            return None;
+        }
+
+        let mut words = words.iter().copied();
+        let fields = [
+            &mut state.hmac.inner,
+            &mut state.hmac.outer,
+            &mut state.blake2s,
+        ];
+
+        for field in fields {
+            for (value, word) in field.iter_mut().zip(&mut words) {
+                *value = word;
+            }
+        }
+
+        for (bytes, word) in state.aead.chunks_exact_mut(4).zip(words) {
+            bytes.copy_from_slice(&word.to_le_bytes());
+        }
+
+        Some(state)
+    }
+
+    /// Start incremental trailer calculation of keyed mode.
+    ///
+    /// # Parameters
+    /// - `mode` - given frame mode.
+    ///
+    /// # Returns
+    /// - Trailer digest - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Invalid HMAC key - if key is not suitable for frame mode.
+    /// - Parse error - if frame mode is not `IDTP-SEC` or `IDTP-SF`.
+    const fn digest(&self, mode: IdtpMode) -> IdtpResult<KeyDigest> {
+        match mode {
+            IdtpMode::Secure => {
+                Ok(KeyDigest::Secure(HmacMidstateDigest::new(&self.hmac)))
+            }
+            IdtpMode::SecureFast if self.flags & FLAG_BLAKE2S != 0 => {
+                Ok(KeyDigest::SecureFast(Blake2s::from_midstate(self.blake2s)))
+            }
+            IdtpMode::SecureFast => Err(IdtpError::InvalidHMacKey),
+            _ => Err(IdtpError::ParseError),
+        }
+    }
+
+    /// Calculate `Poly1305` tag of `IDTP-E` frame. Tag is stored in the first
+    /// 16 bytes of result.
+    ///
+    /// # Parameters
+    /// - `data` - given frame header & encrypted payload.
+    ///
+    /// # Returns
+    /// - Frame tag - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Invalid HMAC key - if key is not 32 bytes long.
+    /// - Buffer underflow - if header is truncated.
+    fn aead_tag(&self, data: &[u8]) -> IdtpResult<[u8; 32]> {
+        if self.flags & FLAG_AEAD == 0 {
+            return Err(IdtpError::InvalidHMacKey);
+        }
+
+        crypto::sw_aead_tag_closure(Some(&self.aead))(data)
+    }
+}
+
+/// Incremental frame trailer calculation with precomputed key state.
+#[allow(clippy::large_enum_variant)]
+enum KeyDigest {
+    /// `IDTP-L` & `IDTP-S` - unkeyed trailer.
+    Unkeyed(crypto::SwTrailerDigest),
+    /// `IDTP-SEC` - `HMAC-SHA256` trailer from key midstates.
+    Secure(HmacMidstateDigest),
+    /// `IDTP-SF` - keyed `BLAKE2s-256` trailer from key midstate.
+    SecureFast(Blake2s),
+}
+
+impl TrailerDigest for KeyDigest {
+    /// Update trailer calculation with frame data.
+    ///
+    /// # Parameters
+    /// - `data` - given data to handle.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if pending block is out of bounds.
+    fn update(&mut self, data: &[u8]) -> IdtpResult<()> {
+        match self {
+            Self::Unkeyed(digest) => digest.update(data),
+            Self::Secure(mac) => mac.update(data),
+            Self::SecureFast(mac) => mac.update(data),
+        }
+    }
+
+    /// Finalize trailer calculation.
+    ///
+    /// # Parameters
+    /// - `trailer` - given buffer to store frame trailer.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    fn finalize(self, trailer: &mut [u8]) -> IdtpResult<()> {
+        let mac = match self {
+            Self::Unkeyed(digest) => return digest.finalize(trailer),
+            Self::Secure(mac) => mac.finalize()?,
+            Self::SecureFast(mac) => mac.finalize()?,
+        };
+
+        trailer
+            .get_mut(..mac.len())
+            .ok_or(IdtpError::BufferUnderflow)?
+            .copy_from_slice(&mac);
+        Ok(())
+    }
+
+    /// Finalize trailer calculation directly into constant-time comparison
+    /// with received trailer.
+    ///
+    /// # Parameters
+    /// - `trailer` - given received frame trailer.
+    ///
+    /// # Errors
+    /// - Invalid CRC - if `CRC-32` trailer differs.
+    /// - Invalid HMAC - if `MAC` trailer differs.
+    fn verify(self, trailer: &[u8]) -> IdtpResult<()> {
+        let mac = match self {
+            Self::Unkeyed(digest) => return digest.verify(trailer),
+            Self::Secure(mac) => mac.finalize()?,
+            Self::SecureFast(mac) => mac.finalize()?,
+        };
+
+        if trailer_eq(&mac, trailer) {
+            Ok(())
+        } else {
+            Err(IdtpError::InvalidHMac)
+        }
+    }
+}
+
+/// Keys of device.
+#[derive(Debug, Clone, Copy)]
+struct DeviceKeys {
+    /// Current key.
+    current: Option<KeyState>,
+    /// Rotated-out key.
+    previous: Option<KeyState>,
+    /// Grace deadline of rotated-out key in microseconds.
+    deadline: u64,
+}
+
+impl DeviceKeys {
+    /// Convert from slot words.
+    ///
+    /// # Parameters
+    /// - `words` - given slot words.
+    ///
+    /// # Returns
+    /// - Device keys.
+    fn load(words: &[u32; SLOT_WORDS]) -> Self {
+        let (current, rest) = words.split_at(STATE_WORDS);
+        let (previous, deadline) = rest.split_at(STATE_WORDS);
+        let deadline = deadline
+            .iter()
+            .rev()
+            .fold(0, |value, word| (value << 32) | u64::from(*word));
+
+        Self {
+            current: KeyState::load(current),
+            previous: KeyState::load(previous),
+            deadline,
+        }
+    }
+
+    /// Get rotated-out key if it is still accepted.
+    ///
+    /// # Parameters
+    /// - `now` - given current time in microseconds.
+    ///
+    /// # Returns
+    /// - Rotated-out key - if grace deadline has not passed.
+    /// - `None` - otherwise.
+    fn previous(&self, now: u64) -> Option<&KeyState> {
+        self.previous.as_ref().filter(|_| now < self.deadline)
+    }
+}
+
+/// Key store slot.
+#[derive(Debug)]
+#[repr(C, align(64))]
+struct KeySlot {
+    /// Device identifier + 1 or 0 if slot is free.
+    device: AtomicU32,
+    /// Seqlock counter. Odd value means update in progress.
+    sequence: AtomicU32,
+    /// Key states & grace deadline words.
+    words: [AtomicU32; SLOT_WORDS],
+}
+
+impl KeySlot {
+    /// Construct new empty `KeySlot` object.
+    ///
+    /// # Returns
+    /// - New `KeySlot` object.
+    const fn new() -> Self {
+        Self {
+            device: AtomicU32::new(0),
+            sequence: AtomicU32::new(0),
+            words: [const { AtomicU32::new(0) }; SLOT_WORDS],
+        }
+    }
+
+    /// Update slot words.
+    ///
+    /// # Parameters
+    /// - `update` - given closure that modifies slot words.
+    fn update<U>(&self, update: U)
+    where
+        U: FnOnce(&mut [u32; SLOT_WORDS]),
+    {
+        let mut current = self.sequence.load(Ordering::Relaxed);
+
+        // Serialize concurrent writers of the same device.
+        loop {
+            if current & 1 == 0 {
+                match self.sequence.compare_exchange_weak(
+                    current,
+                    current.wrapping_add(1),
+                    Ordering::Acquire,
+                    Ordering::Relaxed,
+                ) {
+                    Ok(_) => break,
+                    Err(actual) => current = actual,
+                }
+            } else {
+                core::hint::spin_loop();
+                current = self.sequence.load(Ordering::Relaxed);
+            }
+        }
+        fence(Ordering::Release);
+
+        let mut words = [0; SLOT_WORDS];
+        for (value, word) in words.iter_mut().zip(&self.words) {
+            *value = word.load(Ordering::Relaxed);
+        }
+
+        update(&mut words);
+
+        for (value, word) in words.iter().zip(&self.words) {
+            word.store(*value, Ordering::Relaxed);
+        }
+
+        self.sequence
+            .store(current.wrapping_add(2), Ordering::Release);
+    }
+
+    /// Try to load slot words.
+    ///
+    /// # Parameters
+    /// - `words` - given buffer to store slot words.
+    ///
+    /// # Returns
+    /// - `true` - if consistent words were loaded.
+    /// - `false` - if slot was updated concurrently.
+    fn try_load(&self, words: &mut [u32; SLOT_WORDS]) -> bool {
+        let before = self.sequence.load(Ordering::Acquire);
+
+        if before & 1 != 0 {
+            return false;
+        }
+
+        for (value, word) in words.iter_mut().zip(&self.words) {
+            *value = word.load(Ordering::Relaxed);
+        }
+
+        fence(Ordering::Acquire);
+        self.sequence.load(Ordering::Relaxed) == before
+    }
+
+    /// Load device keys. Retries optimistic read while slot is being updated.
+    ///
+    /// # Returns
+    /// - Device keys.
+    fn load(&self) -> DeviceKeys {
+        let mut words = [0; SLOT_WORDS];
+
+        while !self.try_load(&mut words) {
+            core::hint::spin_loop();
+        }
+
+        DeviceKeys::load(&words)
+    }
+}
+
+/// Fixed-capacity store of per-device keys.
+///
+/// # Parameters
+/// - `N` - max number of devices. **MUST** be a power of two.
+#[derive(Debug)]
+#[repr(C)]
+pub struct KeyStore<const N: usize> {
+    /// Store slots indexed by device identifier hash.
+    slots: [KeySlot; N],
+}
+
+impl<const N: usize> KeyStore<N> {
+    /// Construct new empty `KeyStore` object.
+    ///
+    /// # Returns
+    /// - New `KeyStore` object.
+    #[must_use]
+    pub const fn new() -> Self {
+        const {
+            assert!(N.is_power_of_two(), "capacity must be a power of two");
+        }
+
+        Self {
+            slots: [const { KeySlot::new() }; N],
+        }
+    }
+
+    /// Set key of device. Previous keys of device are dropped.
+    ///
+    /// # Parameters
+    /// - `device_id` - given device identifier.
+    /// - `key` - given device key.
+    ///
+    /// # Errors
+    /// - Buffer overflow - store is full.
+    /// - Invalid HMAC key - if key state can not be precomputed.
+    pub fn insert(&self, device_id: u16, key: &[u8]) -> IdtpResult<()> {
+        let state = KeyState::new(key)?;
+
+        self.claim(device_id)
+            .ok_or(IdtpError::BufferOverflow)?
+            .update(|words| {
+                words.fill(0);
+                state.store(words);
+            });
+
+        Ok(())
+    }
+
+    /// Rotate key of device. Current key is still accepted until grace
+    /// deadline, so frames sent before the device switched keys pass.
+    /// `IDTP-E` devices **MUST** get a new key for each boot.
+    ///
+    /// # Parameters
+    /// - `device_id` - given device identifier.
+    /// - `key` - given new device key.
+    /// - `now` - given current time in microseconds.
+    /// - `grace` - given grace period of current key in microseconds.
+    ///
+    /// # Errors
+    /// - Buffer overflow - store is full.
+    /// - Invalid HMAC key - if key state can not be precomputed.
+    #[allow(clippy::cast_possible_truncation)]
+    pub fn rotate(
+        &self,
+        device_id: u16,
+        key: &[u8],
+        now: u64,
+        grace: u64,
+    ) -> IdtpResult<()> {
+        let state = KeyState::new(key)?;
+        let deadline = now.saturating_add(grace);
+
+        self.claim(device_id)
+            .ok_or(IdtpError::BufferOverflow)?
+            .update(|words| {
+                words.copy_within(..STATE_WORDS, STATE_WORDS);
+                state.store(words);
+
+                let (_, tail) = words.split_at_mut(STATE_WORDS * 2);
+                for (index, word) in tail.iter_mut().enumerate() {
+                    *word = (deadline >> (32 * index)) as u32;
+                }
+            });
+
+        Ok(())
+    }
+
+    /// Revoke all keys of device.
+    ///
+    /// # Parameters
+    /// - `device_id` - given device identifier.
+    pub fn revoke(&self, device_id: u16) {
+        if let Some(slot) = self.find(device_id) {
+            slot.update(|words| words.fill(0));
+        }
+    }
+
+    /// Check whether device has key.
+    ///
+    /// # Parameters
+    /// - `device_id` - given device identifier.
+    ///
+    /// # Returns
+    /// - `true` - if device has key.
+    /// - `false` - otherwise.
+    #[must_use]
+    pub fn contains(&self, device_id: u16) -> bool {
+        self.find(device_id)
+            .is_some_and(|slot| slot.load().current.is_some())
+    }
+
+    /// Validate IDTP frame integrity with key of its device. `CRC` & `MAC`
+    /// calculation is software-based, `MAC` is finalized directly into
+    /// comparison with received trailer. `IDTP-E` frames are authenticated,
+    /// but not decrypted.
+    ///
+    /// # Parameters
+    /// - `buffer` - given IDTP frame bytes.
+    /// - `now` - given current time in microseconds.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Invalid CRC / HMAC.
+    /// - Invalid HMAC key - if device of keyed-mode frame has no key.
+    pub fn validate(&self, buffer: &[u8], now: u64) -> IdtpResult<()> {
+        let mut keys = None;
+
+        let result = Self::validate_key(buffer, || {
+            let found = self.keys(buffer)?;
+            keys = Some(found);
+            found.current.ok_or(IdtpError::InvalidHMacKey)
+        });
+
+        match (result, keys.as_ref().and_then(|keys| keys.previous(now))) {
+            (Err(IdtpError::InvalidHMac), Some(previous)) => {
+                Self::validate_key(buffer, || Ok(*previous))
+            }
+            (result, _) => result,
+        }
+    }
+
+    /// Validate IDTP frame integrity with key state. `IDTP-E` tag can not be
+    /// streamed, so it is copied before comparison like in
+    /// `IdtpFrame::validate`.
+    ///
+    /// # Parameters
+    /// - `buffer` - given IDTP frame bytes.
+    /// - `key` - given closure that loads key state of keyed-mode frame.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Invalid CRC / HMAC.
+    /// - Invalid HMAC key - if key can not be loaded.
+    fn validate_key<K>(buffer: &[u8], key: K) -> IdtpResult<()>
+    where
+        K: FnOnce() -> IdtpResult<KeyState>,
+    {
+        if buffer.get(MODE_OFFSET) == Some(&(IdtpMode::Encrypted as u8)) {
+            return IdtpFrame::validate_with(
+                buffer,
+                crypto::sw_crc8,
+                crypto::sw_crc32,
+                |data: &[u8]| key()?.aead_tag(data),
+            );
+        }
+
+        IdtpFrame::verify_with(buffer, crypto::sw_crc8, |mode| match mode {
+            IdtpMode::Secure | IdtpMode::SecureFast => key()?.digest(mode),
+            _ => {
+                crypto::SwTrailerDigest::new(mode, None).map(KeyDigest::Unkeyed)
+            }
+        })
+    }
+
+    /// Authenticate & decrypt raw `IDTP-E` frame in place with key of its
+    /// device.
+    ///
+    /// # Parameters
+    /// - `buffer` - given IDTP frame bytes.
+    /// - `now` - given current time in microseconds.
+    ///
+    /// # Returns
+    /// - Frame size in bytes - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Invalid CRC / HMAC.
+    /// - Invalid HMAC key - if device has no 32-byte key.
+    /// - Parse error - if frame mode is not `IDTP-E`.
+    pub fn open(&self, buffer: &mut [u8], now: u64) -> IdtpResult<usize> {
+        let keys = self.keys(buffer)?;
+        let aead = |state: Option<&KeyState>| {
+            state
+                .filter(|state| state.flags & FLAG_AEAD != 0)
+                .map(|state| state.aead)
+        };
+
+        let current = aead(keys.current.as_ref());
+        let result = IdtpFrame::open_with(
+            buffer,
+            crypto::sw_crc8,
+            crypto::sw_open_closure(current.as_ref().map(|key| &key[..])),
+        );
+
+        match (result, aead(keys.previous(now))) {
+            (Err(IdtpError::InvalidHMac), Some(previous)) => {
+                IdtpFrame::open_with(
+                    buffer,
+                    crypto::sw_crc8,
+                    crypto::sw_open_closure(Some(&previous)),
+                )
+            }
+            (result, _) => result,
+        }
+    }
+
+    /// Load keys of frame device.
+    ///
+    /// # Parameters
+    /// - `data` - given frame bytes.
+    ///
+    /// # Returns
+    /// - Device keys - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Invalid HMAC key - if device has no keys.
+    fn keys(&self, data: &[u8]) -> IdtpResult<DeviceKeys> {
+        let device_id = data
+            .get(DEVICE_ID_OFFSET..DEVICE_ID_OFFSET + 2)
+            .and_then(|bytes| bytes.try_into().ok())
+            .map(u16::from_le_bytes)
+            .ok_or(IdtpError::BufferUnderflow)?;
+
+        self.find(device_id)
+            .map(KeySlot::load)
+            .ok_or(IdtpError::InvalidHMacKey)
+    }
+
+    /// Find slot of device.
+    ///
+    /// # Parameters
+    /// - `device_id` - given device identifier.
+    ///
+    /// # Returns
+    /// - Device slot - if present.
+    /// - `None` - otherwise.
+    fn find(&self, device_id: u16) -> Option<&KeySlot> {
+        let key = u32::from(device_id) + 1;
+
+        for slot in self.probe(device_id) {
+            match slot.device.load(Ordering::Acquire) {
+                0 => return None,
+                device if device == key => return Some(slot),
+                _ => {}
+            }
+        }
+        None
+    }
+
+    /// Find or claim slot of device.
+    ///
+    /// # Parameters
+    /// - `device_id` - given device identifier.
+    ///
+    /// # Returns
+    /// - Device slot - in case of success.
+    /// - `None` - if store is full.
+    fn claim(&self, device_id: u16) -> Option<&KeySlot> {
+        let key = u32::from(device_id) + 1;
+
+        for slot in self.probe(device_id) {
+            match slot.device.compare_exchange(
+                0,
+                key,
+                Ordering::AcqRel,
+                Ordering::Acquire,
+            ) {
+                Ok(_) => return Some(slot),
+                Err(device) if device == key => return Some(slot),
+                Err(_) => {}
+            }
+        }
+        None
+    }
+
+    /// Iterate over slots in probing order of device.
+    ///
+    /// # Parameters
+    /// - `device_id` - given device identifier.
+    ///
+    /// # Returns
+    /// - Iterator over slots.
+    fn probe(&self, device_id: u16) -> impl Iterator<Item = &KeySlot> {
+        let start = (usize::from(device_id).wrapping_mul(0x9E37)) & (N - 1);
+        let (tail, head) = self.slots.split_at(start);
+        head.iter().chain(tail)
+    }
+}
+
+impl<const N: usize> Default for KeyStore<N> {
+    /// Construct default key store.
+    ///
+    /// # Returns
+    /// - New default key store.
+    fn default() -> Self {
+        Self::new()
+    }
+}
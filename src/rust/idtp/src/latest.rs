@@ -0,0 +1,449 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Latest-value table of IDTP samples per device.
+//!
+//! Each slot holds the last header & payload of one device behind a seqlock.
+//! Writers never wait for readers & readers never block writers: they copy
+//! slot optimistically and retry only if the slot was updated meanwhile.
+//! Table consists of atomics only, so it can be placed in shared memory.
+
+use crate::{
+    IDTP_HEADER_SIZE, IdtpError, IdtpFrame, IdtpHeader, IdtpResult,
+    payload::IdtpPayload,
+};
+use core::sync::atomic::{AtomicU32, Ordering, fence};
+use zerocopy::{FromBytes, IntoBytes};
+
+/// Max payload size of latest-value table sample in bytes.
+pub const LATEST_PAYLOAD_MAX_SIZE: usize = 64;
+
+/// Number of 32-bit words in sample.
+const SAMPLE_WORDS: usize = (IDTP_HEADER_SIZE + LATEST_PAYLOAD_MAX_SIZE) / 4;
+
+/// Offset of the header `device_id` field.
+const DEVICE_ID_OFFSET: usize = 12;
+
+/// Offset of the header `payload_size` field.
+const PAYLOAD_SIZE_OFFSET: usize = 14;
+
+/// Optimistic read of latest-value table slot has raced with update & must
+/// be retried.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Retry;
+
+/// Latest sample of device.
+#[derive(Debug, Clone, Copy)]
+pub struct LatestSample {
+    /// IDTP header of the sample.
+    header: IdtpHeader,
+    /// Buffer that containing IDTP payload.
+    payload: [u8; LATEST_PAYLOAD_MAX_SIZE],
+}
+
+impl LatestSample {
+    /// Get IDTP header.
+    ///
+    /// # Returns
+    /// - IDTP header object.
+    #[must_use]
+    pub const fn header(&self) -> &IdtpHeader {
+        &self.header
+    }
+
+    /// Get IDTP payload raw.
+    ///
+    /// # Returns
+    /// - IDTP payload in bytes representation.
+    #[must_use]
+    pub fn payload_raw(&self) -> &[u8] {
+        let size = self.header.payload_size as usize;
+        self.payload.get(..size).unwrap_or_default()
+    }
+
+    /// Get IDTP payload.
+    ///
+    /// # Returns
+    /// - IDTP payload.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Parse error.
+    pub fn payload<T: IdtpPayload>(&self) -> IdtpResult<T> {
+        T::from_bytes(self.payload_raw())
+    }
+}
+
+/// Latest-value table slot.
+#[derive(Debug)]
+#[repr(C, align(64))]
+struct LatestSlot {
+    /// Device identifier + 1 or 0 if slot is free.
+    device: AtomicU32,
+    /// Seqlock counter. Odd value means update in progress.
+    sequence: AtomicU32,
+    /// Header & payload bytes.
+    words: [AtomicU32; SAMPLE_WORDS],
+}
+
+impl LatestSlot {
+    /// Construct new empty `LatestSlot` object.
+    ///
+    /// # Returns
+    /// - New `LatestSlot` object.
+    const fn new() -> Self {
+        Self {
+            device: AtomicU32::new(0),
+            sequence: AtomicU32::new(0),
+            words: [const { AtomicU32::new(0) }; SAMPLE_WORDS],
+        }
+    }
+
+    /// Store sample bytes.
+    ///
+    /// # Parameters
+    /// - `bytes` - given header & payload bytes.
+    ///
+    /// # Errors
+    /// - Buffer overflow - if sample does not fit into slot.
+    fn store(&self, bytes: &[u8]) -> IdtpResult<()> {
+        if bytes.len() > SAMPLE_WORDS * 4 {
+            return Err(IdtpError::BufferOverflow);
+        }
+
+        let mut current = self.sequence.load(Ordering::Relaxed);
+
+        // Serialize concurrent writers of the same device.
+        loop {
+            if current & 1 == 0 {
+                match self.sequence.compare_exchange_weak(
+                    current,
+                    current.wrapping_add(1),
+                    Ordering::Acquire,
+                    Ordering::Relaxed,
+                ) {
+                    Ok(_) => break,
+                    Err(actual) => current = actual,
+                }
+            } else {
+                core::hint::spin_loop();
+                current = self.sequence.load(Ordering::Relaxed);
+            }
+        }
+        fence(Ordering::Release);
+
+        let mut result = Ok(());
+
+        for (word, chunk) in self.words.iter().zip(bytes.chunks(4)) {
+            let mut value = [0u8; 4];
+
+            // Slot update must be completed even on error.
+            match value.get_mut(..chunk.len()) {
+                Some(bytes) => bytes.copy_from_slice(chunk),
+                None => result = Err(IdtpError::BufferOverflow),
+            }
+            word.store(u32::from_le_bytes(value), Ordering::Relaxed);
+        }
+
+        self.sequence
+            .store(current.wrapping_add(2), Ordering::Release);
+        result
+    }
+
+    /// Try to load sample bytes.
+    ///
+    /// # Parameters
+    /// - `bytes` - given buffer to store header & payload bytes.
+    ///
+    /// # Returns
+    /// - `true` - if consistent sample was loaded.
+    /// - `false` - if slot was updated concurrently.
+    fn try_load(&self, bytes: &mut [u8; SAMPLE_WORDS * 4]) -> bool {
+        let before = self.sequence.load(Ordering::Acquire);
+
+        if before & 1 != 0 {
+            return false;
+        }
+
+        for (word, chunk) in self.words.iter().zip(bytes.chunks_mut(4)) {
+            chunk.copy_from_slice(&word.load(Ordering::Relaxed).to_le_bytes());
+        }
+
+        fence(Ordering::Acquire);
+        self.sequence.load(Ordering::Relaxed) == before
+    }
+}
+
+/// Fixed-capacity table of latest samples per device.
+///
+/// # Parameters
+/// - `N` - max number of devices. **MUST** be a power of two.
+#[derive(Debug)]
+#[repr(C)]
+pub struct LatestTable<const N: usize> {
+    /// Table slots indexed by device identifier hash.
+    slots: [LatestSlot; N],
+}
+
+impl<const N: usize> LatestTable<N> {
+    /// Construct new empty `LatestTable` object. Zeroed memory is also
+    /// a valid empty table.
+    ///
+    /// # Returns
+    /// - New `LatestTable` object.
+    #[must_use]
+    pub const fn new() -> Self {
+        const {
+            assert!(N.is_power_of_two(), "capacity must be a power of two");
+        }
+
+        Self {
+            slots: [const { LatestSlot::new() }; N],
+        }
+    }
+
+    /// Store latest sample of device from raw IDTP frame. Frame **SHOULD**
+    /// be validated before.
+    ///
+    /// # Parameters
+    /// - `frame` - given raw IDTP frame bytes.
+    ///
+    /// # Errors
+    /// - Buffer underflow.
+    /// - Buffer overflow - payload is too large or table is full.
+    pub fn update(&self, frame: &[u8]) -> IdtpResult<()> {
+        let device_id = frame
+            .get(DEVICE_ID_OFFSET..DEVICE_ID_OFFSET + 2)
+            .and_then(|bytes| bytes.try_into().ok())
+            .map(u16::from_le_bytes)
+            .ok_or(IdtpError::BufferUnderflow)?;
+
+        let payload_size = frame
+            .get(PAYLOAD_SIZE_OFFSET..PAYLOAD_SIZE_OFFSET + 2)
+            .and_then(|bytes| bytes.try_into().ok())
+            .map(u16::from_le_bytes)
+            .ok_or(IdtpError::BufferUnderflow)?
+            as usize;
+
+        if payload_size > LATEST_PAYLOAD_MAX_SIZE {
+            return Err(IdtpError::BufferOverflow);
+        }
+
+        let sample = frame
+            .get(..IDTP_HEADER_SIZE + payload_size)
+            .ok_or(IdtpError::BufferUnderflow)?;
+
+        self.claim(device_id)
+            .ok_or(IdtpError::BufferOverflow)?
+            .store(sample)
+    }
+
+    /// Store latest sample of device from IDTP frame.
+    ///
+    /// # Parameters
+    /// - `frame` - given IDTP frame.
+    ///
+    /// # Errors
+    /// - Buffer overflow - payload is too large or table is full.
+    pub fn update_frame(&self, frame: &IdtpFrame) -> IdtpResult<()> {
+        let mut sample = [0u8; SAMPLE_WORDS * 4];
+        let payload = frame.payload_raw()?;
+
+        sample
+            .get_mut(..IDTP_HEADER_SIZE)
+            .ok_or(IdtpError::BufferUnderflow)?
+            .copy_from_slice(frame.header().as_bytes());
+        sample
+            .get_mut(IDTP_HEADER_SIZE..IDTP_HEADER_SIZE + payload.len())
+            .ok_or(IdtpError::BufferOverflow)?
+            .copy_from_slice(payload);
+
+        self.update(&sample)
+    }
+
+    /// Try to read latest sample of device with single optimistic attempt.
+    /// This operation is wait-free.
+    ///
+    /// # Parameters
+    /// - `device_id` - given device identifier.
+    ///
+    /// # Returns
+    /// - Latest sample - in case of success.
+    /// - `None` - if no samples of device were stored.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Retry - slot is being updated.
+    pub fn try_read(
+        &self,
+        device_id: u16,
+    ) -> Result<Option<LatestSample>, Retry> {
+        let Some(slot) = self.find(device_id) else {
+            return Ok(None);
+        };
+        let mut bytes = [0u8; SAMPLE_WORDS * 4];
+
+        if !slot.try_load(&mut bytes) {
+            return Err(Retry);
+        }
+
+        // Sample is always longer than header.
+        let Ok((header, payload_bytes)) = IdtpHeader::read_from_prefix(&bytes)
+        else {
+            return Ok(None);
+        };
+        let Ok(payload) = payload_bytes.try_into() else {
+            return Ok(None);
+        };
+
+        Ok(Some(LatestSample { header, payload }))
+    }
+
+    /// Read latest sample of device. Retries optimistic read while slot is
+    /// being updated.
+    ///
+    /// # Parameters
+    /// - `device_id` - given device identifier.
+    ///
+    /// # Returns
+    /// - Latest sample - if any samples of device were stored.
+    /// - `None` - otherwise.
+    #[must_use]
+    pub fn read(&self, device_id: u16) -> Option<LatestSample> {
+        loop {
+            match self.try_read(device_id) {
+                Ok(sample) => return sample,
+                Err(Retry) => core::hint::spin_loop(),
+            }
+        }
+    }
+
+    /// Find slot of device.
+    ///
+    /// # Parameters
+    /// - `device_id` - given device identifier.
+    ///
+    /// # Returns
+    /// - Device slot - if present.
+    /// - `None` - otherwise.
+    fn find(&self, device_id: u16) -> Option<&LatestSlot> {
+        let key = u32::from(device_id) + 1;
+
+        for slot in self.probe(device_id) {
+            match slot.device.load(Ordering::Acquire) {
+                0 => return None,
+                device if device == key => return Some(slot),
+                _ => {}
+            }
+        }
+        None
+    }
+
+    /// Find or claim slot of device.
+    ///
+    /// # Parameters
+    /// - `device_id` - given device identifier.
+    ///
+    /// # Returns
+    /// - Device slot - in case of success.
+    /// - `None` - if table is full.
+    fn claim(&self, device_id: u16) -> Option<&LatestSlot> {
+        let key = u32::from(device_id) + 1;
+
+        for slot in self.probe(device_id) {
+            match slot.device.compare_exchange(
+                0,
+                key,
+                Ordering::AcqRel,
+                Ordering::Acquire,
+            ) {
+                Ok(_) => return Some(slot),
+                Err(device) if device == key => return Some(slot),
+                Err(_) => {}
+            }
+        }
+        None
+    }
+
+    /// Iterate over slots in probing order of device.
+    ///
+    /// # Parameters
+    /// - `device_id` - given device identifier.
+    ///
+    /// # Returns
+    /// - Iterator over slots.
+    fn probe(&self, device_id: u16) -> impl Iterator<Item = &LatestSlot> {
+        let start = (usize::from(device_id).wrapping_mul(0x9E37)) & (N - 1);
+        let (tail, head) = self.slots.split_at(start);
+        head.iter().chain(tail)
+    }
+}
+
+impl<const N: usize> Default for LatestTable<N> {
+    /// Construct default latest-value table.
+    ///
+    /// # Returns
+    /// - New default latest-value table.
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Latest-value table located in shared memory.
+#[cfg(all(feature = "shm", target_os = "linux"))]
+#[derive(Debug)]
+pub struct ShmLatestTable<const N: usize> {
+    /// Shared memory region containing table.
+    region: crate::shm::ShmRegion,
+}
+
+#[cfg(all(feature = "shm", target_os = "linux"))]
+impl<const N: usize> ShmLatestTable<N> {
+    /// Get shared memory size required for table.
+    ///
+    /// # Returns
+    /// - Required size in bytes.
+    #[must_use]
+    pub const fn required_size() -> usize {
+        size_of::<LatestTable<N>>()
+    }
+
+    /// Place table into shared memory region. Newly created region is
+    /// zeroed, which is a valid empty table.
+    ///
+    /// # Parameters
+    /// - `region` - given shared memory region.
+    ///
+    /// # Returns
+    /// - New `ShmLatestTable` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow - region is too small.
+    pub fn new(region: crate::shm::ShmRegion) -> IdtpResult<Self> {
+        const {
+            assert!(N.is_power_of_two(), "capacity must be a power of two");
+        }
+
+        if region.len() < Self::required_size() {
+            return Err(IdtpError::BufferUnderflow);
+        }
+        Ok(Self { region })
+    }
+}
+
+#[cfg(all(feature = "shm", target_os = "linux"))]
+impl<const N: usize> core::ops::Deref for ShmLatestTable<N> {
+    type Target = LatestTable<N>;
+
+    /// Get latest-value table.
+    ///
+    /// # Returns
+    /// - Latest-value table.
+    #[allow(clippy::cast_ptr_alignment)]
+    fn deref(&self) -> &Self::Target {
+        // SAFETY: region is page-aligned, large enough & table consists of
+        // atomics only, for which any bit pattern is valid.
+        unsafe { &*self.region.as_ptr().cast::<LatestTable<N>>() }
+    }
+}
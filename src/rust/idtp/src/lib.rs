@@ -19,22 +19,66 @@
     missing_docs
 )]
 
+#[cfg(feature = "std_payloads")]
+pub mod batch;
+pub mod clock;
+pub mod coalesce;
+#[cfg(feature = "cobs")]
+pub mod cobs;
+#[cfg(feature = "std_payloads")]
+pub mod compress;
+#[cfg(feature = "crc_correction")]
+pub mod correction;
+#[cfg(feature = "std")]
+extern crate std;
+
 #[cfg(feature = "software_impl")]
 pub mod crypto;
+pub mod dedup;
+pub mod dispatch;
+pub mod fec;
+pub mod filter;
+#[cfg(feature = "header_compression")]
+pub mod hcomp;
+#[cfg(any(feature = "embedded_io", feature = "embedded_io_async"))]
+pub mod io;
+#[cfg(all(feature = "software_impl", target_has_atomic = "32"))]
+pub mod keystore;
+#[cfg(target_has_atomic = "32")]
+pub mod latest;
+#[cfg(feature = "std")]
+pub mod merge;
 pub mod payload;
+#[cfg(feature = "pipeline")]
+pub mod pipeline;
+#[cfg(target_has_atomic = "32")]
+pub mod pool;
+#[cfg(feature = "std_payloads")]
+pub mod quantized;
+pub mod reorder;
+#[cfg(all(feature = "shm", target_os = "linux"))]
+pub mod shm;
+#[cfg(feature = "std")]
+pub mod validator;
 
 #[macro_use]
 pub mod macros;
 
+mod decoder;
 mod frame;
 mod header;
+#[cfg(any(feature = "std_payloads", feature = "header_compression"))]
+mod varint;
 
+pub use decoder::*;
 pub use frame::*;
 pub use header::*;
 use zerocopy::{FromBytes, Immutable, IntoBytes, KnownLayout};
 
-/// Protocol errors enumeration.
+/// Protocol errors enumeration. New variants MAY be added in minor
+/// releases.
 #[derive(Debug)]
+#[non_exhaustive]
 pub enum IdtpError {
     /// Buffer too short.
     BufferUnderflow,
@@ -48,6 +92,8 @@ pub enum IdtpError {
     InvalidHMacKey,
     /// Error to convert from/to bytes.
     ParseError,
+    /// Underlying I/O error or unexpected end of stream.
+    IoError,
 }
 
 /// Result alias for IDTP.
@@ -0,0 +1,332 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Timestamp-ordered merge of multiple device streams.
+//!
+//! Frames of each source (device) are queued in timestamp order & merged
+//! into a single time-ordered stream with a tournament tree, so each
+//! released frame costs `O(log k)` comparisons for `k` sources. Timestamps
+//! of each source are shifted by its clock offset before comparison. An empty
+//! source blocks the merge until its frames arrive or until the watermark
+//! (the latest seen timestamp minus allowed lag) passes it, so a silent
+//! device does not stall the stream forever.
+
+use std::{collections::VecDeque, vec, vec::Vec};
+
+/// Merge stream statistics.
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct MergeStats {
+    /// Number of released frames.
+    pub released: u64,
+    /// Number of frames rejected because they are older than released ones.
+    pub late: u64,
+}
+
+/// Frame released by merge stream.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Merged<T> {
+    /// Source index.
+    pub source: usize,
+    /// Timestamp shifted by source clock offset.
+    pub timestamp: u64,
+    /// Frame item.
+    pub item: T,
+}
+
+/// Merge key of source. Keys are compared by timestamp, then by rank.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord)]
+struct Key {
+    /// Timestamp of the first queued frame or lower bound of the next one.
+    timestamp: u64,
+    /// Source state: blocking sources win ties, idle sources always lose.
+    rank: u8,
+    /// Source index.
+    source: usize,
+}
+
+/// Rank of empty source that blocks merge.
+const RANK_BLOCKING: u8 = 0;
+
+/// Rank of source with queued frames.
+const RANK_READY: u8 = 1;
+
+/// Rank of empty source excluded from merge by watermark.
+const RANK_IDLE: u8 = 2;
+
+/// Per-source state.
+#[derive(Debug)]
+struct Source<T> {
+    /// Queued frames with shifted timestamps.
+    queue: VecDeque<(u64, T)>,
+    /// Clock offset added to source timestamps.
+    offset: i64,
+    /// The latest shifted timestamp of source.
+    last_seen: u64,
+    /// Source is excluded from merge until its next frame.
+    idle: bool,
+}
+
+/// Timestamp-ordered merge of multiple sources.
+#[derive(Debug)]
+pub struct MergeStream<T> {
+    /// Sources state.
+    sources: Vec<Source<T>>,
+    /// Tournament tree: node `n` holds winner of nodes `2n` & `2n + 1`,
+    /// nodes `k..2k` are source leaves.
+    tree: Vec<usize>,
+    /// Max allowed lag of a source behind the latest seen timestamp.
+    max_lag: u64,
+    /// The latest seen timestamp across all sources.
+    max_seen: u64,
+    /// Timestamp of the last released frame.
+    released: u64,
+    /// Merge statistics.
+    stats: MergeStats,
+}
+
+impl<T> MergeStream<T> {
+    /// Construct new `MergeStream` object.
+    ///
+    /// # Parameters
+    /// - `sources` - given number of sources.
+    /// - `max_lag` - given max time to wait for a silent source, in units of
+    ///   frame timestamps.
+    ///
+    /// # Returns
+    /// - New `MergeStream` object.
+    #[must_use]
+    pub fn new(sources: usize, max_lag: u64) -> Self {
+        let sources = sources.max(1);
+        let mut stream = Self {
+            sources: (0..sources)
+                .map(|_| Source {
+                    queue: VecDeque::new(),
+                    offset: 0,
+                    last_seen: 0,
+                    idle: false,
+                })
+                .collect(),
+            tree: vec![0; sources],
+            max_lag,
+            max_seen: 0,
+            released: 0,
+            stats: MergeStats::default(),
+        };
+
+        for node in (1..sources).rev() {
+            stream.play(node);
+        }
+
+        stream
+    }
+
+    /// Get merge statistics.
+    ///
+    /// # Returns
+    /// - Merge statistics.
+    #[inline]
+    #[must_use]
+    pub const fn stats(&self) -> &MergeStats {
+        &self.stats
+    }
+
+    /// Set source clock offset.
+    ///
+    /// # Parameters
+    /// - `source` - given source index.
+    /// - `offset` - given offset added to source timestamps.
+    ///
+    /// # Returns
+    /// - `true` - if offset was set.
+    /// - `false` - if source index is invalid or source has queued frames.
+    pub fn set_offset(&mut self, source: usize, offset: i64) -> bool {
+        match self.sources.get_mut(source) {
+            Some(state) if state.queue.is_empty() => {
+                state.offset = offset;
+                true
+            }
+            _ => false,
+        }
+    }
+
+    /// Advance watermark with external clock, e.g. host time converted to
+    /// frame timestamp units. Used to release frames when all sources are
+    /// silent.
+    ///
+    /// # Parameters
+    /// - `now` - given current time.
+    pub fn advance(&mut self, now: u64) {
+        self.max_seen = self.max_seen.max(now);
+    }
+
+    /// Queue frame of source. Timestamps of each source **MUST** be
+    /// non-decreasing.
+    ///
+    /// # Parameters
+    /// - `source` - given source index.
+    /// - `timestamp` - given frame timestamp.
+    /// - `item` - given frame to queue.
+    ///
+    /// # Returns
+    /// - `Ok` - if frame was queued.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Given frame, if source index is invalid or frame is older than
+    ///   already released or queued frames.
+    pub fn push(
+        &mut self,
+        source: usize,
+        timestamp: u64,
+        item: T,
+    ) -> Result<(), T> {
+        let Some(state) = self.sources.get_mut(source) else {
+            return Err(item);
+        };
+
+        let timestamp = timestamp.saturating_add_signed(state.offset);
+
+        if timestamp < self.released || timestamp < state.last_seen {
+            self.stats.late += 1;
+            return Err(item);
+        }
+
+        let was_empty = state.queue.is_empty();
+
+        state.queue.push_back((timestamp, item));
+        state.last_seen = timestamp;
+        state.idle = false;
+        self.max_seen = self.max_seen.max(timestamp);
+
+        if was_empty {
+            self.update(source);
+        }
+
+        Ok(())
+    }
+
+    /// Release the earliest frame.
+    ///
+    /// # Returns
+    /// - The earliest frame - if no non-idle source can deliver an earlier
+    ///   one.
+    /// - `None` - otherwise.
+    pub fn pop(&mut self) -> Option<Merged<T>> {
+        let source = loop {
+            let winner = self.winner(1);
+
+            match self.key(winner).rank {
+                RANK_READY => break winner,
+                RANK_BLOCKING if self.is_behind(winner) => {
+                    if let Some(state) = self.sources.get_mut(winner) {
+                        state.idle = true;
+                    }
+                    self.update(winner);
+                }
+                _ => return None,
+            }
+        };
+
+        let (timestamp, item) =
+            self.sources.get_mut(source)?.queue.pop_front()?;
+
+        self.released = timestamp;
+        self.stats.released += 1;
+        self.update(source);
+
+        Some(Merged {
+            source,
+            timestamp,
+            item,
+        })
+    }
+
+    /// Check whether source is behind watermark.
+    ///
+    /// # Parameters
+    /// - `source` - given source index.
+    ///
+    /// # Returns
+    /// - `true` - if source is behind watermark.
+    /// - `false` - otherwise.
+    fn is_behind(&self, source: usize) -> bool {
+        self.sources.get(source).is_none_or(|state| {
+            state.last_seen.saturating_add(self.max_lag) < self.max_seen
+        })
+    }
+
+    /// Get merge key of source.
+    ///
+    /// # Parameters
+    /// - `source` - given source index.
+    ///
+    /// # Returns
+    /// - Merge key of source.
+    fn key(&self, source: usize) -> Key {
+        let (timestamp, rank) =
+            self.sources
+                .get(source)
+                .map_or((u64::MAX, RANK_IDLE), |state| {
+                    match state.queue.front() {
+                        Some((timestamp, _)) => (*timestamp, RANK_READY),
+                        None if state.idle => (u64::MAX, RANK_IDLE),
+                        None => (state.last_seen, RANK_BLOCKING),
+                    }
+                });
+
+        Key {
+            timestamp,
+            rank,
+            source,
+        }
+    }
+
+    /// Get winner of tree node.
+    ///
+    /// # Parameters
+    /// - `node` - given tree node.
+    ///
+    /// # Returns
+    /// - Source index of node winner.
+    fn winner(&self, node: usize) -> usize {
+        let count = self.sources.len();
+
+        if node >= count {
+            node - count
+        } else {
+            self.tree.get(node).copied().unwrap_or_default()
+        }
+    }
+
+    /// Play match of tree node children.
+    ///
+    /// # Parameters
+    /// - `node` - given tree node.
+    fn play(&mut self, node: usize) {
+        let left = self.winner(2 * node);
+        let right = self.winner(2 * node + 1);
+        let winner = if self.key(right) < self.key(left) {
+            right
+        } else {
+            left
+        };
+
+        if let Some(slot) = self.tree.get_mut(node) {
+            *slot = winner;
+        }
+    }
+
+    /// Replay matches from source leaf to the root after its key changed.
+    ///
+    /// # Parameters
+    /// - `source` - given source index.
+    fn update(&mut self, source: usize) {
+        let leaf = source + self.sources.len();
+        let mut node = leaf / 2;
+
+        while node > 0 {
+            self.play(node);
+            node /= 2;
+        }
+    }
+}
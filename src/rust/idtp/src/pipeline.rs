@@ -0,0 +1,799 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Multi-stage receive pipeline.
+//!
+//! Receiving, validation, decoding & dispatch are performed by separate
+//! worker threads connected with bounded lock-free SPSC queues. Items are
+//! handed over in batches, so queue synchronization cost is amortized over
+//! several frames. Each worker can be pinned to a dedicated core & exposes
+//! counters of processed items, processing latency & input queue occupancy.
+
+use crate::{IdtpError, IdtpResult};
+use core::{
+    cell::UnsafeCell,
+    mem::MaybeUninit,
+    sync::atomic::{AtomicBool, AtomicU64, AtomicUsize, Ordering},
+};
+use std::{
+    boxed::Box,
+    sync::Arc,
+    thread::{self, JoinHandle},
+    time::Instant,
+    vec::Vec,
+};
+
+/// Number of pipeline stages.
+pub const STAGE_COUNT: usize = 4;
+
+/// Number of spin iterations before idle worker yields.
+const SPIN_LIMIT: u32 = 64;
+
+/// Value aligned to cache line to prevent false sharing.
+#[repr(align(64))]
+struct CachePadded<T>(T);
+
+/// State shared between queue sender & receiver.
+struct Shared<T> {
+    /// Index of the next item to pop.
+    head: CachePadded<AtomicUsize>,
+    /// Index of the next item to push.
+    tail: CachePadded<AtomicUsize>,
+    /// Sender was dropped.
+    closed: AtomicBool,
+    /// Receiver was dropped.
+    disconnected: AtomicBool,
+    /// Mask to convert index to slot position.
+    mask: usize,
+    /// Queue slots.
+    slots: Box<[UnsafeCell<MaybeUninit<T>>]>,
+}
+
+// SAFETY: each slot is accessed either by sender or by receiver, ownership is
+// transferred with acquire/release synchronization of head & tail.
+unsafe impl<T: Send> Sync for Shared<T> {}
+
+impl<T> Shared<T> {
+    /// Get pointer to slot.
+    ///
+    /// # Parameters
+    /// - `index` - given item index.
+    ///
+    /// # Returns
+    /// - Pointer to slot - in case of success.
+    /// - `None` - otherwise.
+    fn slot(&self, index: usize) -> Option<*mut MaybeUninit<T>> {
+        self.slots.get(index & self.mask).map(UnsafeCell::get)
+    }
+}
+
+impl<T> Drop for Shared<T> {
+    /// Drop items left in queue.
+    fn drop(&mut self) {
+        let head = self.head.0.load(Ordering::Relaxed);
+        let tail = self.tail.0.load(Ordering::Relaxed);
+
+        for index in head..tail {
+            if let Some(slot) = self.slot(index) {
+                // SAFETY: slots between head & tail are initialized.
+                unsafe { (*slot).assume_init_drop() };
+            }
+        }
+    }
+}
+
+/// Construct new bounded SPSC queue.
+///
+/// # Parameters
+/// - `capacity` - given queue capacity. It is rounded up to power of two.
+///
+/// # Returns
+/// - Queue sender & receiver.
+#[must_use]
+pub fn spsc_queue<T: Send>(
+    capacity: usize,
+) -> (SpscSender<T>, SpscReceiver<T>) {
+    let capacity = capacity.max(1).next_power_of_two();
+    let slots = (0..capacity)
+        .map(|_| UnsafeCell::new(MaybeUninit::uninit()))
+        .collect();
+
+    let shared = Arc::new(Shared {
+        head: CachePadded(AtomicUsize::new(0)),
+        tail: CachePadded(AtomicUsize::new(0)),
+        closed: AtomicBool::new(false),
+        disconnected: AtomicBool::new(false),
+        mask: capacity - 1,
+        slots,
+    });
+
+    let sender = SpscSender {
+        shared: Arc::clone(&shared),
+        head: 0,
+        tail: 0,
+    };
+
+    let receiver = SpscReceiver {
+        shared,
+        head: 0,
+        tail: 0,
+    };
+
+    (sender, receiver)
+}
+
+/// Sending half of SPSC queue. Queue is closed when sender is dropped.
+pub struct SpscSender<T> {
+    /// Shared queue state.
+    shared: Arc<Shared<T>>,
+    /// Cached receiver index.
+    head: usize,
+    /// Local sender index.
+    tail: usize,
+}
+
+impl<T: Send> SpscSender<T> {
+    /// Push items from the front of batch. Pushed items are removed from
+    /// batch.
+    ///
+    /// # Parameters
+    /// - `batch` - given items to push.
+    ///
+    /// # Returns
+    /// - Number of pushed items.
+    pub fn push_batch(&mut self, batch: &mut Vec<T>) -> usize {
+        let capacity = self.shared.mask + 1;
+
+        if self.tail - self.head + batch.len() > capacity {
+            self.head = self.shared.head.0.load(Ordering::Acquire);
+        }
+
+        let count = batch.len().min(capacity - (self.tail - self.head));
+
+        for item in batch.drain(..count) {
+            if let Some(slot) = self.shared.slot(self.tail) {
+                // SAFETY: slot is free, receiver has released it.
+                unsafe { (*slot).write(item) };
+                self.tail += 1;
+            }
+        }
+
+        self.shared.tail.0.store(self.tail, Ordering::Release);
+        count
+    }
+
+    /// Push all items of batch, waiting for free slots.
+    ///
+    /// # Parameters
+    /// - `batch` - given items to push.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error - if receiver was dropped.
+    pub fn push_all(&mut self, batch: &mut Vec<T>) -> IdtpResult<()> {
+        let mut spins = 0;
+
+        while !batch.is_empty() {
+            if self.shared.disconnected.load(Ordering::Relaxed) {
+                batch.clear();
+                return Err(IdtpError::IoError);
+            }
+
+            if self.push_batch(batch) == 0 {
+                backoff(&mut spins);
+            } else {
+                spins = 0;
+            }
+        }
+
+        Ok(())
+    }
+}
+
+impl<T> Drop for SpscSender<T> {
+    /// Close queue.
+    fn drop(&mut self) {
+        self.shared.closed.store(true, Ordering::Release);
+    }
+}
+
+/// Receiving half of SPSC queue.
+pub struct SpscReceiver<T> {
+    /// Shared queue state.
+    shared: Arc<Shared<T>>,
+    /// Local receiver index.
+    head: usize,
+    /// Cached sender index.
+    tail: usize,
+}
+
+impl<T: Send> SpscReceiver<T> {
+    /// Get number of items in queue.
+    ///
+    /// # Returns
+    /// - Number of items in queue.
+    #[must_use]
+    pub fn len(&self) -> usize {
+        self.shared.tail.0.load(Ordering::Acquire) - self.head
+    }
+
+    /// Check whether queue is empty.
+    ///
+    /// # Returns
+    /// - `true` - if queue is empty.
+    /// - `false` - otherwise.
+    #[must_use]
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Check whether queue is closed & drained.
+    ///
+    /// # Returns
+    /// - `true` - if sender was dropped and there are no items left.
+    /// - `false` - otherwise.
+    #[must_use]
+    pub fn is_finished(&self) -> bool {
+        self.shared.closed.load(Ordering::Acquire) && self.is_empty()
+    }
+
+    /// Pop batch of items.
+    ///
+    /// # Parameters
+    /// - `batch` - given buffer to append popped items.
+    /// - `max` - given max number of items to pop.
+    ///
+    /// # Returns
+    /// - Number of popped items.
+    pub fn pop_batch(&mut self, batch: &mut Vec<T>, max: usize) -> usize {
+        if self.tail - self.head < max {
+            self.tail = self.shared.tail.0.load(Ordering::Acquire);
+        }
+
+        let count = max.min(self.tail - self.head);
+        batch.reserve(count);
+
+        for _ in 0..count {
+            if let Some(slot) = self.shared.slot(self.head) {
+                // SAFETY: slot is initialized, sender has published it.
+                batch.push(unsafe { (*slot).assume_init_read() });
+                self.head += 1;
+            }
+        }
+
+        self.shared.head.0.store(self.head, Ordering::Release);
+        count
+    }
+}
+
+impl<T> Drop for SpscReceiver<T> {
+    /// Disconnect queue.
+    fn drop(&mut self) {
+        self.shared.disconnected.store(true, Ordering::Relaxed);
+    }
+}
+
+/// Wait for queue progress.
+///
+/// # Parameters
+/// - `spins` - given number of unsuccessful attempts.
+fn backoff(spins: &mut u32) {
+    if *spins < SPIN_LIMIT {
+        *spins += 1;
+        core::hint::spin_loop();
+    } else {
+        thread::yield_now();
+    }
+}
+
+/// Pin current thread to core.
+///
+/// # Parameters
+/// - `core` - given core index.
+///
+/// # Returns
+/// - `true` - if thread was pinned.
+/// - `false` - otherwise.
+#[cfg(target_os = "linux")]
+#[must_use]
+pub fn pin_current_thread(core: usize) -> bool {
+    #[allow(clippy::cast_sign_loss)]
+    if core >= libc::CPU_SETSIZE as usize {
+        return false;
+    }
+
+    // SAFETY: CPU set is plain data & index is checked above.
+    unsafe {
+        let mut set: libc::cpu_set_t = core::mem::zeroed();
+        libc::CPU_SET(core, &mut set);
+        libc::sched_setaffinity(0, size_of::<libc::cpu_set_t>(), &raw const set)
+            == 0
+    }
+}
+
+/// Pin current thread to core.
+///
+/// # Parameters
+/// - `core` - given core index.
+///
+/// # Returns
+/// - `false` - thread pinning is not supported on this platform.
+#[cfg(not(target_os = "linux"))]
+#[must_use]
+pub const fn pin_current_thread(_core: usize) -> bool {
+    false
+}
+
+/// Pipeline stage.
+#[repr(usize)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Stage {
+    /// Frame receiving.
+    Rx = 0,
+    /// Frame validation.
+    Validate = 1,
+    /// Payload decoding.
+    Decode = 2,
+    /// Application dispatch.
+    Dispatch = 3,
+}
+
+/// Pipeline configuration.
+#[derive(Debug, Clone, Copy)]
+pub struct PipelineConfig {
+    /// Capacity of each inter-stage queue.
+    pub capacity: usize,
+    /// Max number of items handed over per queue operation.
+    pub batch_size: usize,
+    /// Core to pin each stage to.
+    pub cores: [Option<usize>; STAGE_COUNT],
+}
+
+impl Default for PipelineConfig {
+    /// Construct default pipeline configuration.
+    ///
+    /// # Returns
+    /// - New default pipeline configuration.
+    fn default() -> Self {
+        Self {
+            capacity: 1024,
+            batch_size: 32,
+            cores: [None; STAGE_COUNT],
+        }
+    }
+}
+
+/// Live counters of pipeline stage.
+#[derive(Debug, Default)]
+struct StageCounters {
+    /// Number of processed items.
+    items: AtomicU64,
+    /// Number of processed batches.
+    batches: AtomicU64,
+    /// Total batch processing time in nanoseconds.
+    busy_ns: AtomicU64,
+    /// Max batch processing time in nanoseconds.
+    max_batch_ns: AtomicU64,
+    /// Sum of input queue lengths observed before each batch.
+    occupancy: AtomicU64,
+    /// Stage core pinning succeeded.
+    pinned: AtomicBool,
+}
+
+impl StageCounters {
+    /// Record processed batch without processing time.
+    ///
+    /// # Parameters
+    /// - `items` - given number of processed items.
+    /// - `queued` - given input queue length before batch.
+    fn count(&self, items: usize, queued: usize) {
+        self.items.fetch_add(items as u64, Ordering::Relaxed);
+        self.batches.fetch_add(1, Ordering::Relaxed);
+        self.occupancy.fetch_add(queued as u64, Ordering::Relaxed);
+    }
+
+    /// Record processed batch.
+    ///
+    /// # Parameters
+    /// - `items` - given number of processed items.
+    /// - `queued` - given input queue length before batch.
+    /// - `start` - given batch processing start time.
+    #[allow(clippy::cast_possible_truncation)]
+    fn record(&self, items: usize, queued: usize, start: Instant) {
+        let elapsed = start.elapsed().as_nanos() as u64;
+
+        self.count(items, queued);
+        self.busy_ns.fetch_add(elapsed, Ordering::Relaxed);
+        self.max_batch_ns.fetch_max(elapsed, Ordering::Relaxed);
+    }
+
+    /// Get counters snapshot.
+    ///
+    /// # Returns
+    /// - Stage statistics.
+    fn snapshot(&self) -> StageStats {
+        StageStats {
+            items: self.items.load(Ordering::Relaxed),
+            batches: self.batches.load(Ordering::Relaxed),
+            busy_ns: self.busy_ns.load(Ordering::Relaxed),
+            max_batch_ns: self.max_batch_ns.load(Ordering::Relaxed),
+            occupancy: self.occupancy.load(Ordering::Relaxed),
+            pinned: self.pinned.load(Ordering::Relaxed),
+        }
+    }
+}
+
+/// Snapshot of pipeline stage counters.
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct StageStats {
+    /// Number of processed items.
+    pub items: u64,
+    /// Number of processed batches.
+    pub batches: u64,
+    /// Total batch processing time in nanoseconds. Always 0 for
+    /// `Stage::Rx`: time spent in receive closure is mostly waiting for
+    /// input, not processing.
+    pub busy_ns: u64,
+    /// Max batch processing time in nanoseconds.
+    pub max_batch_ns: u64,
+    /// Sum of input queue lengths observed before each batch.
+    pub occupancy: u64,
+    /// Stage is pinned to core.
+    pub pinned: bool,
+}
+
+impl StageStats {
+    /// Get mean processing latency per item.
+    ///
+    /// # Returns
+    /// - Mean latency in nanoseconds.
+    #[must_use]
+    pub fn mean_latency_ns(&self) -> u64 {
+        self.busy_ns.checked_div(self.items).unwrap_or_default()
+    }
+
+    /// Get mean input queue occupancy.
+    ///
+    /// # Returns
+    /// - Mean number of queued items per batch.
+    #[must_use]
+    pub fn mean_occupancy(&self) -> u64 {
+        self.occupancy.checked_div(self.batches).unwrap_or_default()
+    }
+}
+
+/// Running multi-stage receive pipeline. Dropping pipeline shuts it down
+/// & waits for worker threads.
+pub struct Pipeline {
+    /// Stage worker threads.
+    workers: Vec<JoinHandle<()>>,
+    /// Stage counters.
+    counters: Arc<[StageCounters; STAGE_COUNT]>,
+    /// Receive stage must stop.
+    stop: Arc<AtomicBool>,
+}
+
+impl Pipeline {
+    /// Spawn pipeline worker threads.
+    ///
+    /// # Parameters
+    /// - `config` - given pipeline configuration.
+    /// - `rx` - given closure that appends received items to batch. Pipeline
+    ///   is shut down when it returns `false`. It **SHOULD** return
+    ///   periodically (e.g. on read timeout), so `shutdown` takes effect.
+    /// - `validate` - given closure that checks item (e.g. with
+    ///   `IdtpFrame::validate_with`). Invalid items are dropped.
+    /// - `decode` - given closure that decodes item. Items are dropped when
+    ///   it returns `None`.
+    /// - `dispatch` - given closure that consumes decoded item.
+    ///
+    /// # Returns
+    /// - New running pipeline - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error - if worker thread cannot be spawned. Already spawned
+    ///   workers are shut down & joined.
+    pub fn spawn<T, U, R, V, D, H>(
+        config: &PipelineConfig,
+        rx: R,
+        validate: V,
+        decode: D,
+        dispatch: H,
+    ) -> IdtpResult<Self>
+    where
+        T: Send + 'static,
+        U: Send + 'static,
+        R: FnMut(&mut Vec<T>) -> bool + Send + 'static,
+        V: FnMut(&T) -> bool + Send + 'static,
+        D: FnMut(T) -> Option<U> + Send + 'static,
+        H: FnMut(U) + Send + 'static,
+    {
+        let counters =
+            Arc::new(core::array::from_fn(|_| StageCounters::default()));
+        // Partially spawned pipeline is shut down on drop in case of error.
+        let mut pipeline = Self {
+            workers: Vec::with_capacity(STAGE_COUNT),
+            counters,
+            stop: Arc::new(AtomicBool::new(false)),
+        };
+
+        let (rx_sender, validate_receiver) = spsc_queue(config.capacity);
+        let (validate_sender, decode_receiver) = spsc_queue(config.capacity);
+        let (decode_sender, dispatch_receiver) = spsc_queue(config.capacity);
+
+        pipeline.spawn_rx(config, rx_sender, rx)?;
+
+        let mut validate = validate;
+        pipeline.spawn_stage(
+            config,
+            Stage::Validate,
+            validate_receiver,
+            Some(validate_sender),
+            move |item, output| {
+                if validate(&item) {
+                    output.push(item);
+                }
+            },
+        )?;
+
+        let mut decode = decode;
+        pipeline.spawn_stage(
+            config,
+            Stage::Decode,
+            decode_receiver,
+            Some(decode_sender),
+            move |item, output| output.extend(decode(item)),
+        )?;
+
+        let mut dispatch = dispatch;
+        pipeline.spawn_stage::<U, (), _>(
+            config,
+            Stage::Dispatch,
+            dispatch_receiver,
+            None,
+            move |item, _| dispatch(item),
+        )?;
+
+        Ok(pipeline)
+    }
+
+    /// Get stage statistics.
+    ///
+    /// # Parameters
+    /// - `stage` - given pipeline stage.
+    ///
+    /// # Returns
+    /// - Stage statistics.
+    #[must_use]
+    pub fn stats(&self, stage: Stage) -> StageStats {
+        self.counters
+            .get(stage as usize)
+            .map(StageCounters::snapshot)
+            .unwrap_or_default()
+    }
+
+    /// Wait for pipeline shutdown, e.g. when receive closure returns `false`.
+    ///
+    /// # Returns
+    /// - Final statistics of each stage - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error - if worker thread panicked.
+    pub fn join(mut self) -> IdtpResult<[StageStats; STAGE_COUNT]> {
+        self.join_workers()?;
+        Ok(self.counters.each_ref().map(StageCounters::snapshot))
+    }
+
+    /// Shut pipeline down: stop receive stage after current call of receive
+    /// closure, let other stages drain their queues & wait for them.
+    ///
+    /// # Returns
+    /// - Final statistics of each stage - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error - if worker thread panicked.
+    pub fn shutdown(self) -> IdtpResult<[StageStats; STAGE_COUNT]> {
+        self.stop.store(true, Ordering::Relaxed);
+        self.join()
+    }
+
+    /// Join all worker threads.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error - if worker thread panicked.
+    fn join_workers(&mut self) -> IdtpResult<()> {
+        let mut result = Ok(());
+
+        for worker in self.workers.drain(..) {
+            if worker.join().is_err() {
+                result = Err(IdtpError::IoError);
+            }
+        }
+
+        result
+    }
+
+    /// Spawn worker thread of receive stage.
+    ///
+    /// # Parameters
+    /// - `config` - given pipeline configuration.
+    /// - `output` - given output queue.
+    /// - `rx` - given receive closure.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error - if worker thread cannot be spawned.
+    fn spawn_rx<T, R>(
+        &mut self,
+        config: &PipelineConfig,
+        mut output: SpscSender<T>,
+        mut rx: R,
+    ) -> IdtpResult<()>
+    where
+        T: Send + 'static,
+        R: FnMut(&mut Vec<T>) -> bool + Send + 'static,
+    {
+        let counters = Arc::clone(&self.counters);
+        let stop = Arc::clone(&self.stop);
+        let batch_size = config.batch_size.max(1);
+
+        // Output queue is closed when worker returns.
+        self.spawn_worker(config, Stage::Rx, move || {
+            let Some(counters) = counters.get(Stage::Rx as usize) else {
+                return;
+            };
+            let mut batch = Vec::with_capacity(batch_size);
+
+            while !stop.load(Ordering::Relaxed) {
+                let running = rx(&mut batch);
+
+                if !batch.is_empty() {
+                    counters.count(batch.len(), 0);
+
+                    if output.push_all(&mut batch).is_err() {
+                        return;
+                    }
+                }
+
+                if !running {
+                    return;
+                }
+            }
+        })
+    }
+
+    /// Spawn worker thread of intermediate or final stage.
+    ///
+    /// # Parameters
+    /// - `config` - given pipeline configuration.
+    /// - `stage` - given pipeline stage.
+    /// - `input` - given input queue.
+    /// - `output` - given output queue or `None` for final stage.
+    /// - `process` - given closure that handles item & appends results to
+    ///   output batch.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error - if worker thread cannot be spawned.
+    fn spawn_stage<I, O, F>(
+        &mut self,
+        config: &PipelineConfig,
+        stage: Stage,
+        mut input: SpscReceiver<I>,
+        mut output: Option<SpscSender<O>>,
+        mut process: F,
+    ) -> IdtpResult<()>
+    where
+        I: Send + 'static,
+        O: Send + 'static,
+        F: FnMut(I, &mut Vec<O>) + Send + 'static,
+    {
+        let counters = Arc::clone(&self.counters);
+        let batch_size = config.batch_size.max(1);
+
+        self.spawn_worker(config, stage, move || {
+            let Some(counters) = counters.get(stage as usize) else {
+                return;
+            };
+            let mut inbox = Vec::with_capacity(batch_size);
+            let mut outbox = Vec::with_capacity(batch_size);
+            let mut spins = 0;
+
+            loop {
+                let queued = input.len();
+
+                if input.pop_batch(&mut inbox, batch_size) == 0 {
+                    if input.is_finished() {
+                        return;
+                    }
+                    backoff(&mut spins);
+                    continue;
+                }
+
+                spins = 0;
+                let start = Instant::now();
+                let count = inbox.len();
+
+                for item in inbox.drain(..count) {
+                    process(item, &mut outbox);
+                }
+
+                counters.record(count, queued, start);
+
+                if let Some(output) = output.as_mut()
+                    && output.push_all(&mut outbox).is_err()
+                {
+                    return;
+                }
+            }
+        })
+    }
+
+    /// Spawn stage worker thread.
+    ///
+    /// # Parameters
+    /// - `config` - given pipeline configuration.
+    /// - `stage` - given pipeline stage.
+    /// - `run` - given worker loop.
+    ///
+    /// # Returns
+    /// - `Ok` - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error - if worker thread cannot be spawned.
+    fn spawn_worker<F>(
+        &mut self,
+        config: &PipelineConfig,
+        stage: Stage,
+        run: F,
+    ) -> IdtpResult<()>
+    where
+        F: FnOnce() + Send + 'static,
+    {
+        let core = config.cores.get(stage as usize).copied().flatten();
+        let counters = Arc::clone(&self.counters);
+
+        let worker = thread::Builder::new()
+            .name(std::format!("idtp-{stage:?}").to_lowercase())
+            .spawn(move || {
+                if let Some(core) = core
+                    && let Some(counters) = counters.get(stage as usize)
+                {
+                    let pinned = pin_current_thread(core);
+                    counters.pinned.store(pinned, Ordering::Relaxed);
+                }
+                run();
+            })
+            .map_err(|_| IdtpError::IoError)?;
+
+        self.workers.push(worker);
+        Ok(())
+    }
+}
+
+impl Drop for Pipeline {
+    /// Shut pipeline down & wait for worker threads.
+    fn drop(&mut self) {
+        self.stop.store(true, Ordering::Relaxed);
+
+        // Panics of workers are reported by `join` & `shutdown` only.
+        let _ = self.join_workers();
+    }
+}
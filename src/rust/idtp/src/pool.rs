@@ -0,0 +1,338 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Lock-free pool of IDTP frame buffers.
+//!
+//! Pool is a fixed array of `IDTP_FRAME_MAX_SIZE` slots with lock-free free
+//! list (Treiber stack with tagged indices). Slots are handed out as RAII
+//! handles, which can be moved between threads, so frames are passed along
+//! pipeline with no copies & no allocations. Pool can be placed in `static`
+//! memory, which makes it suitable for `no_std` environments.
+
+use crate::{IDTP_FRAME_MAX_SIZE, IdtpError, IdtpResult};
+use core::{
+    cell::UnsafeCell,
+    ops::{Deref, DerefMut},
+    sync::atomic::{AtomicU32, Ordering},
+};
+
+#[cfg(target_has_atomic = "64")]
+use core::sync::atomic::AtomicU64;
+
+/// Tagged free list head: 16-bit index & 48-bit ABA tag.
+#[cfg(target_has_atomic = "64")]
+type Head = u64;
+
+/// Atomic tagged free list head.
+#[cfg(target_has_atomic = "64")]
+type AtomicHead = AtomicU64;
+
+/// Tagged free list head: 16-bit index & 16-bit ABA tag on targets without
+/// 64-bit atomics (e.g. Cortex-M).
+#[cfg(not(target_has_atomic = "64"))]
+type Head = u32;
+
+/// Atomic tagged free list head.
+#[cfg(not(target_has_atomic = "64"))]
+type AtomicHead = AtomicU32;
+
+/// Index value that marks the end of free list.
+const NIL: u32 = 0xFFFF;
+
+/// Mask of index part of tagged free list head.
+const INDEX_MASK: Head = 0xFFFF;
+
+/// Increment of tag part of tagged free list head.
+const TAG_STEP: Head = 0x1_0000;
+
+/// Lock-free pool of IDTP frame buffers.
+///
+/// Free list head carries an ABA tag that is incremented by every acquire &
+/// release. Tag wraps after 2^48 operations where 64-bit atomics are
+/// available & after 65,536 operations otherwise. On the latter targets the
+/// free list can be corrupted if a thread is preempted between loading the
+/// head & its `compare_exchange` while other threads perform exactly a
+/// multiple of 65,536 operations, e.g. ~0.65 s at 100k frames/s.
+///
+/// # Parameters
+/// - `N` - number of frame buffers. **MUST** be less than `0xFFFF`.
+pub struct FramePool<const N: usize> {
+    /// Frame buffers.
+    slots: [UnsafeCell<[u8; IDTP_FRAME_MAX_SIZE]>; N],
+    /// Free list links.
+    next: [AtomicU32; N],
+    /// Tagged index of the first free slot.
+    head: AtomicHead,
+}
+
+// SAFETY: each slot is accessed only by the owner of its handle, ownership is
+// transferred through free list with acquire/release synchronization.
+unsafe impl<const N: usize> Sync for FramePool<N> {}
+
+impl<const N: usize> FramePool<N> {
+    /// Construct new `FramePool` object.
+    ///
+    /// # Returns
+    /// - New `FramePool` object.
+    #[must_use]
+    #[allow(clippy::cast_possible_truncation, clippy::indexing_slicing)]
+    pub const fn new() -> Self {
+        const {
+            assert!(N > 0 && N < NIL as usize, "invalid pool capacity");
+        }
+
+        let mut next = [const { AtomicU32::new(NIL) }; N];
+        let mut i = 0;
+
+        while i + 1 < N {
+            next[i] = AtomicU32::new(i as u32 + 1);
+            i += 1;
+        }
+
+        Self {
+            slots: [const { UnsafeCell::new([0u8; IDTP_FRAME_MAX_SIZE]) }; N],
+            next,
+            head: AtomicHead::new(0),
+        }
+    }
+
+    /// Construct new `FramePool` object on heap without placing it on stack.
+    ///
+    /// # Returns
+    /// - New boxed `FramePool` object.
+    #[cfg(feature = "std")]
+    #[must_use]
+    #[allow(clippy::cast_possible_truncation)]
+    pub fn boxed() -> std::boxed::Box<Self> {
+        const {
+            assert!(N > 0 && N < NIL as usize, "invalid pool capacity");
+        }
+
+        let layout = std::alloc::Layout::new::<Self>();
+
+        // SAFETY: layout has non-zero size & all-zero bit pattern is valid
+        // for byte buffers & atomics.
+        let pool = unsafe {
+            let memory = std::alloc::alloc_zeroed(layout).cast::<Self>();
+
+            if memory.is_null() {
+                std::alloc::handle_alloc_error(layout);
+            }
+
+            std::boxed::Box::from_raw(memory)
+        };
+
+        for (i, next) in pool.next.iter().enumerate() {
+            let link = if i + 1 < N { i as u32 + 1 } else { NIL };
+            next.store(link, Ordering::Relaxed);
+        }
+
+        pool
+    }
+
+    /// Get pool capacity.
+    ///
+    /// # Returns
+    /// - Number of frame buffers.
+    #[inline]
+    #[must_use]
+    pub const fn capacity(&self) -> usize {
+        N
+    }
+
+    /// Acquire free frame buffer.
+    ///
+    /// # Returns
+    /// - Frame buffer handle - in case of success.
+    /// - `None` - if pool is exhausted.
+    pub fn acquire(&self) -> Option<FrameBuffer<'_, N>> {
+        let mut head = self.head.load(Ordering::Acquire);
+
+        loop {
+            let index = head_index(head);
+            let slot = self.slots.get(index as usize)?;
+            let next = self.next.get(index as usize)?.load(Ordering::Relaxed);
+            let new_head = tagged(head, next);
+
+            match self.head.compare_exchange_weak(
+                head,
+                new_head,
+                Ordering::Acquire,
+                Ordering::Acquire,
+            ) {
+                Ok(_) => {
+                    return Some(FrameBuffer {
+                        pool: self,
+                        slot,
+                        index,
+                        len: 0,
+                    });
+                }
+                Err(actual) => head = actual,
+            }
+        }
+    }
+
+    /// Return frame buffer to free list.
+    ///
+    /// # Parameters
+    /// - `index` - given frame buffer index.
+    fn release(&self, index: u32) {
+        let Some(next) = self.next.get(index as usize) else {
+            return;
+        };
+
+        let mut head = self.head.load(Ordering::Relaxed);
+
+        loop {
+            next.store(head_index(head), Ordering::Relaxed);
+            let new_head = tagged(head, index);
+
+            match self.head.compare_exchange_weak(
+                head,
+                new_head,
+                Ordering::Release,
+                Ordering::Relaxed,
+            ) {
+                Ok(_) => return,
+                Err(actual) => head = actual,
+            }
+        }
+    }
+}
+
+/// Get index part of tagged free list head.
+///
+/// # Parameters
+/// - `head` - given tagged head.
+///
+/// # Returns
+/// - Slot index.
+#[inline]
+#[allow(clippy::cast_possible_truncation, clippy::unnecessary_cast)]
+const fn head_index(head: Head) -> u32 {
+    (head & INDEX_MASK) as u32
+}
+
+/// Build the next tagged free list head.
+///
+/// # Parameters
+/// - `head` - given current tagged head.
+/// - `index` - given index of the new first free slot.
+///
+/// # Returns
+/// - Tagged head with incremented tag.
+#[inline]
+#[allow(clippy::unnecessary_cast)]
+const fn tagged(head: Head, index: u32) -> Head {
+    (head & !INDEX_MASK).wrapping_add(TAG_STEP) | index as Head
+}
+
+impl<const N: usize> Default for FramePool<N> {
+    /// Construct default frame pool.
+    ///
+    /// # Returns
+    /// - New default frame pool.
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Handle of frame buffer acquired from pool. Buffer is returned to pool
+/// when handle is dropped.
+pub struct FrameBuffer<'a, const N: usize> {
+    /// Pool that owns buffer.
+    pool: &'a FramePool<N>,
+    /// Frame buffer.
+    slot: &'a UnsafeCell<[u8; IDTP_FRAME_MAX_SIZE]>,
+    /// Buffer index in pool.
+    index: u32,
+    /// Number of used bytes.
+    len: usize,
+}
+
+// SAFETY: handle has exclusive access to its buffer.
+unsafe impl<const N: usize> Send for FrameBuffer<'_, N> {}
+// SAFETY: shared handle provides read-only access to its buffer.
+unsafe impl<const N: usize> Sync for FrameBuffer<'_, N> {}
+
+impl<const N: usize> FrameBuffer<'_, N> {
+    /// Get whole frame buffer for writing.
+    ///
+    /// # Returns
+    /// - Mutable frame buffer of `IDTP_FRAME_MAX_SIZE` bytes.
+    pub const fn buffer_mut(&mut self) -> &mut [u8; IDTP_FRAME_MAX_SIZE] {
+        // SAFETY: handle has exclusive access to its buffer.
+        unsafe { &mut *self.slot.get() }
+    }
+
+    /// Set number of used bytes.
+    ///
+    /// # Parameters
+    /// - `len` - given number of used bytes.
+    ///
+    /// # Errors
+    /// - Buffer overflow.
+    pub const fn set_len(&mut self, len: usize) -> IdtpResult<()> {
+        if len > IDTP_FRAME_MAX_SIZE {
+            return Err(IdtpError::BufferOverflow);
+        }
+
+        self.len = len;
+        Ok(())
+    }
+
+    /// Fill buffer & set number of used bytes.
+    ///
+    /// # Parameters
+    /// - `write` - given closure that fills buffer & returns number of used
+    ///   bytes (e.g. `|buffer| frame.pack(buffer, key)`).
+    ///
+    /// # Returns
+    /// - Number of used bytes - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow.
+    /// - Errors returned by `write`.
+    pub fn fill_with<F>(&mut self, write: F) -> IdtpResult<usize>
+    where
+        F: FnOnce(&mut [u8]) -> IdtpResult<usize>,
+    {
+        let len = write(self.buffer_mut())?;
+        self.set_len(len)?;
+        Ok(len)
+    }
+}
+
+impl<const N: usize> Deref for FrameBuffer<'_, N> {
+    type Target = [u8];
+
+    /// Get used part of frame buffer.
+    ///
+    /// # Returns
+    /// - Used frame buffer bytes.
+    fn deref(&self) -> &Self::Target {
+        // SAFETY: handle has exclusive access to its buffer.
+        let buffer = unsafe { &*self.slot.get() };
+        buffer.get(..self.len).unwrap_or_default()
+    }
+}
+
+impl<const N: usize> DerefMut for FrameBuffer<'_, N> {
+    /// Get used part of frame buffer for writing.
+    ///
+    /// # Returns
+    /// - Mutable used frame buffer bytes.
+    fn deref_mut(&mut self) -> &mut Self::Target {
+        let len = self.len;
+        self.buffer_mut().get_mut(..len).unwrap_or_default()
+    }
+}
+
+impl<const N: usize> Drop for FrameBuffer<'_, N> {
+    /// Return frame buffer to pool.
+    fn drop(&mut self) {
+        self.pool.release(self.index);
+    }
+}
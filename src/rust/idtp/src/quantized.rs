@@ -0,0 +1,361 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Quantised fixed-point payloads.
+//!
+//! `Quantized<T, N, G>` stores `N` fields of standard payload `T` as `i16`
+//! with a power-of-two scale: `value = raw * 2^exponent`. Consecutive fields
+//! are split into groups of `QUANTIZED_GROUP_SIZE` (e.g. accelerometer,
+//! gyroscope & magnetometer axes), each group has its own `i8` exponent, so
+//! sensors with different ranges keep full 16-bit resolution. Exponent is
+//! chosen per frame from the largest magnitude in group. Payload type is
+//! `QUANTIZED_PAYLOAD_TYPE_BASE + T::TYPE_ID`.
+//!
+//! Conversion kernels work on slices in fixed-size chunks without branches
+//! on data, so they are auto-vectorised.
+
+use crate::{
+    IdtpError, IdtpResult,
+    payload::{
+        AsMetricsArray, IdtpPayload, Imu3Acc, Imu3Gyr, Imu3Mag, Imu6, Imu9,
+        Imu10, ImuQuat,
+    },
+};
+use core::{marker::PhantomData, ops::Range};
+use zerocopy::{FromBytes, Immutable, IntoBytes, KnownLayout};
+
+/// Payload type of quantised `Imu3Acc`. Quantised payload type of other
+/// standard payloads is offset by their payload type.
+pub const QUANTIZED_PAYLOAD_TYPE_BASE: u8 = 0x20;
+
+/// Payload type values range for quantised payloads.
+pub const QUANTIZED_PAYLOAD_TYPE_RANGE: Range<u8> = 0x20..0x30;
+
+/// Number of fields that share the same exponent.
+pub const QUANTIZED_GROUP_SIZE: usize = 3;
+
+/// Range of exponents.
+pub const QUANTIZED_EXPONENT_RANGE: Range<i8> = -126..127;
+
+/// Number of fields processed by kernels at once.
+const CHUNK_SIZE: usize = 8;
+
+/// Quantised standard payload.
+///
+/// # Parameters
+/// - `T` - standard payload type.
+/// - `N` - number of payload fields.
+/// - `G` - number of exponent groups, `N / QUANTIZED_GROUP_SIZE` rounded up.
+#[derive(Debug, Clone, Copy, IntoBytes, FromBytes, Immutable, KnownLayout)]
+#[repr(C, packed)]
+pub struct Quantized<T, const N: usize, const G: usize> {
+    /// Exponent of each group of fields.
+    pub exponents: [i8; G],
+    /// Fields in units of `2^exponent`.
+    pub values: [i16; N],
+    /// Standard payload type marker.
+    marker: PhantomData<T>,
+}
+
+/// Quantised `Imu3Acc` payload.
+pub type QImu3Acc = Quantized<Imu3Acc, 3, 1>;
+
+/// Quantised `Imu3Gyr` payload.
+pub type QImu3Gyr = Quantized<Imu3Gyr, 3, 1>;
+
+/// Quantised `Imu3Mag` payload.
+pub type QImu3Mag = Quantized<Imu3Mag, 3, 1>;
+
+/// Quantised `Imu6` payload.
+pub type QImu6 = Quantized<Imu6, 6, 2>;
+
+/// Quantised `Imu9` payload.
+pub type QImu9 = Quantized<Imu9, 9, 3>;
+
+/// Quantised `Imu10` payload.
+pub type QImu10 = Quantized<Imu10, 10, 4>;
+
+/// Quantised `ImuQuat` payload.
+pub type QImuQuat = Quantized<ImuQuat, 4, 2>;
+
+impl<T, const N: usize, const G: usize> Quantized<T, N, G>
+where
+    T: IdtpPayload + AsMetricsArray<N>,
+{
+    /// Layout check.
+    const LAYOUT: () = {
+        assert!(
+            G == N.div_ceil(QUANTIZED_GROUP_SIZE),
+            "invalid number of exponent groups"
+        );
+        assert!(
+            size_of::<T>() == N * size_of::<f32>(),
+            "payload must consist of N f32 fields"
+        );
+    };
+
+    /// Quantise standard payload.
+    ///
+    /// # Parameters
+    /// - `payload` - given standard payload.
+    ///
+    /// # Returns
+    /// - Quantised payload.
+    #[must_use]
+    pub fn from_payload(payload: &T) -> Self {
+        let () = Self::LAYOUT;
+        let fields = payload.to_array();
+        let mut exponents = [0; G];
+        let mut values = [0; N];
+
+        for ((input, output), exponent) in fields
+            .chunks(QUANTIZED_GROUP_SIZE)
+            .zip(values.chunks_mut(QUANTIZED_GROUP_SIZE))
+            .zip(&mut exponents)
+        {
+            *exponent = exponent_for(input);
+            quantize_exact(input, *exponent, output);
+        }
+
+        Self {
+            exponents,
+            values,
+            marker: PhantomData,
+        }
+    }
+
+    /// Convert to standard payload.
+    ///
+    /// # Returns
+    /// - Standard payload - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Parse error.
+    pub fn to_payload(&self) -> IdtpResult<T> {
+        let () = Self::LAYOUT;
+        let fields = self.to_array();
+        T::from_bytes(fields.as_bytes())
+    }
+
+    /// Get scale of field.
+    ///
+    /// # Parameters
+    /// - `field` - given field index.
+    ///
+    /// # Returns
+    /// - Value of field unit - if field index is valid.
+    /// - `None` - otherwise.
+    #[must_use]
+    pub fn scale(&self, field: usize) -> Option<f32> {
+        if field >= N {
+            return None;
+        }
+
+        let exponents = self.exponents;
+        let exponent = exponents.get(field / QUANTIZED_GROUP_SIZE)?;
+
+        Some(power_of_two(*exponent))
+    }
+}
+
+impl<T, const N: usize, const G: usize> AsMetricsArray<N> for Quantized<T, N, G>
+where
+    T: IdtpPayload + AsMetricsArray<N>,
+{
+    /// Convert metrics to a fixed-size array for.
+    ///
+    /// # Returns
+    /// - Fixed-size array of payload members.
+    fn to_array(&self) -> [f32; N] {
+        let exponents = self.exponents;
+        let values = self.values;
+        let mut fields = [0.0; N];
+
+        for ((input, output), exponent) in values
+            .chunks(QUANTIZED_GROUP_SIZE)
+            .zip(fields.chunks_mut(QUANTIZED_GROUP_SIZE))
+            .zip(exponents)
+        {
+            dequantize_exact(input, exponent, output);
+        }
+
+        fields
+    }
+}
+
+impl<T, const N: usize, const G: usize> IdtpPayload for Quantized<T, N, G>
+where
+    T: IdtpPayload + AsMetricsArray<N>,
+{
+    const TYPE_ID: u8 = {
+        assert!(
+            T::TYPE_ID
+                < QUANTIZED_PAYLOAD_TYPE_RANGE.end
+                    - QUANTIZED_PAYLOAD_TYPE_BASE,
+            "only standard payloads can be quantised"
+        );
+        QUANTIZED_PAYLOAD_TYPE_BASE + T::TYPE_ID
+    };
+}
+
+/// Get the smallest exponent that represents all values without overflow.
+///
+/// # Parameters
+/// - `values` - given values to handle.
+///
+/// # Returns
+/// - Exponent within `QUANTIZED_EXPONENT_RANGE`.
+#[must_use]
+#[allow(clippy::cast_possible_truncation, clippy::cast_possible_wrap)]
+pub fn exponent_for(values: &[f32]) -> i8 {
+    // Max of absolute values bit patterns is bit pattern of max magnitude.
+    let magnitude = values
+        .iter()
+        .map(|value| value.to_bits() & 0x7FFF_FFFF)
+        .fold(0, u32::max);
+    // Value is below 2^(biased - 126), so it fits 15 bits with this exponent.
+    let exponent = (magnitude >> 23) as i32 - 126 - 15;
+
+    exponent.clamp(
+        i32::from(QUANTIZED_EXPONENT_RANGE.start),
+        i32::from(QUANTIZED_EXPONENT_RANGE.end - 1),
+    ) as i8
+}
+
+/// Convert values to fixed-point with rounding to nearest & saturation.
+/// Excess elements of the longer slice are ignored.
+///
+/// # Parameters
+/// - `input` - given values to convert.
+/// - `exponent` - given exponent of fixed-point unit.
+/// - `output` - given buffer to store fixed-point values.
+///
+/// # Returns
+/// - `Ok` - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer underflow - if input is shorter than common length.
+/// - Buffer overflow - if output is shorter than common length.
+pub fn quantize(
+    input: &[f32],
+    exponent: i8,
+    output: &mut [i16],
+) -> IdtpResult<()> {
+    let size = input.len().min(output.len());
+
+    quantize_exact(
+        input.get(..size).ok_or(IdtpError::BufferUnderflow)?,
+        exponent,
+        output.get_mut(..size).ok_or(IdtpError::BufferOverflow)?,
+    );
+
+    Ok(())
+}
+
+/// Convert fixed-point values to floating-point. Excess elements of the
+/// longer slice are ignored.
+///
+/// # Parameters
+/// - `input` - given fixed-point values to convert.
+/// - `exponent` - given exponent of fixed-point unit.
+/// - `output` - given buffer to store values.
+///
+/// # Returns
+/// - `Ok` - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer underflow - if input is shorter than common length.
+/// - Buffer overflow - if output is shorter than common length.
+pub fn dequantize(
+    input: &[i16],
+    exponent: i8,
+    output: &mut [f32],
+) -> IdtpResult<()> {
+    let size = input.len().min(output.len());
+
+    dequantize_exact(
+        input.get(..size).ok_or(IdtpError::BufferUnderflow)?,
+        exponent,
+        output.get_mut(..size).ok_or(IdtpError::BufferOverflow)?,
+    );
+
+    Ok(())
+}
+
+/// Convert values of equally long slices to fixed-point.
+///
+/// # Parameters
+/// - `input` - given values to convert.
+/// - `exponent` - given exponent of fixed-point unit.
+/// - `output` - given buffer of the same length to store fixed-point values.
+#[allow(clippy::cast_possible_truncation)]
+fn quantize_exact(input: &[f32], exponent: i8, output: &mut [i16]) {
+    let scale = power_of_two(exponent.saturating_neg());
+
+    convert_exact(input, output, |value| {
+        let scaled = value * scale;
+        let rounding = if scaled < 0.0 { -0.5 } else { 0.5 };
+        (scaled + rounding) as i16
+    });
+}
+
+/// Convert fixed-point values of equally long slices to floating-point.
+///
+/// # Parameters
+/// - `input` - given fixed-point values to convert.
+/// - `exponent` - given exponent of fixed-point unit.
+/// - `output` - given buffer of the same length to store values.
+fn dequantize_exact(input: &[i16], exponent: i8, output: &mut [f32]) {
+    let scale = power_of_two(exponent);
+
+    convert_exact(input, output, |value| f32::from(value) * scale);
+}
+
+/// Convert equally long slices by `CHUNK_SIZE` elements, so conversion is
+/// auto-vectorised.
+///
+/// # Parameters
+/// - `input` - given values to convert.
+/// - `output` - given buffer of the same length to store values.
+/// - `convert` - given conversion of single value.
+#[inline]
+fn convert_exact<I: Copy, O>(
+    input: &[I],
+    output: &mut [O],
+    convert: impl Fn(I) -> O,
+) {
+    let mut inputs = input.chunks_exact(CHUNK_SIZE);
+    let mut outputs = output.chunks_exact_mut(CHUNK_SIZE);
+
+    for (input, output) in (&mut inputs).zip(&mut outputs) {
+        for (input, output) in input.iter().zip(output) {
+            *output = convert(*input);
+        }
+    }
+
+    for (input, output) in
+        inputs.remainder().iter().zip(outputs.into_remainder())
+    {
+        *output = convert(*input);
+    }
+}
+
+/// Get power of two.
+///
+/// # Parameters
+/// - `exponent` - given exponent.
+///
+/// # Returns
+/// - `2^exponent`, exponent is clamped to `QUANTIZED_EXPONENT_RANGE`.
+#[allow(clippy::cast_sign_loss)]
+pub(crate) fn power_of_two(exponent: i8) -> f32 {
+    let exponent = exponent.clamp(
+        QUANTIZED_EXPONENT_RANGE.start,
+        QUANTIZED_EXPONENT_RANGE.end - 1,
+    );
+
+    f32::from_bits(((i32::from(exponent) + 127) as u32) << 23)
+}
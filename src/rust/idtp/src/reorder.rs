@@ -0,0 +1,272 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Bounded-latency reorder (jitter) buffer.
+//!
+//! Frames of a single device are stored in a fixed ring indexed by
+//! `sequence mod N` & released in `sequence` order. If a frame is missing,
+//! release of the following frames is delayed at most by configurable
+//! deadline since the gap was detected, after which the gap is skipped &
+//! counted as lost. Time is supplied by caller, so deadline can be measured
+//! either against host clock or against (unwrapped) header `timestamp`.
+//! No allocations are performed.
+
+/// Reorder buffer statistics.
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct ReorderStats {
+    /// Number of frames released in order.
+    pub released: u64,
+    /// Number of frames arrived after their sequence was released or skipped.
+    pub late: u64,
+    /// Number of sequence numbers skipped after deadline.
+    pub lost: u64,
+    /// Number of duplicate frames.
+    pub duplicates: u64,
+    /// Number of frames too far ahead of buffer window.
+    pub overflows: u64,
+}
+
+/// Buffered frame.
+#[derive(Debug)]
+struct Entry<T> {
+    /// Frame sequence number.
+    sequence: u32,
+    /// Frame item.
+    item: T,
+}
+
+/// Reorder buffer of a single device.
+///
+/// # Parameters
+/// - `T` - type of buffered item (e.g. `IdtpFrame` or frame pool handle).
+/// - `N` - max distance between the next expected & the latest frame.
+///   **MUST** be a power of two, so slot mapping survives sequence number
+///   wraparound.
+#[derive(Debug)]
+pub struct ReorderBuffer<T, const N: usize> {
+    /// Ring of buffered frames.
+    slots: [Option<Entry<T>>; N],
+    /// Next sequence number to release.
+    next: u32,
+    /// The first frame was received.
+    started: bool,
+    /// Number of buffered frames.
+    pending: usize,
+    /// Time when missing frame at the head of window was detected.
+    blocked_since: Option<u64>,
+    /// Max time to wait for missing frame.
+    deadline: u64,
+    /// Buffer statistics.
+    stats: ReorderStats,
+}
+
+impl<T, const N: usize> ReorderBuffer<T, N> {
+    /// Construct new `ReorderBuffer` object.
+    ///
+    /// # Parameters
+    /// - `deadline` - given max time to wait for missing frame in units of
+    ///   `now` argument of `push` & `pop`.
+    ///
+    /// # Returns
+    /// - New `ReorderBuffer` object.
+    #[must_use]
+    pub const fn new(deadline: u64) -> Self {
+        const {
+            assert!(
+                N.is_power_of_two() && N <= i32::MAX as usize,
+                "buffer size must be a power of two"
+            );
+        }
+
+        Self {
+            slots: [const { None }; N],
+            next: 0,
+            started: false,
+            pending: 0,
+            blocked_since: None,
+            deadline,
+            stats: ReorderStats {
+                released: 0,
+                late: 0,
+                lost: 0,
+                duplicates: 0,
+                overflows: 0,
+            },
+        }
+    }
+
+    /// Get buffer statistics.
+    ///
+    /// # Returns
+    /// - Buffer statistics.
+    #[inline]
+    #[must_use]
+    pub const fn stats(&self) -> &ReorderStats {
+        &self.stats
+    }
+
+    /// Get number of buffered frames.
+    ///
+    /// # Returns
+    /// - Number of buffered frames.
+    #[inline]
+    #[must_use]
+    pub const fn len(&self) -> usize {
+        self.pending
+    }
+
+    /// Check whether buffer is empty.
+    ///
+    /// # Returns
+    /// - `true` - if there are no buffered frames.
+    /// - `false` - otherwise.
+    #[inline]
+    #[must_use]
+    pub const fn is_empty(&self) -> bool {
+        self.pending == 0
+    }
+
+    /// Get next sequence number to release.
+    ///
+    /// # Returns
+    /// - Next expected sequence number.
+    #[inline]
+    #[must_use]
+    pub const fn next_sequence(&self) -> u32 {
+        self.next
+    }
+
+    /// Store frame.
+    ///
+    /// # Parameters
+    /// - `sequence` - given frame sequence number.
+    /// - `now` - given current time.
+    /// - `item` - given frame to store.
+    ///
+    /// # Returns
+    /// - `Ok` - if frame was stored.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Given frame, if it is late, duplicate or too far ahead of window.
+    #[allow(clippy::cast_possible_wrap, clippy::cast_sign_loss)]
+    pub fn push(&mut self, sequence: u32, now: u64, item: T) -> Result<(), T> {
+        if !self.started || self.pending == 0 && self.is_jump(sequence) {
+            self.started = true;
+            self.next = sequence;
+        }
+
+        let distance = sequence.wrapping_sub(self.next) as i32;
+
+        if distance < 0 && !self.is_jump(sequence) {
+            self.stats.late += 1;
+            return Err(item);
+        }
+
+        if distance < 0 || distance as usize >= N {
+            self.stats.overflows += 1;
+            return Err(item);
+        }
+
+        let Some(slot) = self.slots.get_mut(Self::index(sequence)) else {
+            return Err(item);
+        };
+
+        if slot.is_some() {
+            self.stats.duplicates += 1;
+            return Err(item);
+        }
+
+        *slot = Some(Entry { sequence, item });
+        self.pending += 1;
+
+        if distance != 0 && self.blocked_since.is_none() {
+            self.blocked_since = Some(now);
+        }
+
+        Ok(())
+    }
+
+    /// Release the next frame in order.
+    ///
+    /// # Parameters
+    /// - `now` - given current time.
+    ///
+    /// # Returns
+    /// - The next frame - if it is available or gap deadline expired.
+    /// - `None` - otherwise.
+    pub fn pop(&mut self, now: u64) -> Option<T> {
+        while self.pending != 0 {
+            let slot = self.slots.get_mut(Self::index(self.next))?;
+
+            if let Some(entry) =
+                slot.take_if(|entry| entry.sequence == self.next)
+            {
+                self.next = self.next.wrapping_add(1);
+                self.pending -= 1;
+                self.stats.released += 1;
+                self.blocked_since = None;
+
+                return Some(entry.item);
+            }
+
+            let since = *self.blocked_since.get_or_insert(now);
+
+            if now.saturating_sub(since) < self.deadline {
+                return None;
+            }
+
+            self.next = self.next.wrapping_add(1);
+            self.stats.lost += 1;
+        }
+
+        None
+    }
+
+    /// Release the next buffered frame ignoring deadline.
+    ///
+    /// # Returns
+    /// - The next buffered frame - if any.
+    /// - `None` - otherwise.
+    pub fn flush(&mut self) -> Option<T> {
+        self.blocked_since = self.blocked_since.or(Some(0));
+        self.pop(u64::MAX)
+    }
+
+    /// Get slot index of sequence number.
+    ///
+    /// # Parameters
+    /// - `sequence` - given frame sequence number.
+    ///
+    /// # Returns
+    /// - Slot index.
+    #[inline]
+    const fn index(sequence: u32) -> usize {
+        sequence as usize & (N - 1)
+    }
+
+    /// Check whether sequence number is too far from window to be treated as
+    /// reordering (e.g. after device restart).
+    ///
+    /// # Parameters
+    /// - `sequence` - given frame sequence number.
+    ///
+    /// # Returns
+    /// - `true` - if sequence number is outside of window in both directions.
+    /// - `false` - otherwise.
+    #[allow(clippy::cast_possible_wrap)]
+    const fn is_jump(&self, sequence: u32) -> bool {
+        let distance = sequence.wrapping_sub(self.next) as i32;
+        distance.unsigned_abs() as usize >= N
+    }
+}
+
+impl<T, const N: usize> Default for ReorderBuffer<T, N> {
+    /// Construct default reorder buffer with zero deadline.
+    ///
+    /// # Returns
+    /// - New default reorder buffer.
+    fn default() -> Self {
+        Self::new(0)
+    }
+}
@@ -0,0 +1,727 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Shared memory transport between processes on one host.
+//!
+//! Single-producer/single-consumer ring of fixed `IDTP_FRAME_MAX_SIZE` slots
+//! placed in shared memory (`memfd` or POSIX `shm_open`). Producer packs
+//! frames directly into ring slot & consumer validates them in place, so
+//! the fast path performs no copies & no system calls. Optional futex-based
+//! wakeups are used only when consumer is waiting.
+//!
+//! Peer process is trusted: ring indices are checked, but slot contents
+//! **MUST** be validated as any other received frame.
+
+use crate::{IDTP_FRAME_MAX_SIZE, IdtpError, IdtpResult};
+use core::{
+    ffi::CStr,
+    ptr::NonNull,
+    sync::atomic::{AtomicU32, Ordering, fence},
+    time::Duration,
+};
+use std::os::fd::{AsFd, AsRawFd, BorrowedFd, FromRawFd, OwnedFd};
+
+/// Value to identify initialized ring.
+const RING_MAGIC: u32 = 0x474E_4952;
+
+/// Cache line size in bytes.
+const CACHE_LINE_SIZE: usize = 64;
+
+/// Size of slot metadata in bytes.
+const SLOT_META_SIZE: usize = CACHE_LINE_SIZE;
+
+/// Distance between neighbouring slots in bytes.
+const SLOT_STRIDE: usize = SLOT_META_SIZE + IDTP_FRAME_MAX_SIZE;
+
+/// Value wrapper aligned to cache line to avoid false sharing.
+#[derive(Debug, Default)]
+#[repr(C, align(64))]
+struct CachePadded<T>(T);
+
+/// Ring control block located at the beginning of shared memory.
+#[derive(Debug)]
+#[repr(C)]
+struct RingControl {
+    /// Value to identify initialized ring.
+    magic: CachePadded<AtomicU32>,
+    /// Number of slots.
+    capacity: AtomicU32,
+    /// Index of the next slot to write. Modified by producer only.
+    head: CachePadded<AtomicU32>,
+    /// Index of the next slot to read. Modified by consumer only.
+    tail: CachePadded<AtomicU32>,
+    /// Consumer is waiting for new frames on futex.
+    waiting: AtomicU32,
+}
+
+/// Size of ring control block in bytes.
+const CONTROL_SIZE: usize = size_of::<RingControl>();
+
+/// Shared memory region mapped into process address space.
+#[derive(Debug)]
+pub struct ShmRegion {
+    /// Pointer to the beginning of mapping.
+    ptr: NonNull<u8>,
+    /// Mapping size in bytes.
+    len: usize,
+    /// Shared memory file descriptor.
+    fd: OwnedFd,
+}
+
+// SAFETY: region is a plain memory mapping, access synchronization is
+// provided by its users.
+unsafe impl Send for ShmRegion {}
+// SAFETY: region is a plain memory mapping, access synchronization is
+// provided by its users.
+unsafe impl Sync for ShmRegion {}
+
+impl ShmRegion {
+    /// Create anonymous shared memory region. Its file descriptor can be
+    /// passed to another process (e.g. via `SCM_RIGHTS` or inheritance).
+    ///
+    /// # Parameters
+    /// - `name` - given region name for debugging purposes.
+    /// - `len` - given region size in bytes.
+    ///
+    /// # Returns
+    /// - New `ShmRegion` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error.
+    pub fn create(name: &CStr, len: usize) -> IdtpResult<Self> {
+        // SAFETY: name is a valid NUL-terminated string.
+        let fd =
+            unsafe { libc::memfd_create(name.as_ptr(), libc::MFD_CLOEXEC) };
+
+        if fd < 0 {
+            return Err(IdtpError::IoError);
+        }
+
+        // SAFETY: fd is a newly created descriptor owned by nobody else.
+        let fd = unsafe { OwnedFd::from_raw_fd(fd) };
+        Self::resize(&fd, len)?;
+        Self::from_fd(fd, len)
+    }
+
+    /// Create named POSIX shared memory region. Only creator sets region
+    /// size, other processes attach with `open`.
+    ///
+    /// # Parameters
+    /// - `name` - given region name (e.g. `/idtp`).
+    /// - `len` - given region size in bytes.
+    ///
+    /// # Returns
+    /// - New `ShmRegion` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error - e.g. if region with the same name already exists.
+    pub fn create_named(name: &CStr, len: usize) -> IdtpResult<Self> {
+        let flags =
+            libc::O_RDWR | libc::O_CREAT | libc::O_EXCL | libc::O_CLOEXEC;
+
+        // SAFETY: name is a valid NUL-terminated string.
+        let fd = unsafe { libc::shm_open(name.as_ptr(), flags, 0o600) };
+
+        if fd < 0 {
+            return Err(IdtpError::IoError);
+        }
+
+        // SAFETY: fd is a newly created descriptor owned by nobody else.
+        let fd = unsafe { OwnedFd::from_raw_fd(fd) };
+
+        if let Err(error) = Self::resize(&fd, len) {
+            // Do not leave region of wrong size behind. Unlink error is
+            // shadowed by the original one.
+            let _ = Self::unlink(name);
+            return Err(error);
+        }
+
+        Self::from_fd(fd, len)
+    }
+
+    /// Open existing named POSIX shared memory region. Region is never
+    /// resized, so mapping of peer process stays valid.
+    ///
+    /// # Parameters
+    /// - `name` - given region name (e.g. `/idtp`).
+    /// - `len` - given expected region size in bytes.
+    ///
+    /// # Returns
+    /// - New `ShmRegion` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error - e.g. if region does not exist.
+    /// - Buffer underflow - if region is smaller than `len`, e.g. creator
+    ///   has not sized it yet.
+    /// - Buffer overflow - if region is larger than `len`.
+    pub fn open(name: &CStr, len: usize) -> IdtpResult<Self> {
+        let flags = libc::O_RDWR | libc::O_CLOEXEC;
+
+        // SAFETY: name is a valid NUL-terminated string.
+        let fd = unsafe { libc::shm_open(name.as_ptr(), flags, 0o600) };
+
+        if fd < 0 {
+            return Err(IdtpError::IoError);
+        }
+
+        // SAFETY: fd is a newly opened descriptor owned by nobody else.
+        let fd = unsafe { OwnedFd::from_raw_fd(fd) };
+        Self::from_fd(fd, len)
+    }
+
+    /// Remove name of POSIX shared memory region. Region itself is freed
+    /// when the last mapping is dropped.
+    ///
+    /// # Parameters
+    /// - `name` - given region name (e.g. `/idtp`).
+    ///
+    /// # Errors
+    /// - I/O error - e.g. if region does not exist.
+    pub fn unlink(name: &CStr) -> IdtpResult<()> {
+        // SAFETY: name is a valid NUL-terminated string.
+        if unsafe { libc::shm_unlink(name.as_ptr()) } < 0 {
+            return Err(IdtpError::IoError);
+        }
+        Ok(())
+    }
+
+    /// Map shared memory region from file descriptor. Size of shared memory
+    /// file must be equal to `len`: mapping beyond the end of file faults on
+    /// access.
+    ///
+    /// # Parameters
+    /// - `fd` - given shared memory file descriptor.
+    /// - `len` - given region size in bytes.
+    ///
+    /// # Returns
+    /// - New `ShmRegion` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error.
+    /// - Buffer underflow - if file is smaller than `len`.
+    /// - Buffer overflow - if file is larger than `len`.
+    pub fn from_fd(fd: OwnedFd, len: usize) -> IdtpResult<Self> {
+        let size = Self::size(&fd)?;
+
+        if size < len {
+            return Err(IdtpError::BufferUnderflow);
+        }
+
+        if size > len {
+            return Err(IdtpError::BufferOverflow);
+        }
+
+        // SAFETY: mapping of valid descriptor at address chosen by kernel.
+        let ptr = unsafe {
+            libc::mmap(
+                core::ptr::null_mut(),
+                len,
+                libc::PROT_READ | libc::PROT_WRITE,
+                libc::MAP_SHARED,
+                fd.as_raw_fd(),
+                0,
+            )
+        };
+
+        if ptr == libc::MAP_FAILED {
+            return Err(IdtpError::IoError);
+        }
+
+        let ptr = NonNull::new(ptr.cast::<u8>()).ok_or(IdtpError::IoError)?;
+        Ok(Self { ptr, len, fd })
+    }
+
+    /// Map the same shared memory region once again.
+    ///
+    /// # Returns
+    /// - New `ShmRegion` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error.
+    pub fn try_clone(&self) -> IdtpResult<Self> {
+        let fd = self.fd.try_clone().map_err(|_| IdtpError::IoError)?;
+        Self::from_fd(fd, self.len)
+    }
+
+    /// Get region size.
+    ///
+    /// # Returns
+    /// - Region size in bytes.
+    #[inline]
+    #[must_use]
+    pub const fn len(&self) -> usize {
+        self.len
+    }
+
+    /// Check whether region is empty.
+    ///
+    /// # Returns
+    /// - `true` - if region size is 0.
+    /// - `false` - otherwise.
+    #[inline]
+    #[must_use]
+    pub const fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Get pointer to the beginning of mapping.
+    ///
+    /// # Returns
+    /// - Pointer to mapped memory.
+    #[inline]
+    #[must_use]
+    pub const fn as_ptr(&self) -> *mut u8 {
+        self.ptr.as_ptr()
+    }
+
+    /// Get size of shared memory file.
+    ///
+    /// # Parameters
+    /// - `fd` - given shared memory file descriptor.
+    ///
+    /// # Returns
+    /// - File size in bytes - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error.
+    fn size(fd: &OwnedFd) -> IdtpResult<usize> {
+        // SAFETY: all-zero bit pattern is valid for `stat`.
+        let mut stat: libc::stat = unsafe { core::mem::zeroed() };
+
+        // SAFETY: fd is a valid descriptor & stat is a valid output buffer.
+        if unsafe { libc::fstat(fd.as_raw_fd(), &raw mut stat) } < 0 {
+            return Err(IdtpError::IoError);
+        }
+
+        usize::try_from(stat.st_size).map_err(|_| IdtpError::IoError)
+    }
+
+    /// Set size of shared memory file.
+    ///
+    /// # Parameters
+    /// - `fd` - given shared memory file descriptor.
+    /// - `len` - given size in bytes.
+    ///
+    /// # Errors
+    /// - I/O error.
+    fn resize(fd: &OwnedFd, len: usize) -> IdtpResult<()> {
+        let len = libc::off_t::try_from(len).map_err(|_| IdtpError::IoError)?;
+
+        // SAFETY: fd is a valid descriptor.
+        if unsafe { libc::ftruncate(fd.as_raw_fd(), len) } < 0 {
+            return Err(IdtpError::IoError);
+        }
+        Ok(())
+    }
+}
+
+impl AsFd for ShmRegion {
+    /// Borrow shared memory file descriptor.
+    ///
+    /// # Returns
+    /// - Borrowed file descriptor.
+    fn as_fd(&self) -> BorrowedFd<'_> {
+        self.fd.as_fd()
+    }
+}
+
+impl Drop for ShmRegion {
+    /// Unmap shared memory region.
+    fn drop(&mut self) {
+        // SAFETY: pointer & length describe mapping created by this object.
+        unsafe {
+            libc::munmap(self.ptr.as_ptr().cast(), self.len);
+        }
+    }
+}
+
+/// Wait on futex while its value equals to `expected`.
+///
+/// # Parameters
+/// - `futex` - given futex word.
+/// - `expected` - given expected value.
+/// - `timeout` - given max time to wait.
+#[allow(clippy::unnecessary_fallible_conversions)]
+fn futex_wait(futex: &AtomicU32, expected: u32, timeout: Duration) {
+    let timeout = libc::timespec {
+        tv_sec: libc::time_t::try_from(timeout.as_secs()).unwrap_or(0),
+        tv_nsec: libc::c_long::try_from(timeout.subsec_nanos()).unwrap_or(0),
+    };
+
+    // SAFETY: futex word is valid for the whole call.
+    unsafe {
+        libc::syscall(
+            libc::SYS_futex,
+            futex.as_ptr(),
+            libc::FUTEX_WAIT,
+            expected,
+            &raw const timeout,
+        );
+    }
+}
+
+/// Wake all waiters of futex.
+///
+/// # Parameters
+/// - `futex` - given futex word.
+fn futex_wake(futex: &AtomicU32) {
+    // SAFETY: futex word is valid for the whole call.
+    unsafe {
+        libc::syscall(libc::SYS_futex, futex.as_ptr(), libc::FUTEX_WAKE, 1);
+    }
+}
+
+/// Shared memory ring of IDTP frames.
+#[derive(Debug)]
+pub struct ShmRing {
+    /// Shared memory region containing ring.
+    region: ShmRegion,
+    /// Number of slots.
+    capacity: u32,
+}
+
+impl ShmRing {
+    /// Get shared memory size required for ring.
+    ///
+    /// # Parameters
+    /// - `capacity` - given number of slots.
+    ///
+    /// # Returns
+    /// - Required size in bytes.
+    #[must_use]
+    pub const fn required_size(capacity: u32) -> usize {
+        CONTROL_SIZE + capacity as usize * SLOT_STRIDE
+    }
+
+    /// Initialize new ring in shared memory region.
+    ///
+    /// # Parameters
+    /// - `region` - given shared memory region.
+    /// - `capacity` - given number of slots. **MUST** be a power of two.
+    ///
+    /// # Returns
+    /// - New `ShmRing` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow - region is too small.
+    /// - Parse error - capacity is not a power of two.
+    pub fn create(region: ShmRegion, capacity: u32) -> IdtpResult<Self> {
+        if !capacity.is_power_of_two() {
+            return Err(IdtpError::ParseError);
+        }
+
+        if region.len() < Self::required_size(capacity) {
+            return Err(IdtpError::BufferUnderflow);
+        }
+
+        let ring = Self { region, capacity };
+        let control = ring.control();
+
+        control.capacity.store(capacity, Ordering::Relaxed);
+        control.head.0.store(0, Ordering::Relaxed);
+        control.tail.0.store(0, Ordering::Relaxed);
+        control.waiting.store(0, Ordering::Relaxed);
+        control.magic.0.store(RING_MAGIC, Ordering::Release);
+
+        Ok(ring)
+    }
+
+    /// Attach to ring initialized by another process.
+    ///
+    /// # Parameters
+    /// - `region` - given shared memory region.
+    ///
+    /// # Returns
+    /// - New `ShmRing` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer underflow - region is too small.
+    /// - Parse error - region does not contain initialized ring.
+    pub fn attach(region: ShmRegion) -> IdtpResult<Self> {
+        if region.len() < CONTROL_SIZE {
+            return Err(IdtpError::BufferUnderflow);
+        }
+
+        let mut ring = Self {
+            region,
+            capacity: 0,
+        };
+
+        let control = ring.control();
+
+        if control.magic.0.load(Ordering::Acquire) != RING_MAGIC {
+            return Err(IdtpError::ParseError);
+        }
+
+        let capacity = control.capacity.load(Ordering::Relaxed);
+
+        if !capacity.is_power_of_two() {
+            return Err(IdtpError::ParseError);
+        }
+
+        if ring.region.len() < Self::required_size(capacity) {
+            return Err(IdtpError::BufferUnderflow);
+        }
+
+        ring.capacity = capacity;
+        Ok(ring)
+    }
+
+    /// Convert ring into producer handle.
+    ///
+    /// # Returns
+    /// - Producer handle.
+    #[must_use]
+    pub fn into_producer(self) -> ShmProducer {
+        let tail = self.control().tail.0.load(Ordering::Acquire);
+        ShmProducer {
+            ring: self,
+            cached_tail: tail,
+        }
+    }
+
+    /// Convert ring into consumer handle.
+    ///
+    /// # Returns
+    /// - Consumer handle.
+    #[must_use]
+    pub fn into_consumer(self) -> ShmConsumer {
+        let head = self.control().head.0.load(Ordering::Acquire);
+        ShmConsumer {
+            ring: self,
+            cached_head: head,
+        }
+    }
+
+    /// Get ring control block.
+    ///
+    /// # Returns
+    /// - Ring control block.
+    #[allow(clippy::cast_ptr_alignment)]
+    const fn control(&self) -> &RingControl {
+        // SAFETY: region is page-aligned & large enough for control block,
+        // which consists of atomics only.
+        unsafe { &*self.region.as_ptr().cast::<RingControl>() }
+    }
+
+    /// Get pointer to slot metadata.
+    ///
+    /// # Parameters
+    /// - `index` - given ring index.
+    ///
+    /// # Returns
+    /// - Pointer to slot frame size field.
+    #[allow(clippy::cast_ptr_alignment)]
+    const fn slot_size_ptr(&self, index: u32) -> *mut u32 {
+        let slot = (index & (self.capacity - 1)) as usize;
+
+        // SAFETY: slot index is masked by capacity checked on construction.
+        unsafe {
+            self.region
+                .as_ptr()
+                .add(CONTROL_SIZE + slot * SLOT_STRIDE)
+                .cast::<u32>()
+        }
+    }
+
+    /// Get pointer to slot frame data.
+    ///
+    /// # Parameters
+    /// - `index` - given ring index.
+    ///
+    /// # Returns
+    /// - Pointer to slot frame data.
+    const fn slot_data_ptr(&self, index: u32) -> *mut u8 {
+        // SAFETY: frame data follows slot metadata within the same slot.
+        unsafe { self.slot_size_ptr(index).cast::<u8>().add(SLOT_META_SIZE) }
+    }
+}
+
+/// Producer side of shared memory ring.
+#[derive(Debug)]
+pub struct ShmProducer {
+    /// Shared memory ring.
+    ring: ShmRing,
+    /// Last observed consumer index.
+    cached_tail: u32,
+}
+
+impl ShmProducer {
+    /// Try to write frame directly into the next free slot.
+    ///
+    /// # Parameters
+    /// - `write` - given closure that fills slot & returns frame size
+    ///   (e.g. `|slot| frame.pack(slot, key)`).
+    ///
+    /// # Returns
+    /// - `true` - if frame was published.
+    /// - `false` - if ring is full.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow - returned frame size exceeds slot size.
+    /// - Errors returned by `write`.
+    pub fn try_push_with<F>(&mut self, write: F) -> IdtpResult<bool>
+    where
+        F: FnOnce(&mut [u8]) -> IdtpResult<usize>,
+    {
+        let control = self.ring.control();
+        let head = control.head.0.load(Ordering::Relaxed);
+
+        if head.wrapping_sub(self.cached_tail) >= self.ring.capacity {
+            self.cached_tail = control.tail.0.load(Ordering::Acquire);
+
+            if head.wrapping_sub(self.cached_tail) >= self.ring.capacity {
+                return Ok(false);
+            }
+        }
+
+        // SAFETY: slot between tail & head + capacity is owned by producer.
+        let slot = unsafe {
+            core::slice::from_raw_parts_mut(
+                self.ring.slot_data_ptr(head),
+                IDTP_FRAME_MAX_SIZE,
+            )
+        };
+
+        let size = write(slot)?;
+
+        if size > IDTP_FRAME_MAX_SIZE {
+            return Err(IdtpError::BufferOverflow);
+        }
+
+        // SAFETY: slot is owned by producer, size fits into u32.
+        #[allow(clippy::cast_possible_truncation)]
+        unsafe {
+            self.ring.slot_size_ptr(head).write_volatile(size as u32);
+        }
+
+        control
+            .head
+            .0
+            .store(head.wrapping_add(1), Ordering::Release);
+        fence(Ordering::SeqCst);
+
+        if control.waiting.load(Ordering::Relaxed) != 0 {
+            futex_wake(&control.head.0);
+        }
+
+        Ok(true)
+    }
+
+    /// Try to copy raw frame into the next free slot.
+    ///
+    /// # Parameters
+    /// - `frame` - given raw frame bytes.
+    ///
+    /// # Returns
+    /// - `true` - if frame was published.
+    /// - `false` - if ring is full.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - Buffer overflow.
+    pub fn try_push(&mut self, frame: &[u8]) -> IdtpResult<bool> {
+        self.try_push_with(|slot| {
+            slot.get_mut(..frame.len())
+                .ok_or(IdtpError::BufferOverflow)?
+                .copy_from_slice(frame);
+            Ok(frame.len())
+        })
+    }
+}
+
+/// Consumer side of shared memory ring.
+#[derive(Debug)]
+pub struct ShmConsumer {
+    /// Shared memory ring.
+    ring: ShmRing,
+    /// Last observed producer index.
+    cached_head: u32,
+}
+
+impl ShmConsumer {
+    /// Try to handle frame from the next filled slot in place.
+    ///
+    /// # Parameters
+    /// - `read` - given closure to handle frame bytes
+    ///   (e.g. `|frame| IdtpFrame::validate(frame, key)`).
+    ///
+    /// # Returns
+    /// - Result of `read` - if frame was available.
+    /// - `None` - if ring is empty.
+    pub fn try_pop_with<F, R>(&mut self, read: F) -> Option<R>
+    where
+        F: FnOnce(&[u8]) -> R,
+    {
+        let control = self.ring.control();
+        let tail = control.tail.0.load(Ordering::Relaxed);
+
+        if tail == self.cached_head {
+            self.cached_head = control.head.0.load(Ordering::Acquire);
+
+            if tail == self.cached_head {
+                return None;
+            }
+        }
+
+        // SAFETY: slot between tail & head is owned by consumer.
+        let size = unsafe { self.ring.slot_size_ptr(tail).read_volatile() };
+        let size = (size as usize).min(IDTP_FRAME_MAX_SIZE);
+
+        // SAFETY: slot between tail & head is owned by consumer.
+        let frame = unsafe {
+            core::slice::from_raw_parts(self.ring.slot_data_ptr(tail), size)
+        };
+
+        let result = read(frame);
+        control
+            .tail
+            .0
+            .store(tail.wrapping_add(1), Ordering::Release);
+
+        Some(result)
+    }
+
+    /// Handle frame from the next filled slot in place, waiting on futex
+    /// if ring is empty.
+    ///
+    /// # Parameters
+    /// - `timeout` - given max time to wait.
+    /// - `read` - given closure to handle frame bytes.
+    ///
+    /// # Returns
+    /// - Result of `read` - if frame was available.
+    /// - `None` - if ring is still empty after timeout.
+    pub fn pop_wait_with<F, R>(
+        &mut self,
+        timeout: Duration,
+        read: F,
+    ) -> Option<R>
+    where
+        F: FnOnce(&[u8]) -> R,
+    {
+        let control = self.ring.control();
+        let tail = control.tail.0.load(Ordering::Relaxed);
+
+        if tail == self.cached_head {
+            control.waiting.store(1, Ordering::Relaxed);
+            fence(Ordering::SeqCst);
+
+            if control.head.0.load(Ordering::Acquire) == tail {
+                futex_wait(&control.head.0, tail, timeout);
+            }
+            control.waiting.store(0, Ordering::Relaxed);
+        }
+
+        self.try_pop_with(read)
+    }
+}
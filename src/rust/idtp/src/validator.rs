@@ -0,0 +1,711 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Parallel validation of received IDTP frames.
+//!
+//! Batch of received frames is split between worker threads by `device_id`,
+//! so frames of the same device are usually handled by the same worker. Each
+//! worker owns a Chase-Lev deque of frame indices, idle workers steal work
+//! from others, so skewed per-device load (e.g. a few devices sending
+//! `Secure` mode frames) is balanced. Results are returned in input order,
+//! which keeps sequence semantics of each device.
+//!
+//! Worker threads live as long as `ParallelValidator`: they sleep between
+//! batches & are woken up when calling thread hands them the next one.
+
+use crate::{IdtpError, IdtpResult};
+use core::sync::atomic::{AtomicIsize, AtomicUsize, Ordering, fence};
+use std::{
+    any::Any,
+    boxed::Box,
+    format,
+    panic::{self, AssertUnwindSafe},
+    sync::{Arc, Condvar, Mutex, MutexGuard, PoisonError, RwLock},
+    thread::{self, JoinHandle},
+    vec::Vec,
+};
+
+/// Offset of the header `device_id` field.
+const DEVICE_ID_OFFSET: usize = 12;
+
+/// Value aligned to cache line to prevent false sharing.
+#[repr(align(64))]
+struct CachePadded<T>(T);
+
+/// Result of steal attempt.
+enum Steal {
+    /// Deque is empty.
+    Empty,
+    /// Task was stolen.
+    Success(usize),
+    /// Race with another worker was lost.
+    Retry,
+}
+
+/// Bounded Chase-Lev work-stealing deque of task indices.
+struct WorkDeque {
+    /// Index of the next task to steal.
+    top: CachePadded<AtomicIsize>,
+    /// Index of the next task to push.
+    bottom: CachePadded<AtomicIsize>,
+    /// Task indices.
+    tasks: Box<[AtomicUsize]>,
+    /// Mask to convert index to task position.
+    mask: usize,
+}
+
+impl WorkDeque {
+    /// Construct new `WorkDeque` object.
+    ///
+    /// # Parameters
+    /// - `capacity` - given max number of tasks.
+    ///
+    /// # Returns
+    /// - New `WorkDeque` object.
+    fn new(capacity: usize) -> Self {
+        let capacity = capacity.max(1).next_power_of_two();
+
+        Self {
+            top: CachePadded(AtomicIsize::new(0)),
+            bottom: CachePadded(AtomicIsize::new(0)),
+            tasks: (0..capacity).map(|_| AtomicUsize::new(0)).collect(),
+            mask: capacity - 1,
+        }
+    }
+
+    /// Get deque capacity.
+    ///
+    /// # Returns
+    /// - Max number of tasks.
+    const fn capacity(&self) -> usize {
+        self.mask + 1
+    }
+
+    /// Get task slot.
+    ///
+    /// # Parameters
+    /// - `index` - given deque index.
+    ///
+    /// # Returns
+    /// - Task slot - in case of success.
+    /// - `None` - otherwise.
+    #[allow(clippy::cast_sign_loss)]
+    fn slot(&self, index: isize) -> Option<&AtomicUsize> {
+        self.tasks.get(index as usize & self.mask)
+    }
+
+    /// Push task. Must be called by deque owner only.
+    ///
+    /// # Parameters
+    /// - `task` - given task index.
+    ///
+    /// # Returns
+    /// - `true` - if task was pushed.
+    /// - `false` - if deque is full.
+    #[allow(clippy::cast_sign_loss)]
+    fn push(&self, task: usize) -> bool {
+        let bottom = self.bottom.0.load(Ordering::Relaxed);
+        let top = self.top.0.load(Ordering::Acquire);
+
+        if (bottom - top) as usize > self.mask {
+            return false;
+        }
+
+        let Some(slot) = self.slot(bottom) else {
+            return false;
+        };
+
+        slot.store(task, Ordering::Relaxed);
+        self.bottom.0.store(bottom + 1, Ordering::Release);
+        true
+    }
+
+    /// Pop the most recently pushed task. Must be called by deque owner only.
+    ///
+    /// # Returns
+    /// - Task index - in case of success.
+    /// - `None` - if deque is empty.
+    fn pop(&self) -> Option<usize> {
+        let bottom = self.bottom.0.load(Ordering::Relaxed) - 1;
+        self.bottom.0.store(bottom, Ordering::Relaxed);
+        fence(Ordering::SeqCst);
+        let top = self.top.0.load(Ordering::Relaxed);
+
+        if top > bottom {
+            self.bottom.0.store(bottom + 1, Ordering::Relaxed);
+            return None;
+        }
+
+        let task = self.slot(bottom)?.load(Ordering::Relaxed);
+
+        if top == bottom {
+            let won = self
+                .top
+                .0
+                .compare_exchange(
+                    top,
+                    top + 1,
+                    Ordering::SeqCst,
+                    Ordering::Relaxed,
+                )
+                .is_ok();
+
+            self.bottom.0.store(bottom + 1, Ordering::Relaxed);
+            return won.then_some(task);
+        }
+
+        Some(task)
+    }
+
+    /// Steal the oldest task.
+    ///
+    /// # Returns
+    /// - Steal attempt result.
+    fn steal(&self) -> Steal {
+        let top = self.top.0.load(Ordering::Acquire);
+        fence(Ordering::SeqCst);
+        let bottom = self.bottom.0.load(Ordering::Acquire);
+
+        if top >= bottom {
+            return Steal::Empty;
+        }
+
+        let Some(slot) = self.slot(top) else {
+            return Steal::Empty;
+        };
+        let task = slot.load(Ordering::Relaxed);
+
+        match self.top.0.compare_exchange(
+            top,
+            top + 1,
+            Ordering::SeqCst,
+            Ordering::Relaxed,
+        ) {
+            Ok(_) => Steal::Success(task),
+            Err(_) => Steal::Retry,
+        }
+    }
+}
+
+/// Work distribution schedule.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Schedule {
+    /// Frames are split by `device_id`, idle workers steal frames.
+    WorkStealing,
+    /// Frames are split round-robin by position with no stealing.
+    RoundRobin,
+}
+
+/// Results of batch validation.
+#[derive(Debug)]
+pub struct ValidationReport {
+    /// Validation result of each frame in input order.
+    pub results: Vec<IdtpResult<()>>,
+    /// Number of frames validated by each worker.
+    pub per_worker: Vec<usize>,
+    /// Number of frames stolen from other workers.
+    pub steals: usize,
+}
+
+impl ValidationReport {
+    /// Get bitmask of valid frames. Bit `i % 64` of word `i / 64` is set if
+    /// frame `i` is valid.
+    ///
+    /// # Returns
+    /// - Bitmask words.
+    #[must_use]
+    pub fn valid_mask(&self) -> Vec<u64> {
+        self.results
+            .chunks(u64::BITS as usize)
+            .map(|results| {
+                results.iter().enumerate().fold(0, |mask, (index, result)| {
+                    mask | (u64::from(result.is_ok()) << index)
+                })
+            })
+            .collect()
+    }
+}
+
+/// Frame validation routine of current batch with erased lifetime.
+type Job = &'static (dyn Fn(usize) -> IdtpResult<()> + Sync);
+
+/// Panic payload of worker.
+type Panic = Box<dyn Any + Send>;
+
+/// Batch state shared between calling thread & workers.
+struct Batch {
+    /// Batch number, workers wait for it to change.
+    generation: u64,
+    /// Validation routine of current batch.
+    job: Option<Job>,
+    /// Flag whether stealing is enabled for current batch.
+    stealing: bool,
+    /// Number of worker threads that did not finish current batch.
+    pending: usize,
+    /// Results of each worker.
+    outputs: Vec<WorkerOutput>,
+    /// Payload of the first worker panic.
+    panic: Option<Panic>,
+    /// Flag whether workers must exit.
+    shutdown: bool,
+}
+
+/// State shared between calling thread & workers.
+struct Shared {
+    /// Deque of each worker, resized between batches only.
+    deques: RwLock<Vec<WorkDeque>>,
+    /// Current batch.
+    batch: Mutex<Batch>,
+    /// Signalled when batch is started or validator is dropped.
+    start: Condvar,
+    /// Signalled when the last worker thread finishes batch.
+    done: Condvar,
+}
+
+impl Shared {
+    /// Lock current batch. Workers never panic while holding the lock, so
+    /// poisoning is ignored.
+    ///
+    /// # Returns
+    /// - Batch guard.
+    fn lock(&self) -> MutexGuard<'_, Batch> {
+        self.batch.lock().unwrap_or_else(PoisonError::into_inner)
+    }
+
+    /// Run worker over current batch.
+    ///
+    /// # Parameters
+    /// - `worker` - given worker index.
+    /// - `stealing` - given flag whether stealing is enabled.
+    /// - `job` - given validation routine of current batch.
+    ///
+    /// # Returns
+    /// - Worker results - in case of success.
+    /// - `Err` - if validation routine panicked.
+    ///
+    /// # Errors
+    /// - Panic payload.
+    fn run(
+        &self,
+        worker: usize,
+        stealing: bool,
+        job: Job,
+    ) -> Result<WorkerOutput, Panic> {
+        panic::catch_unwind(AssertUnwindSafe(|| {
+            let deques =
+                self.deques.read().unwrap_or_else(PoisonError::into_inner);
+            run_worker(worker, &deques, stealing, job)
+        }))
+    }
+
+    /// Worker thread loop: wait for batch, run it & report results.
+    ///
+    /// # Parameters
+    /// - `worker` - given worker index.
+    fn serve(&self, worker: usize) {
+        let mut generation = 0;
+
+        loop {
+            let mut batch = self.lock();
+
+            while batch.generation == generation && !batch.shutdown {
+                batch = self
+                    .start
+                    .wait(batch)
+                    .unwrap_or_else(PoisonError::into_inner);
+            }
+
+            if batch.shutdown {
+                return;
+            }
+
+            generation = batch.generation;
+            let (job, stealing) = (batch.job, batch.stealing);
+            drop(batch);
+
+            let output = job.map_or_else(
+                || Ok(WorkerOutput::default()),
+                |job| self.run(worker, stealing, job),
+            );
+
+            let mut batch = self.lock();
+
+            match output {
+                Ok(output) => {
+                    if let Some(slot) = batch.outputs.get_mut(worker) {
+                        *slot = output;
+                    }
+                }
+                Err(panic) => {
+                    batch.panic.get_or_insert(panic);
+                }
+            }
+
+            batch.pending -= 1;
+
+            if batch.pending == 0 {
+                self.done.notify_all();
+            }
+        }
+    }
+}
+
+/// Parallel validator of received IDTP frames. Worker threads are spawned
+/// once & wait for batches, so small bursty batches do not pay for thread
+/// creation. Batches are validated one at a time.
+pub struct ParallelValidator {
+    /// State shared with worker threads.
+    shared: Arc<Shared>,
+    /// Worker threads, calling thread is worker 0.
+    threads: Vec<JoinHandle<()>>,
+    /// Serialises batches of concurrent callers.
+    caller: Mutex<()>,
+    /// Work distribution schedule.
+    schedule: Schedule,
+}
+
+impl ParallelValidator {
+    /// Construct new `ParallelValidator` object & spawn worker threads.
+    ///
+    /// # Parameters
+    /// - `workers` - given number of workers, including calling thread.
+    /// - `schedule` - given work distribution schedule.
+    ///
+    /// # Returns
+    /// - New `ParallelValidator` object - in case of success.
+    /// - `Err` - otherwise.
+    ///
+    /// # Errors
+    /// - I/O error - if worker thread cannot be spawned.
+    pub fn new(workers: usize, schedule: Schedule) -> IdtpResult<Self> {
+        let workers = workers.max(1);
+        let shared = Arc::new(Shared {
+            deques: RwLock::new(Vec::new()),
+            batch: Mutex::new(Batch {
+                generation: 0,
+                job: None,
+                stealing: false,
+                pending: 0,
+                outputs: Vec::new(),
+                panic: None,
+                shutdown: false,
+            }),
+            start: Condvar::new(),
+            done: Condvar::new(),
+        });
+
+        // Already spawned threads are joined on drop in case of error.
+        let mut validator = Self {
+            shared,
+            threads: Vec::with_capacity(workers - 1),
+            caller: Mutex::new(()),
+            schedule,
+        };
+
+        for worker in 1..workers {
+            let shared = Arc::clone(&validator.shared);
+            let thread = thread::Builder::new()
+                .name(format!("idtp-validator-{worker}"))
+                .spawn(move || shared.serve(worker))
+                .map_err(|_| IdtpError::IoError)?;
+
+            validator.threads.push(thread);
+        }
+
+        Ok(validator)
+    }
+
+    /// Get number of workers.
+    ///
+    /// # Returns
+    /// - Number of workers, including calling thread.
+    #[inline]
+    #[must_use]
+    pub const fn workers(&self) -> usize {
+        self.threads.len() + 1
+    }
+
+    /// Validate batch of frames. `CRC` & `HMAC` calculation is
+    /// software-based.
+    ///
+    /// # Parameters
+    /// - `frames` - given raw IDTP frames.
+    /// - `key` - given `HMAC` or `BLAKE2s` key.
+    ///
+    /// # Returns
+    /// - Batch validation results.
+    #[cfg(feature = "software_impl")]
+    pub fn validate<B>(
+        &self,
+        frames: &[B],
+        key: Option<&[u8]>,
+    ) -> ValidationReport
+    where
+        B: AsRef<[u8]> + Sync,
+    {
+        self.validate_with(frames, |frame| {
+            crate::IdtpFrame::validate(frame, key)
+        })
+    }
+
+    /// Validate batch of frames with custom validation logic. Panic of
+    /// `validate` on any worker is resumed on calling thread after all
+    /// workers have finished batch.
+    ///
+    /// # Parameters
+    /// - `frames` - given raw IDTP frames.
+    /// - `validate` - given closure that validates single frame
+    ///   (e.g. wrapper around `IdtpFrame::validate_with`).
+    ///
+    /// # Returns
+    /// - Batch validation results.
+    pub fn validate_with<B, F>(
+        &self,
+        frames: &[B],
+        validate: F,
+    ) -> ValidationReport
+    where
+        B: AsRef<[u8]> + Sync,
+        F: Fn(&[u8]) -> IdtpResult<()> + Sync,
+    {
+        let _caller =
+            self.caller.lock().unwrap_or_else(PoisonError::into_inner);
+        let workers = self.workers();
+        let stealing = self.schedule == Schedule::WorkStealing;
+
+        self.distribute(frames);
+
+        let validate = |index: usize| {
+            frames
+                .get(index)
+                .map_or(Err(IdtpError::BufferUnderflow), |frame| {
+                    validate(frame.as_ref())
+                })
+        };
+        let job: &(dyn Fn(usize) -> IdtpResult<()> + Sync) = &validate;
+
+        // SAFETY: workers use `job` only until they report the end of batch
+        // & this function does not return or unwind before all of them do.
+        let job: Job = unsafe { core::mem::transmute(job) };
+
+        let mut batch = self.shared.lock();
+        batch.generation += 1;
+        batch.job = Some(job);
+        batch.stealing = stealing;
+        batch.pending = self.threads.len();
+        batch.outputs.clear();
+        batch.outputs.resize_with(workers, WorkerOutput::default);
+        drop(batch);
+        self.shared.start.notify_all();
+
+        let own = self.shared.run(0, stealing, job);
+
+        let mut batch = self.shared.lock();
+
+        while batch.pending > 0 {
+            batch = self
+                .shared
+                .done
+                .wait(batch)
+                .unwrap_or_else(PoisonError::into_inner);
+        }
+
+        batch.job = None;
+        let mut outputs = core::mem::take(&mut batch.outputs);
+        let panic = batch.panic.take();
+        drop(batch);
+
+        match (own, panic) {
+            (Err(panic), _) | (Ok(_), Some(panic)) => {
+                panic::resume_unwind(panic)
+            }
+            (Ok(own), None) => {
+                if let Some(slot) = outputs.first_mut() {
+                    *slot = own;
+                }
+            }
+        }
+
+        let mut results: Vec<Option<IdtpResult<()>>> =
+            (0..frames.len()).map(|_| None).collect();
+        let mut report = ValidationReport {
+            results: Vec::new(),
+            per_worker: Vec::with_capacity(workers),
+            steals: 0,
+        };
+
+        for output in outputs {
+            report.per_worker.push(output.results.len());
+            report.steals += output.steals;
+
+            for (index, result) in output.results {
+                if let Some(slot) = results.get_mut(index) {
+                    *slot = Some(result);
+                }
+            }
+        }
+
+        // Every frame is validated exactly once: each task is pushed once &
+        // popped or stolen once.
+        report.results = results
+            .into_iter()
+            .map(|result| result.unwrap_or(Err(IdtpError::BufferUnderflow)))
+            .collect();
+
+        report
+    }
+
+    /// Split frames between worker deques. Must be called between batches.
+    ///
+    /// # Parameters
+    /// - `frames` - given raw IDTP frames.
+    fn distribute<B: AsRef<[u8]>>(&self, frames: &[B]) {
+        let workers = self.workers();
+        let active = workers.min(frames.len()).max(1);
+        let mut deques = self
+            .shared
+            .deques
+            .write()
+            .unwrap_or_else(PoisonError::into_inner);
+
+        // Any deque may receive the whole batch, e.g. frames of one device.
+        if deques.len() != workers
+            || deques.iter().any(|deque| deque.capacity() < frames.len())
+        {
+            *deques =
+                (0..workers).map(|_| WorkDeque::new(frames.len())).collect();
+        }
+
+        for (index, frame) in frames.iter().enumerate() {
+            let worker = match self.schedule {
+                Schedule::WorkStealing => {
+                    usize::from(device_id(frame.as_ref())) % active
+                }
+                Schedule::RoundRobin => index % active,
+            };
+
+            if let Some(deque) = deques.get(worker) {
+                deque.push(index);
+            }
+        }
+    }
+}
+
+impl Drop for ParallelValidator {
+    /// Stop & join worker threads.
+    fn drop(&mut self) {
+        self.shared.lock().shutdown = true;
+        self.shared.start.notify_all();
+
+        for thread in self.threads.drain(..) {
+            // Workers catch panics of validation routine.
+            let _ = thread.join();
+        }
+    }
+}
+
+impl core::fmt::Debug for ParallelValidator {
+    /// Format validator configuration.
+    fn fmt(&self, f: &mut core::fmt::Formatter<'_>) -> core::fmt::Result {
+        f.debug_struct("ParallelValidator")
+            .field("workers", &self.workers())
+            .field("schedule", &self.schedule)
+            .finish_non_exhaustive()
+    }
+}
+
+/// Results of single worker.
+#[derive(Default)]
+struct WorkerOutput {
+    /// Frame indices & validation results.
+    results: Vec<(usize, IdtpResult<()>)>,
+    /// Number of stolen frames.
+    steals: usize,
+}
+
+/// Run worker until there are no tasks left.
+///
+/// # Parameters
+/// - `worker` - given worker index.
+/// - `deques` - given deques of all workers.
+/// - `stealing` - given flag whether stealing is enabled.
+/// - `validate` - given closure that validates frame by index.
+///
+/// # Returns
+/// - Worker results.
+fn run_worker<F>(
+    worker: usize,
+    deques: &[WorkDeque],
+    stealing: bool,
+    validate: F,
+) -> WorkerOutput
+where
+    F: Fn(usize) -> IdtpResult<()>,
+{
+    let mut output = WorkerOutput::default();
+    let Some(own) = deques.get(worker) else {
+        return output;
+    };
+
+    loop {
+        if let Some(index) = own.pop() {
+            output.results.push((index, validate(index)));
+            continue;
+        }
+
+        if !stealing {
+            return output;
+        }
+
+        match steal_from_others(worker, deques) {
+            Some(index) => {
+                output.steals += 1;
+                output.results.push((index, validate(index)));
+            }
+            None => return output,
+        }
+    }
+}
+
+/// Steal task from other workers.
+///
+/// # Parameters
+/// - `worker` - given thief worker index.
+/// - `deques` - given deques of all workers.
+///
+/// # Returns
+/// - Stolen task index - in case of success.
+/// - `None` - if all deques are empty.
+fn steal_from_others(worker: usize, deques: &[WorkDeque]) -> Option<usize> {
+    loop {
+        let mut retry = false;
+
+        for offset in 1..deques.len() {
+            let victim = deques.get((worker + offset) % deques.len())?;
+
+            match victim.steal() {
+                Steal::Success(task) => return Some(task),
+                Steal::Retry => retry = true,
+                Steal::Empty => {}
+            }
+        }
+
+        if !retry {
+            return None;
+        }
+    }
+}
+
+/// Get device ID of raw frame.
+///
+/// # Parameters
+/// - `frame` - given raw IDTP frame.
+///
+/// # Returns
+/// - Device ID or 0 if frame is too short.
+fn device_id(frame: &[u8]) -> u16 {
+    frame
+        .get(DEVICE_ID_OFFSET..DEVICE_ID_OFFSET + 2)
+        .and_then(|bytes| bytes.try_into().ok())
+        .map_or(0, u16::from_le_bytes)
+}
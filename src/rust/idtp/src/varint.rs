@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: Apache-2.0.
+// Copyright (C) 2025-present idtp project and contributors.
+
+//! Variable-length integer encoding helpers.
+
+use crate::{IdtpError, IdtpResult};
+
+/// Write `LEB128` varint.
+///
+/// # Parameters
+/// - `buffer` - given output buffer.
+/// - `position` - given write position, it is advanced.
+/// - `value` - given value to write.
+///
+/// # Errors
+/// - Buffer overflow.
+#[allow(clippy::cast_possible_truncation)]
+pub fn write_varint(
+    buffer: &mut [u8],
+    position: &mut usize,
+    mut value: u32,
+) -> IdtpResult<()> {
+    loop {
+        let byte = (value & 0x7F) as u8;
+        value >>= 7;
+
+        let slot =
+            buffer.get_mut(*position).ok_or(IdtpError::BufferOverflow)?;
+        *position += 1;
+
+        if value == 0 {
+            *slot = byte;
+            return Ok(());
+        }
+
+        *slot = byte | 0x80;
+    }
+}
+
+/// Read `LEB128` varint.
+///
+/// # Parameters
+/// - `buffer` - given input buffer.
+/// - `position` - given read position, it is advanced.
+///
+/// # Returns
+/// - Read value - in case of success.
+/// - `Err` - otherwise.
+///
+/// # Errors
+/// - Buffer underflow.
+/// - Parse error - if value does not fit 32 bits.
+pub fn read_varint(buffer: &[u8], position: &mut usize) -> IdtpResult<u32> {
+    let mut value = 0;
+    let mut shift = 0;
+
+    loop {
+        let byte = *buffer.get(*position).ok_or(IdtpError::BufferUnderflow)?;
+        *position += 1;
+
+        if shift > 28 {
+            return Err(IdtpError::ParseError);
+        }
+
+        value |= u32::from(byte & 0x7F) << shift;
+        shift += 7;
+
+        if byte & 0x80 == 0 {
+            return Ok(value);
+        }
+    }
+}
+
+/// Map signed integer to unsigned one, so small magnitudes are small.
+///
+/// # Parameters
+/// - `value` - given signed value.
+///
+/// # Returns
+/// - Zig-zag encoded value.
+#[allow(clippy::cast_sign_loss)]
+pub const fn zigzag(value: i32) -> u32 {
+    ((value << 1) ^ (value >> 31)) as u32
+}
+
+/// Reverse zig-zag mapping.
+///
+/// # Parameters
+/// - `value` - given zig-zag encoded value.
+///
+/// # Returns
+/// - Signed value.
+#[allow(clippy::cast_possible_wrap)]
+pub const fn unzigzag(value: u32) -> i32 {
+    (value >> 1) as i32 ^ -((value & 1) as i32)
+}
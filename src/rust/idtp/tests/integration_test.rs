@@ -253,4 +253,2121 @@ mod tests {
 
         assert!(matches!(result, Err(IdtpError::BufferOverflow)));
     }
+
+    #[cfg(feature = "software_impl")]
+    fn pack_test_frame(buffer: &mut [u8], mode: u8, sequence: u32) -> usize {
+        let mut frame = IdtpFrame::new();
+        frame.set_header(&IdtpHeader {
+            mode,
+            sequence,
+            ..IdtpHeader::new()
+        });
+        frame.set_payload(&Imu6::default()).unwrap();
+        frame.pack(buffer, Some(b"key")).unwrap()
+    }
+
+    #[cfg(feature = "software_impl")]
+    #[test]
+    fn test_decoder_resync() {
+        let mut stream = [0u8; 256];
+        let mut offset = 0;
+
+        // Garbage with preamble-like bytes.
+        stream[..7].copy_from_slice(b"IDTIDTP");
+        offset += 7;
+        offset += pack_test_frame(&mut stream[offset..], 1, 1);
+
+        // Corrupted header.
+        let corrupted = offset;
+        offset += pack_test_frame(&mut stream[offset..], 1, 2);
+        stream[corrupted + 8] ^= 0x01;
+        offset += pack_test_frame(&mut stream[offset..], 2, 3);
+
+        let mut decoder = FrameDecoder::new();
+        let mut sequences = [0u32; 3];
+        let mut count = 0;
+        let mut input = &stream[..offset];
+
+        while !input.is_empty() {
+            let (consumed, frame) = decoder.feed(&input[..1]).unwrap();
+            input = &input[consumed..];
+
+            if let Some(frame) = frame {
+                assert!(IdtpFrame::validate(frame, Some(b"key")).is_ok());
+                sequences[count] =
+                    IdtpFrame::try_from(frame).unwrap().header().sequence;
+                count += 1;
+            }
+        }
+
+        assert_eq!(count, 2);
+        assert_eq!(sequences[..2], [1, 3]);
+        assert_eq!(decoder.discarded(), 7 + 48);
+    }
+
+    #[cfg(all(feature = "embedded_io", feature = "software_impl"))]
+    #[test]
+    fn test_embedded_io_stream() {
+        let mut frame = IdtpFrame::new();
+        frame.set_header(&IdtpHeader {
+            mode: IdtpMode::Secure.into(),
+            ..IdtpHeader::new()
+        });
+        frame.set_payload(&Imu6::default()).unwrap();
+
+        let mut packed = [0u8; 128];
+        let size = frame.pack(&mut packed, Some(b"key")).unwrap();
+
+        let mut stream = [0u8; 256];
+        let mut writer = &mut stream[3..];
+        let written =
+            idtp::io::write_frame(&mut writer, &frame, Some(b"key")).unwrap();
+
+        assert_eq!(written, size);
+        assert_eq!(&stream[3..3 + size], &packed[..size]);
+
+        let mut reader = &stream[..3 + size];
+        let mut decoder = FrameDecoder::new();
+        let received = idtp::io::read_frame(&mut reader, &mut decoder).unwrap();
+
+        assert_eq!(received, &packed[..size]);
+        assert!(matches!(
+            idtp::io::read_frame(&mut reader, &mut decoder),
+            Err(IdtpError::IoError)
+        ));
+    }
+
+    #[cfg(feature = "embedded_io")]
+    #[test]
+    fn test_embedded_io_rejects_encrypted() {
+        /// Digest that would write plaintext `IDTP-E` frame.
+        struct ZeroDigest;
+
+        impl idtp::TrailerDigest for ZeroDigest {
+            fn update(&mut self, _: &[u8]) -> idtp::IdtpResult<()> {
+                Ok(())
+            }
+
+            fn finalize(self, trailer: &mut [u8]) -> idtp::IdtpResult<()> {
+                trailer.fill(0);
+                Ok(())
+            }
+        }
+
+        let mut frame = IdtpFrame::new();
+        frame.set_header(&IdtpHeader {
+            mode: IdtpMode::Encrypted.into(),
+            ..IdtpHeader::new()
+        });
+        frame.set_payload(&Imu6::default()).unwrap();
+
+        let mut stream = [0u8; 128];
+        let mut writer = &mut stream[..];
+        let result = idtp::io::write_frame_with(
+            &mut writer,
+            &frame,
+            |_| Ok(0),
+            ZeroDigest,
+        );
+
+        assert!(matches!(result, Err(IdtpError::ParseError)));
+        assert_eq!(writer.len(), stream.len());
+    }
+
+    #[cfg(all(feature = "embedded_io_async", feature = "software_impl"))]
+    fn block_on<F: core::future::Future>(future: F) -> F::Output {
+        let mut future = core::pin::pin!(future);
+        let mut context =
+            core::task::Context::from_waker(core::task::Waker::noop());
+
+        loop {
+            if let core::task::Poll::Ready(output) =
+                future.as_mut().poll(&mut context)
+            {
+                return output;
+            }
+        }
+    }
+
+    #[cfg(all(feature = "embedded_io_async", feature = "software_impl"))]
+    #[test]
+    fn test_embedded_io_async_stream() {
+        let mut frame = IdtpFrame::new();
+        frame.set_header(&IdtpHeader {
+            mode: IdtpMode::Safety.into(),
+            ..IdtpHeader::new()
+        });
+        frame.set_payload(&Imu6::default()).unwrap();
+
+        let mut stream = [0u8; 128];
+        let mut writer = &mut stream[..];
+        let size =
+            block_on(idtp::io::write_frame_async(&mut writer, &frame, None))
+                .unwrap();
+
+        let mut reader = &stream[..size];
+        let mut decoder = FrameDecoder::new();
+        let received =
+            block_on(idtp::io::read_frame_async(&mut reader, &mut decoder))
+                .unwrap();
+
+        assert!(IdtpFrame::validate(received, None).is_ok());
+    }
+
+    #[cfg(feature = "cobs")]
+    #[test]
+    fn test_cobs_round_trip() {
+        use idtp::cobs;
+
+        let mut data = [0u8; 600];
+        let mut encoded = [0u8; cobs::max_encoded_size(600)];
+        let mut decoded = [0u8; cobs::max_encoded_size(600)];
+
+        for (i, byte) in data.iter_mut().enumerate() {
+            *byte = if i % 300 == 7 { 0 } else { (i % 251 + 1) as u8 };
+        }
+
+        for size in [0, 1, 7, 8, 253, 254, 255, 508, 509, 600] {
+            let size_encoded =
+                cobs::encode(&data[..size], &mut encoded).unwrap();
+            let body = &encoded[..size_encoded - 1];
+
+            assert_eq!(encoded[size_encoded - 1], cobs::COBS_DELIMITER);
+            assert_eq!(cobs::find_delimiter(body), None);
+            assert!(size_encoded <= cobs::max_encoded_size(size));
+
+            let size_decoded = cobs::decode(body, &mut decoded).unwrap();
+            assert_eq!(&decoded[..size_decoded], &data[..size]);
+        }
+
+        let zeros = [0u8; 10];
+        let size = cobs::encode(&zeros, &mut encoded).unwrap();
+        assert_eq!(size, 12);
+        assert!(encoded[..11].iter().all(|byte| *byte == 0x01));
+    }
+
+    #[cfg(all(feature = "cobs", feature = "software_impl"))]
+    #[test]
+    fn test_cobs_decoder_resync() {
+        use idtp::cobs::{self, CobsDecoder};
+
+        let mut packed = [0u8; 128];
+        let mut stream = [0u8; 512];
+        let mut offset = 0;
+
+        for sequence in 1..=3 {
+            let size = pack_test_frame(&mut packed, 1, sequence);
+            offset +=
+                cobs::encode(&packed[..size], &mut stream[offset..]).unwrap();
+        }
+
+        // Corrupt second frame & prepend garbage terminated by delimiter.
+        stream[60] ^= 0x5A;
+        let mut input = [0xAAu8; 600];
+        input[5] = cobs::COBS_DELIMITER;
+        input[6..6 + offset].copy_from_slice(&stream[..offset]);
+        let mut input = &input[..6 + offset];
+
+        let mut decoder = CobsDecoder::new();
+        let mut sequences = Vec::new();
+
+        while !input.is_empty() {
+            let (consumed, frame) = decoder.feed(input);
+            input = &input[consumed..];
+
+            if let Some(frame) = frame
+                && IdtpFrame::validate(frame, None).is_ok()
+            {
+                let frame = IdtpFrame::try_from(frame).unwrap();
+                sequences.push(frame.header().sequence);
+            }
+        }
+
+        assert_eq!(sequences, [1, 3]);
+    }
+
+    #[cfg(all(
+        feature = "shm",
+        feature = "software_impl",
+        target_os = "linux"
+    ))]
+    #[test]
+    fn test_shm_ring_handoff() {
+        use idtp::shm::{ShmRegion, ShmRing};
+        use std::time::Duration;
+
+        const FRAMES: u32 = 1000;
+
+        let size = ShmRing::required_size(8);
+        let region = ShmRegion::create(c"idtp-test", size).unwrap();
+        let consumer_region = region.try_clone().unwrap();
+
+        let mut producer = ShmRing::create(region, 8).unwrap().into_producer();
+        let mut consumer =
+            ShmRing::attach(consumer_region).unwrap().into_consumer();
+
+        let receiver = std::thread::spawn(move || {
+            let mut expected = 1;
+
+            while expected <= FRAMES {
+                let result = consumer.pop_wait_with(
+                    Duration::from_millis(10),
+                    |frame| {
+                        IdtpFrame::validate(frame, None)?;
+                        IdtpFrame::try_from(frame)
+                    },
+                );
+
+                if let Some(frame) = result {
+                    let sequence = frame.unwrap().header().sequence;
+                    assert_eq!(sequence, expected);
+                    expected += 1;
+                }
+            }
+        });
+
+        for sequence in 1..=FRAMES {
+            while !producer
+                .try_push_with(|slot| Ok(pack_test_frame(slot, 1, sequence)))
+                .unwrap()
+            {
+                std::hint::spin_loop();
+            }
+        }
+
+        receiver.join().unwrap();
+    }
+
+    #[cfg(all(feature = "shm", target_os = "linux"))]
+    #[test]
+    fn test_shm_named_region() {
+        use idtp::shm::ShmRegion;
+
+        let name = std::ffi::CString::new(format!(
+            "/idtp-test-{}",
+            std::process::id()
+        ))
+        .unwrap();
+        let size = 4096;
+
+        let region = ShmRegion::create_named(&name, size).unwrap();
+        assert!(ShmRegion::create_named(&name, size).is_err());
+        unsafe { region.as_ptr().write(0x5A) };
+
+        // Peer never resizes region, size mismatch is rejected.
+        assert!(matches!(
+            ShmRegion::open(&name, size * 2),
+            Err(IdtpError::BufferUnderflow)
+        ));
+        assert!(matches!(
+            ShmRegion::open(&name, size / 2),
+            Err(IdtpError::BufferOverflow)
+        ));
+
+        let peer = ShmRegion::open(&name, size).unwrap();
+        assert_eq!(unsafe { peer.as_ptr().read() }, 0x5A);
+
+        ShmRegion::unlink(&name).unwrap();
+        assert!(ShmRegion::open(&name, size).is_err());
+        assert!(ShmRegion::unlink(&name).is_err());
+        assert_eq!(unsafe { region.as_ptr().read() }, 0x5A);
+    }
+
+    #[test]
+    fn test_latest_table_consistency() {
+        use idtp::latest::LatestTable;
+        use idtp::payload::{Imu3Acc, Imu3Gyr};
+        use std::sync::atomic::{AtomicBool, Ordering};
+
+        static TABLE: LatestTable<4> = LatestTable::new();
+        static DONE: AtomicBool = AtomicBool::new(false);
+
+        assert!(TABLE.read(7).is_none());
+        assert!(matches!(TABLE.try_read(7), Ok(None)));
+
+        let writer = std::thread::spawn(|| {
+            let mut frame = IdtpFrame::new();
+
+            for sequence in 1..=20_000u32 {
+                let value = sequence as f32;
+                let sample = Imu6 {
+                    acc: Imu3Acc {
+                        acc_x: value,
+                        acc_y: value,
+                        acc_z: value,
+                    },
+                    gyr: Imu3Gyr {
+                        gyr_x: value,
+                        gyr_y: value,
+                        gyr_z: value,
+                    },
+                };
+
+                for device_id in [7, 11] {
+                    frame.set_header(&IdtpHeader {
+                        device_id,
+                        sequence,
+                        ..IdtpHeader::new()
+                    });
+                    frame.set_payload(&sample).unwrap();
+                    TABLE.update_frame(&frame).unwrap();
+                }
+            }
+            DONE.store(true, Ordering::Release);
+        });
+
+        let mut last = 0;
+
+        while !DONE.load(Ordering::Acquire) {
+            if let Some(sample) = TABLE.read(11) {
+                let sequence = sample.header().sequence;
+                let payload = sample.payload::<Imu6>().unwrap();
+                let gyr_z = payload.gyr.gyr_z;
+
+                assert_eq!(gyr_z, sequence as f32);
+                assert!(sequence >= last);
+                last = sequence;
+            }
+        }
+
+        writer.join().unwrap();
+
+        let device_id = TABLE.read(7).unwrap().header().device_id;
+        assert_eq!(device_id, 7);
+        let sequence = TABLE.read(11).unwrap().header().sequence;
+        assert_eq!(sequence, 20_000);
+    }
+
+    #[cfg(feature = "software_impl")]
+    #[test]
+    fn test_frame_pool_handoff() {
+        use idtp::pool::FramePool;
+        use std::sync::mpsc;
+
+        static POOL: FramePool<4> = FramePool::new();
+
+        let handles: Vec<_> = (0..4).map(|_| POOL.acquire().unwrap()).collect();
+        assert!(POOL.acquire().is_none());
+        drop(handles);
+
+        let (sender, receiver) = mpsc::sync_channel(2);
+
+        let producers: Vec<_> = (0..4u32)
+            .map(|id| {
+                let sender = sender.clone();
+
+                std::thread::spawn(move || {
+                    for i in 0..1000 {
+                        let sequence = id * 1000 + i;
+
+                        let mut buffer = loop {
+                            if let Some(buffer) = POOL.acquire() {
+                                break buffer;
+                            }
+                            std::thread::yield_now();
+                        };
+
+                        buffer
+                            .fill_with(|slot| {
+                                Ok(pack_test_frame(slot, 1, sequence))
+                            })
+                            .unwrap();
+                        sender.send(buffer).unwrap();
+                    }
+                })
+            })
+            .collect();
+
+        drop(sender);
+
+        let mut seen = vec![false; 4000];
+
+        for buffer in receiver {
+            let frame = IdtpFrame::try_from(&buffer[..]).unwrap();
+            let sequence = frame.header().sequence as usize;
+
+            assert!(!seen[sequence]);
+            seen[sequence] = true;
+        }
+
+        for producer in producers {
+            producer.join().unwrap();
+        }
+
+        assert!(seen.iter().all(|seen| *seen));
+        assert_eq!(POOL.capacity(), 4);
+    }
+
+    #[cfg(all(feature = "pipeline", feature = "software_impl"))]
+    #[test]
+    fn test_pipeline_stages() {
+        use idtp::pipeline::{Pipeline, PipelineConfig, Stage};
+        use idtp::pool::{FrameBuffer, FramePool};
+        use std::sync::{Arc, Mutex};
+
+        static POOL: FramePool<16> = FramePool::new();
+
+        let config = PipelineConfig {
+            capacity: 8,
+            batch_size: 4,
+            ..PipelineConfig::default()
+        };
+
+        let received = Arc::new(Mutex::new(Vec::new()));
+        let output = Arc::clone(&received);
+        let mut sequence = 0;
+
+        let pipeline = Pipeline::spawn(
+            &config,
+            move |batch: &mut Vec<FrameBuffer<'static, 16>>| {
+                while sequence < 1000 && batch.len() < 4 {
+                    let Some(mut buffer) = POOL.acquire() else {
+                        break;
+                    };
+
+                    buffer
+                        .fill_with(|slot| {
+                            Ok(pack_test_frame(slot, 1, sequence))
+                        })
+                        .unwrap();
+
+                    // Corrupt each 10th frame trailer.
+                    if sequence % 10 == 0 {
+                        let last = buffer.len() - 1;
+                        buffer[last] ^= 0xFF;
+                    }
+
+                    batch.push(buffer);
+                    sequence += 1;
+                }
+                sequence < 1000
+            },
+            |buffer| IdtpFrame::validate(buffer, None).is_ok(),
+            |buffer| {
+                let frame = IdtpFrame::try_from(&buffer[..]).ok()?;
+                Some(frame.header().sequence)
+            },
+            move |sequence| output.lock().unwrap().push(sequence),
+        )
+        .unwrap();
+
+        let stats = pipeline.join().unwrap();
+        let received = received.lock().unwrap();
+        let expected: Vec<u32> = (0..1000).filter(|i| i % 10 != 0).collect();
+
+        assert_eq!(*received, expected);
+        assert_eq!(stats[Stage::Rx as usize].items, 1000);
+        assert_eq!(stats[Stage::Validate as usize].items, 1000);
+        assert_eq!(stats[Stage::Decode as usize].items, 900);
+        assert_eq!(stats[Stage::Dispatch as usize].items, 900);
+    }
+
+    #[cfg(all(feature = "pipeline", feature = "software_impl"))]
+    #[test]
+    fn test_pipeline_shutdown() {
+        use idtp::pipeline::{Pipeline, PipelineConfig, Stage};
+        use std::sync::{
+            Arc,
+            atomic::{AtomicU32, Ordering},
+        };
+        use std::time::Duration;
+
+        let spawn = |dispatched: Arc<AtomicU32>| {
+            let mut sequence = 0u32;
+
+            Pipeline::spawn(
+                &PipelineConfig::default(),
+                move |batch: &mut Vec<u32>| {
+                    // Receive closure never finishes on its own.
+                    if sequence < 100 {
+                        batch.push(sequence);
+                        sequence += 1;
+                    } else {
+                        std::thread::sleep(Duration::from_millis(1));
+                    }
+                    true
+                },
+                |_| true,
+                Some,
+                move |_| {
+                    dispatched.fetch_add(1, Ordering::Relaxed);
+                },
+            )
+            .unwrap()
+        };
+
+        let dispatched = Arc::new(AtomicU32::new(0));
+        let pipeline = spawn(Arc::clone(&dispatched));
+
+        while dispatched.load(Ordering::Relaxed) < 100 {
+            std::thread::yield_now();
+        }
+
+        let stats = pipeline.shutdown().unwrap();
+
+        assert_eq!(stats[Stage::Rx as usize].items, 100);
+        assert_eq!(stats[Stage::Rx as usize].busy_ns, 0);
+        assert_eq!(stats[Stage::Dispatch as usize].items, 100);
+
+        // Dropping pipeline joins its workers as well.
+        let dispatched = Arc::new(AtomicU32::new(0));
+        drop(spawn(Arc::clone(&dispatched)));
+        let count = dispatched.load(Ordering::Relaxed);
+        std::thread::sleep(Duration::from_millis(5));
+
+        assert_eq!(Arc::strong_count(&dispatched), 1);
+        assert_eq!(dispatched.load(Ordering::Relaxed), count);
+    }
+
+    #[cfg(all(feature = "std", feature = "software_impl"))]
+    #[test]
+    fn test_parallel_validator_order() {
+        use idtp::validator::{ParallelValidator, Schedule};
+        use std::panic::AssertUnwindSafe;
+
+        // Skewed load: most frames come from single device in Secure mode.
+        let frames: Vec<Vec<u8>> = (0..64u32)
+            .map(|i| {
+                let (device_id, mode) =
+                    if i % 4 == 0 { (i, 0) } else { (1, 2) };
+
+                let mut frame = IdtpFrame::new();
+                frame.set_header(&IdtpHeader {
+                    mode,
+                    sequence: i,
+                    device_id: device_id as u16,
+                    ..IdtpHeader::new()
+                });
+                frame.set_payload(&Imu6::default()).unwrap();
+
+                let mut buffer = vec![0u8; frame.size()];
+                frame.pack(&mut buffer, Some(b"key")).unwrap();
+
+                if i % 7 == 3 {
+                    buffer[8] ^= 0x01;
+                }
+                buffer
+            })
+            .collect();
+
+        for schedule in [Schedule::WorkStealing, Schedule::RoundRobin] {
+            let report = ParallelValidator::new(4, schedule)
+                .unwrap()
+                .validate(&frames, Some(b"key"));
+
+            assert_eq!(report.results.len(), frames.len());
+            assert_eq!(report.per_worker.iter().sum::<usize>(), frames.len());
+
+            for (i, result) in report.results.iter().enumerate() {
+                assert_eq!(result.is_ok(), i % 7 != 3);
+            }
+
+            if schedule == Schedule::RoundRobin {
+                assert_eq!(report.steals, 0);
+            }
+        }
+
+        // Workers are reused across batches & panic of validation routine
+        // reaches calling thread.
+        let validator =
+            ParallelValidator::new(4, Schedule::WorkStealing).unwrap();
+        for batch in [&frames[..1], &frames[..], &frames[..5]] {
+            let report = validator.validate(batch, Some(b"key"));
+            assert_eq!(report.per_worker.len(), 4);
+            assert_eq!(report.results.len(), batch.len());
+        }
+
+        let panicked = std::panic::catch_unwind(AssertUnwindSafe(|| {
+            validator.validate_with(&frames, |frame| {
+                assert_ne!(frame, frames[17].as_slice(), "validator bug");
+                Ok(())
+            })
+        }));
+        assert!(panicked.is_err());
+
+        let report = validator.validate(&frames, Some(b"key"));
+        assert_eq!(report.valid_mask()[0].count_ones(), 64 - 9);
+    }
+
+    #[cfg(feature = "software_impl")]
+    #[test]
+    fn test_payload_dispatcher() {
+        use idtp::dispatch::{PayloadDispatcher, PayloadHandler};
+        use idtp::payload::Imu3Acc;
+
+        #[derive(Default)]
+        struct Context {
+            imu6: Vec<u32>,
+            custom: Vec<f32>,
+        }
+
+        impl PayloadHandler<Imu6> for Context {
+            fn handle(&mut self, header: &IdtpHeader, _payload: &Imu6) {
+                self.imu6.push(header.sequence);
+            }
+        }
+
+        impl PayloadHandler<TestPayload> for Context {
+            fn handle(&mut self, _header: &IdtpHeader, payload: &TestPayload) {
+                self.custom.push(payload.value);
+            }
+        }
+
+        const DISPATCHER: PayloadDispatcher<Context> = PayloadDispatcher::new()
+            .with::<Imu6>()
+            .with::<TestPayload>();
+
+        let frames: Vec<Vec<u8>> = (0..12u32)
+            .map(|i| {
+                let mut frame = IdtpFrame::new();
+                frame.set_header(&IdtpHeader {
+                    sequence: i,
+                    ..IdtpHeader::new()
+                });
+
+                match i % 3 {
+                    0 => frame.set_payload(&Imu6::default()).unwrap(),
+                    1 => frame
+                        .set_payload(&TestPayload { value: i as f32 })
+                        .unwrap(),
+                    _ => frame.set_payload(&Imu3Acc::default()).unwrap(),
+                }
+
+                let mut buffer = vec![0u8; frame.size()];
+                frame.pack(&mut buffer, None).unwrap();
+                buffer
+            })
+            .collect();
+
+        let mut context = Context::default();
+        let frame = IdtpFrame::try_from(&frames[0][..]).unwrap();
+        DISPATCHER.dispatch(&mut context, &frame).unwrap();
+        assert!(DISPATCHER.dispatch_raw(&mut context, &frames[2]).is_err());
+        assert_eq!(context.imu6, [0]);
+
+        let mut context = Context::default();
+        let mut order = [0usize; 12];
+        let dispatched = DISPATCHER
+            .dispatch_batch(&mut context, &frames, &mut order)
+            .unwrap();
+
+        assert_eq!(dispatched, 8);
+        assert_eq!(context.imu6, [0, 3, 6, 9]);
+        assert_eq!(context.custom, [1.0, 4.0, 7.0, 10.0]);
+    }
+
+    #[cfg(feature = "software_impl")]
+    #[test]
+    fn test_frame_filter_rules() {
+        use idtp::filter::{FilterRule, FrameFilter};
+
+        let mut filter = FrameFilter::new();
+        filter.set_all_devices(false);
+        filter.set_device(7, true);
+        filter.set_modes(&[IdtpMode::Safety]);
+
+        let pack = |device_id: u16, mode: u8, version: u8| {
+            let mut frame = IdtpFrame::new();
+            frame.set_header(&IdtpHeader {
+                device_id,
+                mode,
+                version,
+                ..IdtpHeader::new()
+            });
+            frame.set_payload(&Imu6::default()).unwrap();
+
+            let mut buffer = vec![0u8; frame.size()];
+            frame.pack(&mut buffer, Some(b"key")).unwrap();
+            buffer
+        };
+
+        let accepted = pack(7, 1, IDTP_VERSION);
+        let header = filter.check(&accepted).unwrap();
+        let device_id = header.device_id;
+        assert_eq!(device_id, 7);
+
+        let cases = [
+            (pack(8, 1, IDTP_VERSION), FilterRule::Device),
+            (pack(7, 2, IDTP_VERSION), FilterRule::Mode),
+            (pack(7, 1, 0x10), FilterRule::Version),
+            (accepted[..accepted.len() - 1].to_vec(), FilterRule::Size),
+            (accepted[4..].to_vec(), FilterRule::Preamble),
+        ];
+
+        for (buffer, rule) in &cases {
+            assert_eq!(filter.check(buffer).unwrap_err(), *rule);
+            assert_eq!(filter.rejected(*rule), 1);
+        }
+
+        filter.set_payload_type(Imu6::TYPE_ID, false);
+        assert_eq!(
+            filter.check(&accepted).unwrap_err(),
+            FilterRule::PayloadType
+        );
+        assert_eq!(filter.accepted(), 1);
+    }
+
+    #[test]
+    fn test_reorder_buffer_deadline() {
+        use idtp::reorder::ReorderBuffer;
+
+        let mut buffer: ReorderBuffer<u32, 8> = ReorderBuffer::new(100);
+        let mut released = Vec::new();
+
+        for (now, sequence) in [(0, 10), (1, 12), (2, 11), (3, 14), (4, 15)] {
+            buffer.push(sequence, now, sequence).unwrap();
+
+            while let Some(item) = buffer.pop(now) {
+                released.push(item);
+            }
+        }
+
+        // Frame 13 is missing, 14 & 15 wait for deadline.
+        assert_eq!(released, [10, 11, 12]);
+        assert_eq!(buffer.pop(50), None);
+        assert_eq!(buffer.pop(103), Some(14));
+        assert_eq!(buffer.pop(103), Some(15));
+        assert_eq!(buffer.pop(103), None);
+
+        // Late, duplicate & out-of-window frames.
+        assert_eq!(buffer.push(13, 104, 13), Err(13));
+        buffer.push(17, 105, 17).unwrap();
+        assert_eq!(buffer.push(17, 106, 17), Err(17));
+        assert_eq!(buffer.push(30, 107, 30), Err(30));
+        assert_eq!(buffer.flush(), Some(17));
+
+        let stats = *buffer.stats();
+        assert_eq!(stats.released, 6);
+        assert_eq!(stats.lost, 2);
+        assert_eq!(stats.late, 1);
+        assert_eq!(stats.duplicates, 1);
+        assert_eq!(stats.overflows, 1);
+
+        // Device restart resynchronises empty buffer.
+        buffer.push(0, 200, 0).unwrap();
+        assert_eq!(buffer.pop(200), Some(0));
+
+        // Reordering across sequence number wraparound.
+        let mut buffer: ReorderBuffer<u32, 8> = ReorderBuffer::new(100);
+        for sequence in [u32::MAX - 1, 0, u32::MAX, 1] {
+            buffer.push(sequence, 0, sequence).unwrap();
+        }
+        let released: Vec<u32> =
+            core::iter::from_fn(|| buffer.pop(0)).collect();
+        assert_eq!(released, [u32::MAX - 1, u32::MAX, 0, 1]);
+        assert_eq!(buffer.stats().duplicates, 0);
+    }
+
+    #[cfg(feature = "std")]
+    #[test]
+    fn test_merge_stream_watermark() {
+        use idtp::merge::MergeStream;
+
+        let mut stream: MergeStream<u32> = MergeStream::new(5, 100);
+        let mut released = Vec::new();
+
+        // Source 1 clock is 1000 units ahead.
+        assert!(stream.set_offset(1, -1000));
+
+        for i in 0..50u64 {
+            stream.push(0, i * 10, 0).unwrap();
+            stream.push(1, 1005 + i * 10, 1).unwrap();
+
+            if i % 2 == 0 {
+                stream.push(2, i * 10 + 3, 2).unwrap();
+            }
+
+            // Source 3 is silent, source 4 stops after first frame.
+            if i == 0 {
+                stream.push(4, 1, 4).unwrap();
+            }
+
+            while let Some(merged) = stream.pop() {
+                released.push(merged);
+            }
+        }
+
+        stream.advance(u64::MAX);
+
+        while let Some(merged) = stream.pop() {
+            released.push(merged);
+        }
+
+        assert_eq!(released.len(), 50 + 50 + 25 + 1);
+        assert!(
+            released
+                .windows(2)
+                .all(|w| w[0].timestamp <= w[1].timestamp)
+        );
+        assert_eq!(released[1].source, 4);
+
+        // Late frame of silent source.
+        assert_eq!(stream.push(3, 5, 3), Err(3));
+        assert_eq!(stream.stats().late, 1);
+        assert_eq!(stream.stats().released, 126);
+    }
+
+    #[test]
+    fn test_timestamp_tracker_mapping() {
+        use idtp::clock::TimestampTracker;
+
+        let mut tracker = TimestampTracker::new(0.9999);
+        let start = u32::MAX - 500_000;
+        let host_at = |k: u64| {
+            // Sensor clock is 5 s behind & 50 ppm slower than host clock.
+            let sensor_ns = k * 1_000_000;
+            let jitter = (k * 7919) % 100_000;
+            5_000_000_000 + sensor_ns + sensor_ns / 20_000 + jitter
+        };
+
+        for k in 0..5000u64 {
+            let timestamp = start.wrapping_add((k * 1000) as u32);
+            let unwrapped = tracker.observe(timestamp, host_at(k));
+            assert_eq!(unwrapped, u64::from(start) + k * 1000);
+        }
+
+        // Late frame before wrap is unwrapped relative to the latest one.
+        let late = start.wrapping_add(4990 * 1000);
+        assert_eq!(tracker.unwrap(late), u64::from(start) + 4990 * 1000);
+
+        let drift = tracker.drift_ppm();
+        assert!((drift - 50.0).abs() < 5.0, "drift: {drift}");
+
+        let header = IdtpHeader {
+            timestamp: start.wrapping_add(6000 * 1000),
+            ..IdtpHeader::new()
+        };
+        let expected = host_at(6000) - (6000 * 7919) % 100_000 + 50_000;
+        let error = header.host_time_ns(&tracker).abs_diff(expected);
+        assert!(error < 100_000, "error: {error}");
+
+        // Epoch host time keeps nanosecond resolution.
+        let epoch = 1_700_000_000_000_000_123u64;
+        let mut tracker = TimestampTracker::new(0.9999);
+        for k in 0..100u32 {
+            tracker.observe(k * 1000, epoch + u64::from(k) * 1_000_000);
+        }
+        for k in 100..110u32 {
+            let host = tracker.host_time_ns(k * 1000);
+            let expected = epoch + u64::from(k) * 1_000_000;
+            assert!(host.abs_diff(expected) < 8, "{host} vs {expected}");
+        }
+    }
+
+    #[test]
+    fn test_dedup_links() {
+        use idtp::dedup::{DEDUP_WINDOW, Deduplicator, Verdict};
+
+        let mut dedup: Deduplicator<4, 2> = Deduplicator::new();
+        let mut forwarded = Vec::new();
+
+        for sequence in 0..200u32 {
+            let now = u64::from(sequence) * 10;
+            // Link 1 is faster for every 4th frame.
+            let (first, second) =
+                if sequence % 4 == 0 { (1, 0) } else { (0, 1) };
+
+            for (link, delay) in [(first, 0), (second, 3)] {
+                let verdict = dedup.accept(link, 3, sequence, now + delay);
+
+                if verdict == Verdict::First {
+                    forwarded.push(sequence);
+                }
+            }
+        }
+
+        assert_eq!(forwarded, (0..200).collect::<Vec<_>>());
+        assert_eq!(dedup.link_stats(0).first, 150);
+        assert_eq!(dedup.link_stats(1).first, 50);
+        assert_eq!(dedup.link_stats(1).duplicates, 150);
+        assert_eq!(dedup.link_stats(0).mean_lead(), 3);
+        assert!((dedup.win_rate(1) - 0.25).abs() < 1e-9);
+
+        let old = 199 - DEDUP_WINDOW as u32;
+        assert_eq!(dedup.accept(0, 3, old, 2000), Verdict::Stale);
+        assert_eq!(dedup.accept(0, 3, old + 1, 2000), Verdict::Duplicate);
+
+        // Other devices are tracked independently.
+        assert_eq!(dedup.accept(1, 4, 5, 2000), Verdict::First);
+        assert_eq!(dedup.accept(0, 4, 5, 2001), Verdict::Duplicate);
+
+        // Truncated frame is reported separately from stale ones.
+        let mut frame = [0u8; 64];
+        let size = pack_test_frame(&mut frame, 0, 6);
+        assert_eq!(dedup.accept_frame(0, &frame[..size], 2002), Verdict::First);
+        assert_eq!(
+            dedup.accept_frame(1, &frame[..8], 2003),
+            Verdict::Malformed
+        );
+        assert_eq!(dedup.stale(), 1);
+        assert_eq!(dedup.malformed(), 1);
+    }
+
+    #[cfg(feature = "software_impl")]
+    fn fec_round_trip<const M: usize>(
+        scheme: idtp::fec::FecScheme,
+        lost: &[u32],
+    ) -> usize {
+        use idtp::fec::{FEC_PAYLOAD_TYPE, FecDecoder, FecEncoder};
+
+        let mut encoder = FecEncoder::<M>::new(scheme, 8).unwrap();
+        let mut decoder: FecDecoder<16, M> = FecDecoder::new();
+        let mut frames = [[0u8; 128]; 8];
+        let mut recovered = 0;
+
+        for (sequence, frame) in (100..).zip(frames.iter_mut()) {
+            let mode = (sequence % 3) as u8;
+            let size = pack_test_frame(frame, mode, sequence);
+            let ready = encoder.push(&frame[..size]).unwrap();
+
+            if !lost.contains(&sequence) {
+                decoder.push_data(&frame[..size]).unwrap();
+            }
+            assert_eq!(ready, sequence == 107);
+        }
+
+        for index in 0..M {
+            let mut parity = IdtpFrame::new();
+            parity.set_header(&IdtpHeader {
+                sequence: 107,
+                ..IdtpHeader::new()
+            });
+            encoder.parity_frame(index, &mut parity).unwrap();
+            assert_eq!(parity.header().payload_type, FEC_PAYLOAD_TYPE);
+
+            let mut buffer = [0u8; IDTP_FRAME_MAX_SIZE];
+            let size = parity.pack(&mut buffer, None).unwrap();
+
+            recovered += decoder
+                .push_parity(&buffer[..size], |frame| {
+                    assert!(IdtpFrame::validate(frame, Some(b"key")).is_ok());
+
+                    let sequence =
+                        IdtpFrame::try_from(frame).unwrap().header().sequence;
+                    let original = &frames[(sequence - 100) as usize];
+                    assert_eq!(frame, &original[..frame.len()]);
+                    assert!(lost.contains(&sequence));
+                })
+                .unwrap();
+        }
+
+        assert_eq!(decoder.stats().recovered, recovered as u64);
+        recovered
+    }
+
+    #[cfg(feature = "software_impl")]
+    #[test]
+    fn test_fec_recovery() {
+        use idtp::fec::{FecEncoder, FecScheme};
+
+        assert!(FecEncoder::<2>::new(FecScheme::Xor, 8).is_err());
+        assert!(FecEncoder::<1>::new(FecScheme::ReedSolomon, 0).is_err());
+
+        assert_eq!(fec_round_trip::<1>(FecScheme::Xor, &[]), 0);
+        assert_eq!(fec_round_trip::<1>(FecScheme::Xor, &[105]), 1);
+        assert_eq!(fec_round_trip::<1>(FecScheme::Xor, &[101, 102]), 0);
+        assert_eq!(fec_round_trip::<3>(FecScheme::ReedSolomon, &[100]), 1);
+        assert_eq!(
+            fec_round_trip::<3>(FecScheme::ReedSolomon, &[101, 104, 107]),
+            3
+        );
+        assert_eq!(
+            fec_round_trip::<2>(FecScheme::ReedSolomon, &[100, 101, 102]),
+            0
+        );
+    }
+
+    #[cfg(feature = "software_impl")]
+    #[test]
+    fn test_dedup_fec() {
+        use idtp::dedup::{Deduplicator, Verdict};
+        use idtp::fec::{FEC_PAYLOAD_TYPE, FecDecoder, FecEncoder, FecScheme};
+
+        let mut encoder =
+            FecEncoder::<2>::new(FecScheme::ReedSolomon, 4).unwrap();
+        let mut dedup: Deduplicator<4, 2> = Deduplicator::new();
+        let mut decoder: FecDecoder<8, 2> = FecDecoder::new();
+        let mut frames = Vec::new();
+
+        for sequence in 100..104 {
+            let mut buffer = [0u8; 128];
+            let size = pack_test_frame(&mut buffer, 1, sequence);
+            encoder.push(&buffer[..size]).unwrap();
+            frames.push(buffer[..size].to_vec());
+        }
+
+        // Parity frames repeat sequence of the last data frame of group.
+        for index in 0..2 {
+            let mut parity = IdtpFrame::new();
+            parity.set_header(&IdtpHeader {
+                sequence: 103,
+                ..IdtpHeader::new()
+            });
+            encoder.parity_frame(index, &mut parity).unwrap();
+
+            let mut buffer = [0u8; IDTP_FRAME_MAX_SIZE];
+            let size = parity.pack(&mut buffer, None).unwrap();
+            frames.push(buffer[..size].to_vec());
+        }
+
+        // Both links deliver every frame except data frames 101 & 102.
+        let mut recovered = Vec::new();
+        for (now, link) in [(0, 0), (10, 1)] {
+            for frame in [&frames[0], &frames[3], &frames[4], &frames[5]] {
+                let verdict = dedup.accept_frame(link, frame, now);
+                assert_eq!(verdict == Verdict::First, link == 0);
+
+                if verdict != Verdict::First {
+                    continue;
+                }
+
+                let (header, _) = IdtpHeader::read_from_prefix(frame).unwrap();
+                if header.payload_type == FEC_PAYLOAD_TYPE {
+                    decoder
+                        .push_parity(frame, |rebuilt| {
+                            recovered.push(rebuilt.to_vec());
+                        })
+                        .unwrap();
+                } else {
+                    decoder.push_data(frame).unwrap();
+                }
+            }
+        }
+
+        assert_eq!(recovered, [frames[1].clone(), frames[2].clone()]);
+        assert_eq!(dedup.link_stats(1).duplicates, 4);
+
+        // Parity frame without parity header is dropped.
+        let mut truncated = frames[4].clone();
+        truncated.truncate(IDTP_HEADER_SIZE + 2);
+        assert_eq!(dedup.accept_frame(0, &truncated, 20), Verdict::Malformed);
+    }
+
+    #[cfg(feature = "software_impl")]
+    #[test]
+    fn test_fec_inconsistent_group() {
+        use idtp::fec::{FecDecoder, FecEncoder, FecScheme};
+
+        let mut encoder =
+            FecEncoder::<2>::new(FecScheme::ReedSolomon, 3).unwrap();
+        let mut decoder: FecDecoder<4, 2> = FecDecoder::new();
+        let mut frames = [[0u8; 128]; 3];
+        let mut sizes = [0; 3];
+
+        for (sequence, (frame, size)) in
+            (100..).zip(frames.iter_mut().zip(&mut sizes))
+        {
+            *size = pack_test_frame(frame, 0, sequence);
+            encoder.push(&frame[..*size]).unwrap();
+        }
+
+        let parity = |index| {
+            let mut parity = IdtpFrame::new();
+            parity.set_header(&IdtpHeader {
+                sequence: 102,
+                ..IdtpHeader::new()
+            });
+            encoder.parity_frame(index, &mut parity).unwrap();
+
+            let mut buffer = [0u8; IDTP_FRAME_MAX_SIZE];
+            let size = parity.pack(&mut buffer, None).unwrap();
+            buffer[..size].to_vec()
+        };
+
+        // Frame 101 is longer than parity data, frame 102 is lost.
+        decoder.push_data(&frames[0][..sizes[0]]).unwrap();
+        decoder.push_data(&frames[1]).unwrap();
+        assert!(matches!(
+            decoder.push_parity(&parity(0), |_| panic!("rebuilt frame")),
+            Err(IdtpError::ParseError)
+        ));
+
+        // Parity frames are intact after error.
+        let mut recovered = Vec::new();
+        decoder.push_data(&frames[1][..sizes[1]]).unwrap();
+        let count = decoder
+            .push_parity(&parity(1), |frame| recovered.extend_from_slice(frame))
+            .unwrap();
+        assert_eq!(count, 1);
+        assert_eq!(recovered, &frames[2][..sizes[2]]);
+    }
+
+    #[cfg(all(feature = "software_impl", feature = "crc_correction"))]
+    #[test]
+    fn test_crc_correction() {
+        use idtp::correction::{Correction, CrcCorrector, correct};
+
+        let mut original = [0u8; 64];
+        let size = pack_test_frame(&mut original, 1, 42);
+        let mut corrector = CrcCorrector::new();
+
+        let mut frame = original;
+        assert!(matches!(
+            corrector.check(&mut frame[..size]),
+            Ok(Correction::None)
+        ));
+
+        // Every single-bit error is located & corrected.
+        for bit in 0..size * 8 {
+            let mut frame = original;
+            frame[bit / 8] ^= 1 << (bit % 8);
+
+            let Ok(correction) = corrector.check(&mut frame[..size]) else {
+                // Size & mode fields define checked region.
+                assert!((14 * 8..16 * 8).contains(&bit) || bit / 8 == 17);
+                continue;
+            };
+
+            assert_eq!(frame, original);
+            match correction {
+                Correction::Data { bit: corrected } => {
+                    assert_eq!(corrected, bit)
+                }
+                Correction::Trailer { bit: corrected } => {
+                    assert_eq!(corrected + (size - 4) * 8, bit)
+                }
+                Correction::None => panic!("error is not detected"),
+            }
+            assert!(IdtpFrame::validate(&frame[..size], None).is_ok());
+        }
+
+        let stats = *corrector.stats();
+        assert_eq!(stats.valid, 1);
+        assert_eq!(stats.corrected, (size as u64 - 3) * 8);
+
+        // Double-bit error is not miscorrected.
+        let mut frame = original;
+        frame[25] ^= 0x11;
+        assert!(correct(&mut frame[..size]).is_err());
+        assert_eq!(frame[25], original[25] ^ 0x11);
+    }
+
+    #[cfg(feature = "std_payloads")]
+    #[test]
+    fn test_imu_batch() {
+        use idtp::batch::{BatchView, ImuBatch};
+        use idtp::payload::Imu3Acc;
+
+        let sample = |value| Imu3Acc {
+            acc_x: value,
+            acc_y: -value,
+            acc_z: 9.81,
+        };
+        let batch = ImuBatch::<Imu3Acc, 4>::new([
+            (0, sample(0.0)),
+            (1000, sample(1.0)),
+            (1000, sample(2.0)),
+            (1500, sample(3.0)),
+        ]);
+        assert_eq!(ImuBatch::<Imu3Acc, 4>::TYPE_ID, 0x10);
+        assert_eq!(batch.size(), 4 * (2 + 12));
+
+        let mut frame = IdtpFrame::new();
+        frame.set_header(&IdtpHeader {
+            timestamp: 5000,
+            ..IdtpHeader::new()
+        });
+        frame.set_payload(&batch).unwrap();
+
+        let view = BatchView::<Imu3Acc>::from_frame(&frame).unwrap();
+        assert_eq!(view.len(), 4);
+
+        let timestamps: Vec<u32> = view.iter().map(|(ts, _)| ts).collect();
+        assert_eq!(timestamps, [5000, 6000, 7000, 8500]);
+
+        for (index, (_, acc)) in view.into_iter().enumerate() {
+            let acc_y = acc.acc_y;
+            assert_eq!(acc_y, -(index as f32));
+        }
+
+        // Shorter batch is accepted, other payload types are not.
+        let partial = BatchView::<Imu3Acc>::new(&batch.to_bytes()[..28], 0);
+        assert_eq!(partial.unwrap().iter().len(), 2);
+        assert!(BatchView::<Imu6>::from_frame(&frame).is_err());
+        assert!(BatchView::<Imu3Acc>::new(&[0; 13], 0).is_err());
+    }
+
+    #[cfg(feature = "std_payloads")]
+    #[test]
+    fn test_quantized_payloads() {
+        use idtp::payload::{AsMetricsArray, Imu3Acc, Imu3Gyr, Imu3Mag, Imu10};
+        use idtp::quantized::{
+            QImu6, QImu10, dequantize, exponent_for, quantize,
+        };
+
+        let imu = Imu10 {
+            acc: Imu3Acc {
+                acc_x: 0.12,
+                acc_y: -9.81,
+                acc_z: 3.5,
+            },
+            gyr: Imu3Gyr {
+                gyr_x: 0.001,
+                gyr_y: -0.25,
+                gyr_z: 1.75,
+            },
+            mag: Imu3Mag {
+                mag_x: 25.0,
+                mag_y: -48.5,
+                mag_z: 12.25,
+            },
+            baro: 101_325.0,
+        };
+
+        let quantized = QImu10::from_payload(&imu);
+        assert_eq!(QImu10::TYPE_ID, 0x25);
+        assert_eq!(QImu6::TYPE_ID, 0x23);
+        assert_eq!(quantized.size(), 4 + 20);
+
+        let mut frame = IdtpFrame::new();
+        frame.set_payload(&quantized).unwrap();
+        let decoded = frame.payload::<QImu10>().unwrap().to_payload().unwrap();
+
+        for (field, (original, decoded)) in imu
+            .to_array()
+            .into_iter()
+            .zip(decoded.to_array())
+            .enumerate()
+        {
+            let unit = quantized.scale(field).unwrap();
+            assert!((original - decoded).abs() <= unit / 2.0, "field {field}");
+        }
+        assert!(quantized.scale(10).is_none());
+
+        // Kernels on long slices & saturation.
+        let input: Vec<f32> = (0..37).map(|i| i as f32 * 0.37 - 6.0).collect();
+        let exponent = exponent_for(&input);
+        let mut fixed = vec![0i16; input.len()];
+        let mut output = vec![0f32; input.len() + 5];
+        quantize(&input, exponent, &mut fixed).unwrap();
+        dequantize(&fixed, exponent, &mut output).unwrap();
+
+        let unit = 2f32.powi(i32::from(exponent));
+        assert!(fixed.iter().any(|value| value.unsigned_abs() > 16384));
+        for (original, decoded) in input.iter().zip(&output) {
+            assert!((original - decoded).abs() <= unit / 2.0);
+        }
+        assert_eq!(output[input.len()..], [0.0; 5]);
+
+        quantize(&[1e9, -1e9], 0, &mut fixed[..2]).unwrap();
+        assert_eq!(fixed[..2], [i16::MAX, i16::MIN]);
+        assert_eq!(exponent_for(&[0.0; 3]), -126);
+    }
+
+    #[cfg(feature = "std_payloads")]
+    #[test]
+    fn test_compressed_payloads() {
+        use idtp::compress::{
+            compress_delta, compress_xor, decompress_delta, decompress_xor,
+        };
+        use idtp::payload::{AsMetricsArray, Imu3Acc, Imu3Gyr, Imu3Mag, Imu9};
+        use idtp::quantized::QImu9;
+
+        const COUNT: usize = 64;
+
+        // Slowly changing signal with a few constant fields.
+        let samples: Vec<(u16, Imu9)> = (0..COUNT)
+            .map(|i| {
+                let t = i as f32 * 0.01;
+                let dt = if i == 40 { 1500 } else { 1000 };
+                let imu = Imu9 {
+                    acc: Imu3Acc {
+                        acc_x: 0.0,
+                        acc_y: 0.0,
+                        acc_z: 9.81,
+                    },
+                    gyr: Imu3Gyr {
+                        gyr_x: t.sin() * 0.5,
+                        gyr_y: 0.25,
+                        gyr_z: -t,
+                    },
+                    mag: Imu3Mag {
+                        mag_x: 25.0,
+                        mag_y: -48.5,
+                        mag_z: 12.0 + (i / 8) as f32,
+                    },
+                };
+                (dt, imu)
+            })
+            .collect();
+
+        let mut payload = [0u8; IDTP_PAYLOAD_MAX_SIZE];
+        let size = compress_xor(&samples, &mut payload).unwrap();
+        assert!(size * 3 < COUNT * size_of::<Imu9>());
+
+        let mut timestamps = [0u32; COUNT + 1];
+        let mut columns = [0f32; 9 * (COUNT + 1)];
+        let count = decompress_xor::<9>(
+            &payload[..size],
+            5,
+            &mut timestamps,
+            &mut columns,
+        )
+        .unwrap();
+        assert_eq!(count, COUNT);
+
+        let mut timestamp = 5;
+        for (i, (dt, imu)) in samples.iter().enumerate() {
+            timestamp += u32::from(*dt);
+            assert_eq!(timestamps[i], timestamp);
+            for (field, value) in imu.to_array().into_iter().enumerate() {
+                let decoded = columns[field * (COUNT + 1) + i];
+                assert_eq!(decoded.to_bits(), value.to_bits());
+            }
+        }
+
+        // Output buffers too short & truncated payload.
+        assert!(matches!(
+            decompress_xor::<9>(
+                &payload[..size],
+                0,
+                &mut timestamps[..8],
+                &mut columns
+            ),
+            Err(IdtpError::BufferOverflow)
+        ));
+        assert!(
+            decompress_xor::<9>(
+                &payload[..size / 2],
+                0,
+                &mut timestamps,
+                &mut columns
+            )
+            .is_err()
+        );
+        assert!(matches!(
+            compress_xor(&samples, &mut payload[..16]),
+            Err(IdtpError::BufferOverflow)
+        ));
+
+        // Quantised samples.
+        let quantized: Vec<(u16, QImu9)> = samples[..COUNT / 2]
+            .iter()
+            .map(|(dt, imu)| (*dt, QImu9::from_payload(imu)))
+            .collect();
+        let size = compress_delta(&quantized, &mut payload).unwrap();
+        assert!(size < COUNT / 2 * size_of::<QImu9>());
+
+        let count = decompress_delta::<9, 3>(
+            &payload[..size],
+            5,
+            &mut timestamps,
+            &mut columns,
+        )
+        .unwrap();
+        assert_eq!(count, COUNT / 2);
+
+        for (i, (_, sample)) in quantized.iter().enumerate() {
+            for (field, value) in sample.to_array().into_iter().enumerate() {
+                assert_eq!(columns[field * (COUNT + 1) + i], value);
+            }
+        }
+        assert!(
+            decompress_delta::<9, 3>(
+                &payload[..size - 1],
+                0,
+                &mut timestamps,
+                &mut columns
+            )
+            .is_err()
+        );
+
+        // Malformed payloads: time delta overflows on the second sample,
+        // field value does not fit into `i16`.
+        let mut overflow = vec![2, 0, 0xFE, 0xFF, 0xFF, 0xFF, 0x0F];
+        overflow.extend([0; 12]);
+        overflow.push(2);
+        overflow.extend([0; 12]);
+        assert!(matches!(
+            decompress_delta::<9, 3>(
+                &overflow,
+                0,
+                &mut timestamps,
+                &mut columns
+            ),
+            Err(IdtpError::ParseError)
+        ));
+
+        let mut wide = vec![1, 0, 0, 0, 0, 0, 0x80, 0xF1, 0x04];
+        wide.extend([0; 8]);
+        assert!(matches!(
+            decompress_delta::<9, 3>(&wide, 0, &mut timestamps, &mut columns),
+            Err(IdtpError::ParseError)
+        ));
+    }
+
+    #[cfg(all(
+        feature = "header_compression",
+        feature = "cobs",
+        feature = "software_impl"
+    ))]
+    #[test]
+    fn test_header_compression() {
+        use idtp::cobs;
+        use idtp::hcomp::{
+            HC_CO_MIN_HEADER_SIZE, HC_IR_HEADER_SIZE, HeaderCompressor,
+            HeaderDecompressor,
+        };
+
+        const FRAMES: u32 = 200;
+        const REFRESH: u16 = 50;
+        // 115200 baud with 8N1 framing.
+        const LINK_BYTES_PER_SECOND: f64 = 115_200.0 / 10.0;
+
+        let pack = |buffer: &mut [u8], sequence: u32, timestamp: u32| {
+            let mut frame = IdtpFrame::new();
+            frame.set_header(&IdtpHeader {
+                sequence,
+                timestamp,
+                ..IdtpHeader::new()
+            });
+            frame.set_payload(&Imu6::default()).unwrap();
+            frame.pack(buffer, None).unwrap()
+        };
+
+        let mut compressor = HeaderCompressor::new(3, REFRESH).unwrap();
+        let mut decompressor = HeaderDecompressor::new();
+        let mut frame = [0u8; IDTP_FRAME_MAX_SIZE];
+        let mut packet = [0u8; IDTP_FRAME_MAX_SIZE];
+        let mut restored = [0u8; IDTP_FRAME_MAX_SIZE];
+        let mut encoded = [0u8; cobs::COBS_FRAME_MAX_SIZE];
+        let (mut raw_bytes, mut compressed_bytes) = (0, 0);
+        let mut timestamp = 0;
+        let mut co_min = 0;
+
+        for sequence in 0..FRAMES {
+            // Jitter & a sequence gap.
+            timestamp += if sequence % 37 == 0 { 1200 } else { 1000 };
+            let sequence = if sequence > 100 {
+                sequence + 1
+            } else {
+                sequence
+            };
+
+            let size = pack(&mut frame, sequence, timestamp);
+            let packet_size =
+                compressor.compress(&frame[..size], &mut packet).unwrap();
+
+            let header_size = packet_size - (size - IDTP_HEADER_SIZE);
+            if matches!(sequence, 0 | 50 | 100 | 151) {
+                assert_eq!(header_size, HC_IR_HEADER_SIZE);
+            } else if header_size == HC_CO_MIN_HEADER_SIZE {
+                co_min += 1;
+            } else {
+                assert!(header_size <= 6, "{sequence}: {header_size}");
+            }
+
+            let restored_size = decompressor
+                .decompress(&packet[..packet_size], &mut restored)
+                .unwrap();
+            assert_eq!(restored[..restored_size], frame[..size]);
+            IdtpFrame::validate(&restored[..restored_size], None).unwrap();
+
+            raw_bytes += cobs::encode(&frame[..size], &mut encoded).unwrap();
+            compressed_bytes +=
+                cobs::encode(&packet[..packet_size], &mut encoded).unwrap();
+        }
+
+        assert!(co_min > 180, "{co_min}");
+
+        let raw_rate =
+            LINK_BYTES_PER_SECOND * f64::from(FRAMES) / raw_bytes as f64;
+        let compressed_rate =
+            LINK_BYTES_PER_SECOND * f64::from(FRAMES) / compressed_bytes as f64;
+        assert!(
+            compressed_rate > raw_rate * 1.5,
+            "{raw_rate:.0} -> {compressed_rate:.0} frames/s"
+        );
+
+        // Lost packet: reconstructed header fails validation until refresh.
+        let mut compressor = HeaderCompressor::new(0, 4).unwrap();
+        let mut sizes = [0; 5];
+        let mut packets = [[0u8; 128]; 5];
+        for (index, (packet, packet_size)) in
+            packets.iter_mut().zip(&mut sizes).enumerate()
+        {
+            let index = index as u32;
+            let size = pack(&mut frame, index, index * 1000);
+            *packet_size = compressor.compress(&frame[..size], packet).unwrap();
+        }
+
+        let mut decompressor = HeaderDecompressor::new();
+        decompressor
+            .decompress(&packets[0][..sizes[0]], &mut restored)
+            .unwrap();
+        decompressor
+            .decompress(&packets[1][..sizes[1]], &mut restored)
+            .unwrap();
+        let size = decompressor
+            .decompress(&packets[3][..sizes[3]], &mut restored)
+            .unwrap();
+        assert!(matches!(
+            IdtpFrame::validate(&restored[..size], None),
+            Err(IdtpError::InvalidCrc)
+        ));
+
+        decompressor.invalidate(0);
+        assert!(matches!(
+            decompressor.decompress(&packets[3][..sizes[3]], &mut restored),
+            Err(IdtpError::ParseError)
+        ));
+        assert_eq!(
+            sizes[4] - sizes[3],
+            HC_IR_HEADER_SIZE - HC_CO_MIN_HEADER_SIZE
+        );
+        let size = decompressor
+            .decompress(&packets[4][..sizes[4]], &mut restored)
+            .unwrap();
+        IdtpFrame::validate(&restored[..size], None).unwrap();
+
+        // Failed compression leaves context untouched.
+        let mut compressor = HeaderCompressor::new(0, 4).unwrap();
+        let mut short = [0u8; HC_IR_HEADER_SIZE + 1];
+        let size = pack(&mut frame, 0, 0);
+        assert!(matches!(
+            compressor.compress(&frame[..size], &mut short),
+            Err(IdtpError::BufferOverflow)
+        ));
+        let ir = compressor.compress(&frame[..size], &mut packet).unwrap();
+        assert_eq!(ir - size, HC_IR_HEADER_SIZE - IDTP_HEADER_SIZE);
+
+        let size = pack(&mut frame, 1, 1000);
+        assert!(matches!(
+            compressor.compress(&frame[..size], &mut short),
+            Err(IdtpError::BufferOverflow)
+        ));
+        compressor.compress(&frame[..size], &mut packet).unwrap();
+        let size = pack(&mut frame, 2, 2000);
+        let co = compressor.compress(&frame[..size], &mut packet).unwrap();
+        assert_eq!(size - co, IDTP_HEADER_SIZE - HC_CO_MIN_HEADER_SIZE);
+
+        // Failed decompression leaves context untouched, retry succeeds.
+        let mut decompressor = HeaderDecompressor::new();
+        let mut short = [0u8; IDTP_HEADER_SIZE + 1];
+        for (index, (packet, packet_size)) in
+            packets.iter().zip(sizes).enumerate().take(3)
+        {
+            assert!(matches!(
+                decompressor.decompress(&packet[..packet_size], &mut short),
+                Err(IdtpError::BufferOverflow)
+            ));
+            let size = decompressor
+                .decompress(&packet[..packet_size], &mut restored)
+                .unwrap();
+            IdtpFrame::validate(&restored[..size], None).unwrap();
+            let frame = IdtpFrame::try_from(&restored[..size]).unwrap();
+            let sequence = frame.header().sequence;
+            assert_eq!(sequence, index as u32);
+        }
+
+        assert!(HeaderCompressor::new(16, 1).is_err());
+        assert!(HeaderCompressor::new(0, 0).is_err());
+    }
+
+    #[cfg(all(feature = "std", feature = "software_impl"))]
+    #[test]
+    fn test_coalescer() {
+        use idtp::coalesce::{COALESCE_DEFAULT_MTU, Coalescer, DatagramFrames};
+        use idtp::validator::{ParallelValidator, Schedule};
+
+        const DEVICES: u32 = 4;
+        const PERIOD: u64 = 1000;
+        const MAX_DELAY: u64 = 2000;
+
+        let mut coalescer = Coalescer::<COALESCE_DEFAULT_MTU>::new(
+            COALESCE_DEFAULT_MTU,
+            MAX_DELAY,
+        )
+        .unwrap();
+        let mut datagrams: Vec<Vec<u8>> = Vec::new();
+        let mut buffer = [0u8; IDTP_FRAME_MAX_SIZE];
+        let mut sent = 0;
+
+        // 4 devices at 1 kHz for 100 ms.
+        for tick in 0..100 {
+            for device in 0..DEVICES {
+                let now = tick * PERIOD + u64::from(device) * PERIOD / 4;
+                let mut frame = IdtpFrame::new();
+                frame.set_header(&IdtpHeader {
+                    device_id: device as u16,
+                    sequence: tick as u32,
+                    mode: IdtpMode::Safety.into(),
+                    ..IdtpHeader::new()
+                });
+                frame.set_payload(&Imu6::default()).unwrap();
+                let size = frame.pack(&mut buffer, None).unwrap();
+
+                coalescer
+                    .push(&buffer[..size], now, |datagram| {
+                        datagrams.push(datagram.to_vec());
+                    })
+                    .unwrap();
+                sent += 1;
+            }
+        }
+        assert!(coalescer.deadline().is_some());
+        assert!(coalescer.flush(100 * PERIOD, |datagram| {
+            datagrams.push(datagram.to_vec());
+        }));
+        assert!(coalescer.deadline().is_none());
+
+        let stats = *coalescer.stats();
+        assert_eq!(stats.frames, sent);
+        assert_eq!(stats.datagrams, datagrams.len() as u64);
+        assert!(stats.frames >= stats.datagrams * 8, "{stats:?}");
+        assert!(stats.max_delay <= MAX_DELAY);
+        assert!(stats.mean_delay().unwrap() <= MAX_DELAY as f64 / 2.0);
+
+        let validator =
+            ParallelValidator::new(2, Schedule::WorkStealing).unwrap();
+        let mut received = 0;
+        for datagram in &datagrams {
+            assert!(datagram.len() <= COALESCE_DEFAULT_MTU);
+            let mut frames = [&[][..]; 64];
+            let count = DatagramFrames::new(datagram)
+                .collect_into(&mut frames)
+                .unwrap();
+            let report = validator.validate(&frames[..count], None);
+            assert!(report.results.iter().all(Result::is_ok));
+            received += count as u64;
+        }
+        assert_eq!(received, sent);
+
+        // Full datagram is emitted before it overflows MTU.
+        let mut coalescer = Coalescer::<128>::new(100, u64::MAX).unwrap();
+        let mut sizes = Vec::new();
+        for _ in 0..3 {
+            coalescer
+                .push(&buffer[..48], 0, |datagram| sizes.push(datagram.len()))
+                .unwrap();
+        }
+        assert_eq!(sizes, [96]);
+        assert!(matches!(
+            coalescer.push(&buffer[..101], 0, |_| {}),
+            Err(IdtpError::BufferOverflow)
+        ));
+        assert!(Coalescer::<128>::new(129, 0).is_err());
+
+        // Malformed datagrams.
+        let mut datagram = datagrams[0].clone();
+        datagram.extend_from_slice(&[0x49, 0x44]);
+        let frames: Vec<_> = DatagramFrames::new(&datagram).collect();
+        assert!(matches!(
+            frames.last(),
+            Some(Err(IdtpError::BufferUnderflow))
+        ));
+        assert!(frames[..frames.len() - 1].iter().all(Result::is_ok));
+        datagram[48] ^= 0xFF;
+        let mut frames = [&[][..]; 64];
+        assert!(matches!(
+            DatagramFrames::new(&datagram).collect_into(&mut frames),
+            Err(IdtpError::ParseError)
+        ));
+    }
+
+    #[cfg(feature = "software_impl")]
+    #[test]
+    fn test_secure_fast_mode() {
+        use idtp::crypto::{SwTrailerDigest, sw_blake2s_closure};
+
+        let hex = |digest: [u8; 32]| {
+            digest
+                .iter()
+                .map(|byte| format!("{byte:02x}"))
+                .collect::<String>()
+        };
+        let key: Vec<u8> = (0..32).collect();
+        let data: Vec<u8> = (0..200).collect();
+
+        // Reference values from RFC 7693 implementation.
+        assert_eq!(
+            hex(sw_blake2s_closure(Some(&key))(&[]).unwrap()),
+            "48a8997da407876b3d79c0d92325ad3b89cbb754d86ab71aee047ad345fd2c49"
+        );
+        assert_eq!(
+            hex(sw_blake2s_closure(Some(&key))(&data[..64]).unwrap()),
+            "8975b0577fd35566d750b362b0897a26c399136df07bababbde6203ff2954ed4"
+        );
+        assert_eq!(
+            hex(sw_blake2s_closure(Some(&[b'k'; 32]))(&data).unwrap()),
+            "798fd34f883385d5072c201b89e8ddc21125e62221bb2e95442f378b280f113c"
+        );
+        assert_eq!(
+            hex(sw_blake2s_closure(Some(b"key"))(b"abc").unwrap()),
+            "3f9723437b033bf0c1f4df43cafd0776068cb0a95912de13f3b2952a3aba764d"
+        );
+        assert!(matches!(
+            sw_blake2s_closure(Some(&[0; 33]))(b"abc"),
+            Err(IdtpError::InvalidHMacKey)
+        ));
+        assert!(matches!(
+            sw_blake2s_closure(None)(b"abc"),
+            Err(IdtpError::InvalidHMacKey)
+        ));
+
+        let mut frame = IdtpFrame::new();
+        frame.set_header(&IdtpHeader {
+            mode: IdtpMode::SecureFast.into(),
+            ..IdtpHeader::new()
+        });
+        frame.set_payload(&Imu6::default()).unwrap();
+        assert_eq!(IdtpMode::try_from(0x03).unwrap(), IdtpMode::SecureFast);
+        assert_eq!(frame.trailer_size(), 32);
+
+        let mut buffer = [0u8; 128];
+        let size = frame.pack(&mut buffer, Some(b"key")).unwrap();
+        let trailer = &buffer[size - 32..size];
+        let expected =
+            sw_blake2s_closure(Some(b"key"))(&buffer[..size - 32]).unwrap();
+        assert_eq!(trailer, expected);
+        IdtpFrame::validate(&buffer[..size], Some(b"key")).unwrap();
+
+        // Incremental digest matches one-shot digest.
+        let mut digest =
+            SwTrailerDigest::new(IdtpMode::SecureFast, Some(b"key")).unwrap();
+        for chunk in buffer[..size - 32].chunks(7) {
+            digest.update(chunk).unwrap();
+        }
+        let mut incremental = [0u8; 32];
+        digest.finalize(&mut incremental).unwrap();
+        assert_eq!(incremental, expected);
+
+        assert!(matches!(
+            IdtpFrame::validate(&buffer[..size], Some(b"other")),
+            Err(IdtpError::InvalidHMac)
+        ));
+        buffer[25] ^= 0x01;
+        assert!(matches!(
+            IdtpFrame::validate(&buffer[..size], Some(b"key")),
+            Err(IdtpError::InvalidHMac)
+        ));
+    }
+
+    #[cfg(feature = "software_impl")]
+    #[test]
+    fn test_encrypted_mode() {
+        use idtp::crypto::{Poly1305, SwTrailerDigest, chacha20_xor};
+
+        let hex = |bytes: &[u8]| {
+            bytes
+                .iter()
+                .map(|byte| format!("{byte:02x}"))
+                .collect::<String>()
+        };
+
+        // Reference values from RFC 8439, sections 2.4.2 & 2.5.2.
+        let key: [u8; 32] = core::array::from_fn(|i| i as u8);
+        let mut nonce = [0u8; 12];
+        nonce[7] = 0x4A;
+        let mut text = *b"Ladies and Gentlemen of the class of '99: \
+            If I could offer you only one tip for the future, sunscreen \
+            would be it.";
+        chacha20_xor(&key, &nonce, 1, &mut text);
+        assert_eq!(
+            hex(&text),
+            "6e2e359a2568f98041ba0728dd0d6981e97e7aec1d4360c20a27afccfd9fae0b\
+             f91b65c5524733ab8f593dabcd62b3571639d624e65152ab8f530c359f0861d8\
+             07ca0dbf500d6a6156a38e088a22b65e52bc514d16ccf806818ce91ab7793736\
+             5af90bbf74a35be6b40b8eedf2785e42874d"
+        );
+
+        // Several passes of interleaved blocks & partial block.
+        let mut data: Vec<u8> = (0..700).map(|i| (i % 251) as u8).collect();
+        let nonce: [u8; 12] = core::array::from_fn(|i| i as u8);
+        chacha20_xor(&[7; 32], &nonce, 5, &mut data);
+        assert_eq!(hex(&data[256..272]), "99030b85c11f7374776a5634a216051a");
+        assert_eq!(hex(&data[684..]), "aefddd3adc12cb2050c1539a1d5a36b5");
+        chacha20_xor(&[7; 32], &nonce, 5, &mut data);
+        assert!(data.iter().enumerate().all(|(i, b)| *b == (i % 251) as u8));
+
+        let mut mac = Poly1305::new(&[
+            0x85, 0xD6, 0xBE, 0x78, 0x57, 0x55, 0x6D, 0x33, 0x7F, 0x44, 0x52,
+            0xFE, 0x42, 0xD5, 0x06, 0xA8, 0x01, 0x03, 0x80, 0x8A, 0xFB, 0x0D,
+            0xB2, 0xFD, 0x4A, 0xBF, 0xF6, 0xAF, 0x41, 0x49, 0xF5, 0x1B,
+        ]);
+        for chunk in b"Cryptographic Forum Research Group".chunks(7) {
+            mac.update(chunk).unwrap();
+        }
+        assert_eq!(
+            hex(&mac.finalize().unwrap()),
+            "a8061dc1305136c6c22b8baf0c0127a9"
+        );
+
+        // Frame round trip.
+        let payload = Imu6 {
+            acc: idtp::payload::Imu3Acc {
+                acc_x: 1.0,
+                acc_y: -2.0,
+                acc_z: 9.81,
+            },
+            gyr: idtp::payload::Imu3Gyr {
+                gyr_x: 0.1,
+                gyr_y: 0.2,
+                gyr_z: 0.3,
+            },
+        };
+        let mut frame = IdtpFrame::new();
+        frame.set_header(&IdtpHeader {
+            mode: IdtpMode::Encrypted.into(),
+            timestamp: 0x0102_0304,
+            sequence: 7,
+            device_id: 0x0A0B,
+            ..IdtpHeader::new()
+        });
+        frame.set_payload(&payload).unwrap();
+        assert_eq!(IdtpMode::try_from(0x04).unwrap(), IdtpMode::Encrypted);
+        assert_eq!(frame.trailer_size(), 16);
+
+        let key = [0x42u8; 32];
+        let mut buffer = [0u8; 128];
+        let size = frame.pack(&mut buffer, Some(&key)).unwrap();
+        assert_eq!(size, IDTP_HEADER_SIZE + 24 + 16);
+        assert_ne!(&buffer[IDTP_HEADER_SIZE..size - 16], payload.as_bytes());
+        // Reference tag from RFC 8439 implementation.
+        assert_eq!(
+            hex(&buffer[size - 16..size]),
+            "b16ccf60957343f84b50b37ef6b8cf83"
+        );
+        IdtpFrame::validate(&buffer[..size], Some(&key)).unwrap();
+        assert!(matches!(
+            SwTrailerDigest::new(IdtpMode::Encrypted, Some(&key)),
+            Err(IdtpError::ParseError)
+        ));
+        assert!(matches!(
+            frame.pack(&mut buffer, Some(b"short")),
+            Err(IdtpError::InvalidHMacKey)
+        ));
+        frame.pack(&mut buffer, Some(&key)).unwrap();
+
+        // Wrong key & tampering leave payload encrypted.
+        let sealed = buffer;
+        assert!(matches!(
+            IdtpFrame::open(&mut buffer[..size], Some(&[0x24; 32])),
+            Err(IdtpError::InvalidHMac)
+        ));
+        buffer[25] ^= 0x01;
+        assert!(matches!(
+            IdtpFrame::validate(&buffer[..size], Some(&key)),
+            Err(IdtpError::InvalidHMac)
+        ));
+        assert!(matches!(
+            IdtpFrame::open(&mut buffer[..size], Some(&key)),
+            Err(IdtpError::InvalidHMac)
+        ));
+        buffer[25] ^= 0x01;
+        assert_eq!(buffer, sealed);
+
+        assert_eq!(
+            IdtpFrame::open(&mut buffer[..size], Some(&key)).unwrap(),
+            size
+        );
+        let opened = IdtpFrame::try_from(&buffer[..size]).unwrap();
+        assert_eq!(
+            opened.payload::<Imu6>().unwrap().as_bytes(),
+            payload.as_bytes()
+        );
+    }
+
+    #[cfg(feature = "software_impl")]
+    #[test]
+    fn test_key_store() {
+        use idtp::crypto::{HmacMidstate, HmacMidstateDigest, sw_hmac_closure};
+        use idtp::keystore::KeyStore;
+        use std::sync::atomic::{AtomicBool, Ordering};
+
+        // Midstate HMAC matches one-shot HMAC around padding boundaries.
+        let data: Vec<u8> = (0..200).map(|i| i as u8).collect();
+        for key in [&b"key"[..], &[0x5A; 64], &data[..100]] {
+            let midstate = HmacMidstate::new(key).unwrap();
+            for size in [0, 20, 55, 56, 63, 64, 119, 120, 200] {
+                assert_eq!(
+                    midstate.mac(&data[..size]),
+                    sw_hmac_closure(Some(key))(&data[..size]).unwrap()
+                );
+            }
+
+            // Incremental HMAC matches one-shot one for any split.
+            for split in [0, 1, 63, 64, 65, 130, 200] {
+                let mut digest = HmacMidstateDigest::new(&midstate);
+                digest.update(&data[..split]).unwrap();
+                digest.update(&data[split..]).unwrap();
+                assert_eq!(digest.finalize().unwrap(), midstate.mac(&data));
+            }
+        }
+
+        let pack = |mode: IdtpMode, device_id: u16, key: &[u8]| {
+            let mut frame = IdtpFrame::new();
+            frame.set_header(&IdtpHeader {
+                mode: mode.into(),
+                device_id,
+                ..IdtpHeader::new()
+            });
+            frame.set_payload(&Imu6::default()).unwrap();
+            let mut buffer = [0u8; 128];
+            let size = frame.pack(&mut buffer, Some(key)).unwrap();
+            buffer[..size].to_vec()
+        };
+
+        static STORE: KeyStore<8> = KeyStore::new();
+        let old = [0x11u8; 32];
+        let new = [0x22u8; 32];
+
+        STORE.insert(1, &old).unwrap();
+        STORE.insert(2, b"short key").unwrap();
+        assert!(STORE.contains(1) && STORE.contains(2) && !STORE.contains(3));
+
+        for mode in
+            [IdtpMode::Secure, IdtpMode::SecureFast, IdtpMode::Encrypted]
+        {
+            STORE.validate(&pack(mode, 1, &old), 0).unwrap();
+        }
+        STORE
+            .validate(&pack(IdtpMode::Secure, 2, b"short key"), 0)
+            .unwrap();
+        STORE.validate(&pack(IdtpMode::Safety, 3, b""), 0).unwrap();
+        assert!(matches!(
+            STORE.validate(&pack(IdtpMode::Secure, 3, b"key"), 0),
+            Err(IdtpError::InvalidHMacKey)
+        ));
+        assert!(matches!(
+            STORE.validate(&pack(IdtpMode::Secure, 2, b"other"), 0),
+            Err(IdtpError::InvalidHMac)
+        ));
+        for mode in
+            [IdtpMode::Secure, IdtpMode::SecureFast, IdtpMode::Encrypted]
+        {
+            let mut frame = pack(mode, 1, &old);
+            *frame.last_mut().unwrap() ^= 0x01;
+            assert!(matches!(
+                STORE.validate(&frame, 0),
+                Err(IdtpError::InvalidHMac)
+            ));
+        }
+
+        // Rotated-out key is accepted during grace period only.
+        STORE.rotate(1, &new, 1_000, 500).unwrap();
+        let stale = pack(IdtpMode::SecureFast, 1, &old);
+        STORE
+            .validate(&pack(IdtpMode::SecureFast, 1, &new), 2_000)
+            .unwrap();
+        STORE.validate(&stale, 1_499).unwrap();
+        assert!(matches!(
+            STORE.validate(&stale, 1_500),
+            Err(IdtpError::InvalidHMac)
+        ));
+
+        let mut sealed = pack(IdtpMode::Encrypted, 1, &old);
+        assert!(matches!(
+            STORE.open(&mut sealed, 1_500),
+            Err(IdtpError::InvalidHMac)
+        ));
+        STORE.open(&mut sealed, 1_200).unwrap();
+        assert_eq!(
+            IdtpFrame::try_from(&sealed[..])
+                .unwrap()
+                .payload::<Imu6>()
+                .unwrap()
+                .as_bytes(),
+            Imu6::default().as_bytes()
+        );
+
+        STORE.revoke(1);
+        assert!(!STORE.contains(1));
+        assert!(matches!(
+            STORE.validate(&pack(IdtpMode::Secure, 1, &new), 1_200),
+            Err(IdtpError::InvalidHMacKey)
+        ));
+
+        // Frames signed with either key pass while keys are being rotated.
+        static DONE: AtomicBool = AtomicBool::new(false);
+        STORE.insert(5, &old).unwrap();
+        STORE.rotate(5, &new, 0, u64::MAX).unwrap();
+
+        let writer = std::thread::spawn(move || {
+            for round in 0..2_000 {
+                let key = if round % 2 == 0 { &old } else { &new };
+                STORE.rotate(5, key, 0, u64::MAX).unwrap();
+            }
+            DONE.store(true, Ordering::Release);
+        });
+
+        let frames = [
+            pack(IdtpMode::Secure, 5, &old),
+            pack(IdtpMode::Secure, 5, &new),
+        ];
+        while !DONE.load(Ordering::Acquire) {
+            for frame in &frames {
+                STORE.validate(frame, 0).unwrap();
+            }
+        }
+
+        writer.join().unwrap();
+    }
+
+    #[cfg(all(feature = "std", feature = "software_impl"))]
+    #[test]
+    fn test_constant_time_verify() {
+        use idtp::crypto::SwTrailerDigest;
+
+        assert!(trailer_eq(&[1, 2, 3], &[1, 2, 3]));
+        assert!(!trailer_eq(&[1, 2, 3], &[1, 2, 4]));
+        assert!(!trailer_eq(&[1, 2, 3], &[1, 2]));
+
+        let mut frames = Vec::new();
+        for (sequence, mode) in (0..48).zip([0, 1, 2, 3].iter().cycle()) {
+            let mut buffer = [0u8; 128];
+            let size = pack_test_frame(&mut buffer, *mode, sequence);
+            frames.push(buffer[..size].to_vec());
+        }
+
+        // Damage the first or the last trailer byte of every fifth frame.
+        let mut expected = 0u64;
+        for (index, frame) in frames.iter_mut().enumerate() {
+            let trailer_size = IdtpFrame::trailer_size_from(
+                IdtpMode::try_from(frame[17]).unwrap(),
+            );
+
+            if index % 5 == 0 && trailer_size > 0 {
+                let position = if index % 2 == 0 { 1 } else { trailer_size };
+                let size = frame.len();
+                frame[size - position] ^= 0x80;
+            } else {
+                expected |= 1 << index;
+            }
+        }
+
+        for frame in &frames {
+            let streamed =
+                IdtpFrame::verify_with(frame, idtp::crypto::sw_crc8, |mode| {
+                    SwTrailerDigest::new(mode, Some(b"key"))
+                });
+            let buffered = IdtpFrame::validate_with(
+                frame,
+                idtp::crypto::sw_crc8,
+                idtp::crypto::sw_crc32,
+                idtp::crypto::sw_mac_closure(
+                    IdtpMode::try_from(frame[17]).ok(),
+                    Some(b"key"),
+                ),
+            );
+            assert_eq!(format!("{streamed:?}"), format!("{buffered:?}"));
+        }
+
+        assert_eq!(
+            IdtpFrame::validate_batch(&frames, Some(b"key")).unwrap(),
+            expected
+        );
+        assert!(matches!(
+            IdtpFrame::validate_batch(&[[0u8; 4]; 65], None),
+            Err(IdtpError::BufferOverflow)
+        ));
+
+        let report = idtp::validator::ParallelValidator::new(
+            4,
+            idtp::validator::Schedule::WorkStealing,
+        )
+        .unwrap()
+        .validate(&frames, Some(b"key"));
+        assert_eq!(report.valid_mask(), vec![expected]);
+    }
 }